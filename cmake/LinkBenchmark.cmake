@@ -0,0 +1,35 @@
+include(FetchContent)
+
+macro(LinkBenchmark TARGET ACCESS)
+    # Prefer an installed copy, and only fetch google benchmark without one
+    find_package(benchmark QUIET)
+
+    if (NOT benchmark_FOUND)
+        FetchContent_Declare(
+            googlebenchmark
+            GIT_REPOSITORY https://github.com/google/benchmark.git
+            GIT_TAG v1.6.1
+        )
+
+        FetchContent_GetProperties(googlebenchmark)
+
+        if (NOT googlebenchmark_POPULATED)
+            FetchContent_Populate(googlebenchmark)
+
+            # Only the library is needed, not its own tests
+            set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "" FORCE)
+            set(BENCHMARK_ENABLE_INSTALL OFF CACHE BOOL "" FORCE)
+
+            add_subdirectory(
+                ${googlebenchmark_SOURCE_DIR}
+                ${googlebenchmark_BINARY_DIR}
+                EXCLUDE_FROM_ALL)
+
+            # Set the target's folders
+            set_target_properties(benchmark PROPERTIES FOLDER ${PROJECT_NAME}/thirdparty)
+            set_target_properties(benchmark_main PROPERTIES FOLDER ${PROJECT_NAME}/thirdparty)
+        endif()
+    endif()
+
+    target_link_libraries(${TARGET} ${ACCESS} benchmark::benchmark_main)
+endmacro()
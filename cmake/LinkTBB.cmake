@@ -0,0 +1,17 @@
+macro(LinkTBB TARGET ACCESS)
+    # libstdc++ runs the parallel execution policies on TBB, and the calls don't link
+    # without it. MSVC's standard library has its own backend, so it needs nothing
+    if (NOT MSVC)
+        find_package(TBB QUIET)
+
+        if (TBB_FOUND)
+            target_link_libraries(${TARGET} ${ACCESS} TBB::tbb)
+        else()
+            message(WARNING "TBB wasn't found, so the parallel execution policies of ${TARGET} "
+                "may fail to link, or run sequentially")
+        endif()
+
+        find_package(Threads REQUIRED)
+        target_link_libraries(${TARGET} ${ACCESS} Threads::Threads)
+    endif()
+endmacro()
\ No newline at end of file
@@ -2,14 +2,27 @@
 
 #include <FileUtil.h>
 #include <Image.h>
+#include <JsonUtil.h>
+#include <Metrics.h>
+#include <RunArena.h>
 #include <ScopedTimer.h>
 #include <SimilarityGraph.h>
+#include <Trace.h>
 #include <Voronoi.h>
 
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iterator>
+#include <optional>
 #include <iostream>
 #include <fstream>
+#include <set>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <system_error>
+#include <thread>
 
 namespace
 {
@@ -48,71 +61,401 @@ bool ShouldOverwriteFile(const std::string& fileName)
 
     return (response == 'Y' || response == 'y') ? true : false;
 }
+
+/*
+    Formats a duration as milliseconds, keeping the fraction
+
+    @param duration The duration to format
+
+    @returns The duration in milliseconds
+*/
+/*
+    Finds the deepest directory two paths share
+
+    @param first    The first path
+    @param second   The second path
+
+    @returns The path the two have in common, which is empty if they share nothing
+*/
+std::filesystem::path CommonAncestor(const std::filesystem::path& first, const std::filesystem::path& second)
+{
+    const auto shared = std::mismatch(first.begin(), first.end(), second.begin(), second.end()).first;
+
+    std::filesystem::path ancestor;
+    for (auto part = first.begin(); part != shared; ++part)
+        ancestor /= *part;
+
+    return ancestor;
+}
+
+std::string ToMilliseconds(std::chrono::nanoseconds duration)
+{
+    std::ostringstream formatted;
+    formatted << std::fixed << std::setprecision(3) << std::chrono::duration<double, std::milli>(duration).count() << "ms";
+
+    return formatted.str();
+}
 }
 
 int ProgramDriver::go()
+{
+    int status = 1;
+    std::vector<RunResult> results;
+
+    const auto runStart = std::chrono::steady_clock::now();
+    {
+        dpa::trace::TraceSpan span{ "ProgramDriver::go", "driver" };
+
+        if (m_isBatch)
+        {
+            status = goBatch(results);
+        }
+        else
+        {
+            results.push_back(depixelize(m_imagePath, m_outputStems.front(), m_parser.get<bool>("--verbose")));
+        }
+    }
+    const auto runEnd = std::chrono::steady_clock::now();
+
+    if (!m_metricsPath.empty())
+    {
+        std::ofstream metricsFile{ m_metricsPath };
+        if (!metricsFile.is_open() || !writeMetrics(metricsFile, results, runEnd - runStart))
+            std::cout << "-- Could not write the metrics to: " << m_metricsPath.string() << "\n";
+    }
+
+    // Every span has closed, and every worker has finished, so the trace is complete
+    if (!m_tracePath.empty())
+    {
+        std::ofstream traceFile{ m_tracePath };
+        if (traceFile.is_open())
+            dpa::trace::Tracer::instance().writeChromeTrace(traceFile);
+        else
+            std::cout << "-- Could not write the trace to: " << m_tracePath.string() << "\n";
+    }
+
+    // A single image that fails still has its metrics and trace written first
+    if (!m_isBatch && !results.back().succeeded)
+        printError(results.back().message);
+
+    return status;
+}
+
+int ProgramDriver::goBatch(std::vector<RunResult>& results)
+{
+    const bool isVerbose = m_parser.get<bool>("--verbose");
+
+    auto numJobs = static_cast<std::size_t>(m_parser.get<int>("--jobs"));
+    if (!numJobs)
+        numJobs = std::max(1u, std::thread::hardware_concurrency());
+
+    numJobs = std::min(numJobs, m_images.size());
+    m_isOneImageAtATime = numJobs == 1;
+
+    if (isVerbose)
+        std::cout << "-- Depixelizing " << m_images.size() << " images on " << numJobs << " threads\n\n";
+
+    // Each worker takes the next image until there are none left, and
+    // every result has its own slot, so the summary keeps the input order
+    results.assign(m_images.size(), RunResult{});
+    std::atomic<std::size_t> nextImage{ 0 };
+
+    const auto batchStart = std::chrono::high_resolution_clock::now();
+
+    const auto work = [&]()
+    {
+        for (auto index = nextImage++; index < m_images.size(); index = nextImage++)
+        {
+            const auto& imagePath = m_images[index];
+
+            try
+            {
+                results[index] = depixelize(imagePath, m_outputStems[index], false);
+            }
+            catch (const std::exception& error)
+            {
+                results[index] = { imagePath, false, std::chrono::nanoseconds{ 0 }, error.what() };
+            }
+
+            if (isVerbose)
+            {
+                std::lock_guard lock{ m_outputMutex };
+                std::cout << "-- [" << (results[index].succeeded ? "OK" : "FAILED") << "] " << imagePath.string() << "\n";
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < numJobs; ++i)
+        workers.emplace_back(work);
+
+    work();
+
+    for (auto& worker : workers)
+        worker.join();
+
+    const auto batchEnd = std::chrono::high_resolution_clock::now();
+
+    // Print the summary
+    std::size_t numSucceeded = 0;
+    std::chrono::nanoseconds totalExecutionTime{ 0 };
+
+    std::cout << "\n-- Summary\n";
+    for (const auto& result : results)
+    {
+        std::cout << std::setw(8) << (result.succeeded ? "OK" : "FAILED") << std::setw(14) << ToMilliseconds(result.executionTime) << "  ";
+        std::cout << result.imagePath.string();
+
+        if (!result.message.empty())
+            std::cout << " (" << result.message << ")";
+
+        std::cout << "\n";
+
+        numSucceeded += result.succeeded;
+        totalExecutionTime += result.executionTime;
+    }
+
+    std::cout << "\n-- " << numSucceeded << " of " << results.size() << " images depixelized\n";
+    std::cout << "-- Total execution time: " << ToMilliseconds(totalExecutionTime) << "\n";
+    std::cout << "-- Wall clock time: " << ToMilliseconds(batchEnd - batchStart) << "\n";
+
+    return numSucceeded == results.size() ? 1 : 0;
+}
+
+ProgramDriver::RunResult ProgramDriver::depixelize(const std::filesystem::path& imagePath,
+    const std::filesystem::path& outputStem, bool isVerbose)
 {
     using namespace dpa::image;
     using namespace dpa::graph;
     using namespace dpa::voronoi;
 
-    if (Image<RGB, stbi_uc> imageData{ m_imagePath }; imageData.isLoaded())
+    RunResult result{ imagePath };
+
+    dpa::trace::TraceSpan span{ "depixelize", "driver", imagePath.string() };
+
+    Image<RGB, stbi_uc> imageData = [&]()
     {
-        bool isVerbose = m_parser.get<bool>("--verbose");
-        if (isVerbose)
-        {
-            std::cout << "-- Image [";
-            std::cout << "Width: " << imageData.getWidth() << "\t";
-            std::cout << "Height: " << imageData.getHeight() << "\t";
-            std::cout << "Channels: " << imageData.getChannels() << "] loaded\n\n";
-        }
+        dpa::trace::TraceSpan loadSpan{ "load", "driver" };
+        return Image<RGB, stbi_uc>{ imagePath };
+    }();
+
+    if (!imageData.isLoaded())
+    {
+        result.message = "Could not load the specified image.";
+        return result;
+    }
 
-        auto imageDims = std::make_tuple(imageData.getWidth(), imageData.getHeight());
+    if (isVerbose)
+    {
+        std::cout << "-- Image [";
+        std::cout << "Width: " << imageData.getWidth() << "\t";
+        std::cout << "Height: " << imageData.getHeight() << "\t";
+        std::cout << "Channels: " << imageData.getChannels() << "] loaded\n\n";
+    }
+
+    auto imageDims = std::make_tuple(imageData.getWidth(), imageData.getHeight());
+
+    // The graphs' per-image storage all comes from one arena, which is
+    // released in one go once they're done with it
+    dpa::memory::RunArena arena;
+
+    result.numPixels = static_cast<std::size_t>(imageData.getWidth()) * imageData.getHeight();
+
+    bool isBuilt = false;
+
+    dpa::graph::SimilarityGraph simGraph;
+    simGraph.setMemoryResource(arena.resource());
+
+    runStage(result, isVerbose, "SimilarityGraph::build",
+        "-- Building the similarity graph\n", "-- Similarity graph built in: ",
+        [&]() { isBuilt = simGraph.build(imageData); });
+
+    if (!isBuilt)
+    {
+        result.message = "Could not build the similarity graph.";
+        return result;
+    }
+
+    runStage(result, isVerbose, "SimilarityGraph::resolveCrossings",
+        "-- Resolving the similarity graph\n", "-- Similarity graph resolved in: ",
+        [&]() { simGraph.resolveCrossings(); });
+
+    result.graphStatistics = simGraph.getStatistics();
+
+    if (m_parser["--similarity_graph"] == true)
+        render(simGraph, outputStem);
+
+    VoronoiDiagram voronoiGraph{ imageDims };
+    voronoiGraph.setMemoryResource(arena.resource());
+    voronoiGraph.setExecutionPolicy(m_parser.get<ExecutionPolicy>("--execution_policy"));
+
+    runStage(result, isVerbose, "VoronoiDiagram::build",
+        "-- Building the voronoi graph\n", "-- Voronoi graph built in: ",
+        [&]() { voronoiGraph.build(simGraph.getNeighbourMasks()); });
+
+    result.voronoiStatistics = voronoiGraph.getStatistics();
+
+    if (m_parser["--voronoi_graph"] == true)
+        render(voronoiGraph, outputStem);
 
-        dpa::graph::SimilarityGraph simGraph;
+    ContourSet contours;
+    runStage(result, isVerbose, "VoronoiDiagram::extractContours",
+        "-- Extracting the contours\n", "-- Contours extracted in: ",
+        [&]() { contours = voronoiGraph.extractContours(imageData); });
+
+    result.numVisibleContours = std::count(std::cbegin(contours.types), std::cend(contours.types), ContourType::eVisible);
+    result.numShadingContours = contours.size() - result.numVisibleContours;
+    result.numContourPoints = contours.getNumPoints();
+    result.bytesAllocated = arena.getBytesAllocated();
+
+    if (isVerbose)
+        std::cout << "-- Total execution time: " << ToMilliseconds(result.executionTime) << "\n";
+
+    result.succeeded = true;
+    return result;
+}
+
+bool ProgramDriver::writeMetrics(std::ostream& output, const std::vector<RunResult>& results,
+    std::chrono::nanoseconds wallTime) const
+{
+    const auto nanoseconds = [](std::chrono::nanoseconds duration) { return static_cast<long long>(duration.count()); };
+
+    std::size_t numSucceeded = 0;
+
+    output << "{\n  \"images\": [";
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& result = results[i];
+        const auto& graph = result.graphStatistics;
+        const auto& voronoi = result.voronoiStatistics;
+
+        numSucceeded += result.succeeded;
+
+        // Images depixelized side by side share the process' CPU time, so it isn't split between them
+        std::optional<std::chrono::nanoseconds> cpuTime = std::chrono::nanoseconds{ 0 };
+        for (const auto& stage : result.stages)
         {
-            ScopedTimer timer = {
-                isVerbose,
-                "-- Building the similarity graph\n",
-                "-- Similarity graph built in: ",
-                [&]() { simGraph.build(imageData); },
-                [&](long long delta) { m_totalExecutionTime += delta; }
-            };
+            if (!stage.cpuTime)
+            {
+                cpuTime.reset();
+                break;
+            }
+
+            *cpuTime += *stage.cpuTime;
         }
 
-        applyHeuristics(simGraph,
-            heuristics::DissimilarPixels{},
-            heuristics::Curves{ imageDims },
-            heuristics::Islands{ imageDims },
-            heuristics::SparsePixels{ imageDims }
-        );
+        output << (i ? ",\n" : "\n") << "    {\n";
+        output << "      \"path\": ";
+        dpa::jsonutil::writeString(output, result.imagePath.string());
+        output << ",\n      \"succeeded\": " << (result.succeeded ? "true" : "false");
+        output << ",\n      \"message\": ";
+        dpa::jsonutil::writeString(output, result.message);
+        output << ",\n      \"wallTimeNs\": " << nanoseconds(result.executionTime);
+
+        if (cpuTime)
+            output << ",\n      \"cpuTimeNs\": " << nanoseconds(*cpuTime);
 
-        if (m_parser["--similarity_graph"] == true)
-            render(simGraph);
+        output << ",\n      \"arenaBytes\": " << result.bytesAllocated;
 
-        VoronoiDiagram voronoiGraph{ imageDims };
+        output << ",\n      \"stages\": [";
+        for (std::size_t j = 0; j < result.stages.size(); ++j)
         {
-            ScopedTimer timer = {
-                isVerbose,
-                "-- Building the voronoi graph\n",
-                "-- Voronoi graph built in: ",
-                [&]() { voronoiGraph.build(simGraph.getEdges()); },
-                [&](long long delta) { m_totalExecutionTime += delta; }
-            };
+            const auto& stage = result.stages[j];
+
+            output << (j ? ",\n" : "\n") << "        { \"name\": ";
+            dpa::jsonutil::writeString(output, stage.name);
+            output << ", \"wallTimeNs\": " << nanoseconds(stage.wallTime);
+            if (stage.cpuTime)
+                output << ", \"cpuTimeNs\": " << nanoseconds(*stage.cpuTime);
+
+            output << ", \"peakRssBytes\": " << stage.peakResidentSetSize << " }";
         }
+        output << (result.stages.empty() ? "]" : "\n      ]");
+
+        output << ",\n      \"counts\": {\n";
+        output << "        \"pixels\": " << result.numPixels << ",\n";
+        output << "        \"graphVertices\": " << graph.numVertices << ",\n";
+        output << "        \"graphEdges\": " << graph.numEdges << ",\n";
+        output << "        \"dissimilarEdges\": " << graph.numDissimilarEdges << ",\n";
+        output << "        \"crossingBlocks\": " << graph.numCrossings << ",\n";
+        output << "        \"removedEdges\": { ";
+        output << "\"dissimilarPixels\": " << graph.numDissimilarEdges;
+        output << ", \"crossings\": " << graph.numCutDiagonals;
+        output << ", \"curves\": " << graph.numCutByCurves;
+        output << ", \"islands\": " << graph.numCutByIslands;
+        output << ", \"sparsePixels\": " << graph.numCutBySparsePixels;
+        output << ", \"ties\": " << graph.numTies << " },\n";
+        output << "        \"resolvedEdges\": " << graph.numResolvedEdges << ",\n";
+        output << "        \"voronoiCells\": " << voronoi.numCells << ",\n";
+        output << "        \"voronoiVertices\": " << voronoi.numVertices << ",\n";
+        output << "        \"voronoiEdges\": " << voronoi.numEdges << ",\n";
+        output << "        \"welds\": " << voronoi.numWelds << ",\n";
+        output << "        \"contours\": { ";
+        output << "\"visible\": " << result.numVisibleContours;
+        output << ", \"shading\": " << result.numShadingContours;
+        output << ", \"points\": " << result.numContourPoints << " }\n";
+        output << "      }\n    }";
+    }
+    output << (results.empty() ? "]" : "\n  ]");
 
-        if (m_parser["--voronoi_graph"] == true)
-            render(voronoiGraph);
+    output << ",\n  \"run\": {\n";
+    output << "    \"images\": " << results.size() << ",\n";
+    output << "    \"succeeded\": " << numSucceeded << ",\n";
+    output << "    \"wallTimeNs\": " << nanoseconds(wallTime) << ",\n";
+    output << "    \"cpuTimeNs\": " << nanoseconds(dpa::metrics::processCpuTime()) << ",\n";
+    output << "    \"peakRssBytes\": " << dpa::metrics::peakResidentSetSize() << "\n";
+    output << "  }\n}\n";
 
-        if (isVerbose)
-            std::cout << "-- Total execution time: " << m_totalExecutionTime << "ms\n";
+    return static_cast<bool>(output);
+}
+
+std::vector<std::filesystem::path> ProgramDriver::getOutputStems() const
+{
+    namespace fs = std::filesystem;
+
+    std::error_code error;
+
+    std::vector<fs::path> sources;
+    sources.reserve(m_images.size());
+    for (const auto& image : m_images)
+        sources.push_back(fs::absolute(image, error).lexically_normal());
+
+    // A directory's tree is mirrored from the directory itself. Patterns and list
+    // files are mirrored from the deepest directory all of their images share
+    fs::path root = sources.front().parent_path();
+    if (dpa::fileutil::isValidDirectory(m_imagePath))
+    {
+        root = fs::absolute(m_imagePath, error).lexically_normal();
     }
     else
     {
-        printError("Could not load the specified image.");
+        for (const auto& source : sources)
+            root = CommonAncestor(root, source.parent_path());
     }
 
-    return 1;
+    std::vector<fs::path> stems;
+    std::set<fs::path> usedStems;
+    for (const auto& source : sources)
+    {
+        const auto directory = (m_outputPath / source.parent_path().lexically_relative(root)).lexically_normal();
+        fs::create_directories(directory, error);
+
+        // Images that only differ by their extension, or are named twice, still
+        // share a stem, so the later ones are told apart by their extension and a count
+        auto stem = directory / source.stem();
+        for (std::size_t count = 1; !usedStems.insert(stem).second; ++count)
+        {
+            auto name = source.stem().string() + "_" + source.extension().string().substr(1);
+            if (count > 1)
+                name += "_" + std::to_string(count);
+
+            stem = directory / name;
+        }
+
+        stems.push_back(stem);
+    }
+
+    return stems;
 }
 
 argparse::ArgumentParser ProgramDriver::prepareArguments(const std::string& programName)
@@ -120,7 +463,7 @@ argparse::ArgumentParser ProgramDriver::prepareArguments(const std::string& prog
     argparse::ArgumentParser program{ programName };
 
     program.add_argument("image")
-        .help("The input image to depixelize")
+        .help("The input image to depixelize, or a directory, list file or wildcard pattern of images to depixelize in a batch")
         .action([](auto arg) { return std::filesystem::path(arg); });
 
     program.add_argument("-o", "--output")
@@ -138,6 +481,60 @@ argparse::ArgumentParser ProgramDriver::prepareArguments(const std::string& prog
         .default_value(false)
         .implicit_value(true);
 
+    program.add_argument("-ep", "--execution_policy")
+        .help("How to build the voronoi graph: seq, par or par_unseq")
+        .default_value(dpa::voronoi::ExecutionPolicy::eSequenced)
+        .action([](const std::string& arg)
+            {
+                using dpa::voronoi::ExecutionPolicy;
+
+                if (arg == "seq")
+                    return ExecutionPolicy::eSequenced;
+                if (arg == "par")
+                    return ExecutionPolicy::eParallel;
+                if (arg == "par_unseq")
+                    return ExecutionPolicy::eParallelUnsequenced;
+
+                throw std::runtime_error("Unknown execution policy: " + arg);
+            });
+
+    program.add_argument("-j", "--jobs")
+        .help("The number of images to depixelize at once in a batch, or 0 for one per hardware thread")
+        .default_value(0)
+        .action([](const std::string& arg)
+            {
+                const auto jobs = std::stoi(arg);
+                if (jobs < 0)
+                    throw std::runtime_error("The number of jobs can't be negative: " + arg);
+
+                return jobs;
+            });
+
+    program.add_argument("-ow", "--overwrite")
+        .help("What to do with existing output files: prompt, always or skip. Batches never prompt, and skip instead")
+        .default_value(OverwritePolicy::ePrompt)
+        .action([](const std::string& arg)
+            {
+                if (arg == "prompt")
+                    return OverwritePolicy::ePrompt;
+                if (arg == "always")
+                    return OverwritePolicy::eAlways;
+                if (arg == "skip")
+                    return OverwritePolicy::eSkip;
+
+                throw std::runtime_error("Unknown overwrite policy: " + arg);
+            });
+
+    program.add_argument("-t", "--trace")
+        .help("Write a Chrome trace of the run to the given .json file, which can be opened in chrome://tracing or Perfetto")
+        .default_value(std::filesystem::path{})
+        .action([](auto arg) { return std::filesystem::path(arg); });
+
+    program.add_argument("-m", "--metrics-json")
+        .help("Write the time, CPU time, peak memory and graph sizes of each image's stages to the given .json file")
+        .default_value(std::filesystem::path{})
+        .action([](auto arg) { return std::filesystem::path(arg); });
+
     program.add_argument("-v", "--verbose")
         .help("Display verbose messages")
         .default_value(false)
@@ -154,28 +551,60 @@ bool ProgramDriver::validateArguments(int argc, const char* const* argv)
 
         m_imagePath = m_parser.get<std::filesystem::path>("image");
         m_outputPath = m_parser.get<std::filesystem::path>("--output");
+        m_overwritePolicy = m_parser.get<OverwritePolicy>("--overwrite");
+        m_tracePath = m_parser.get<std::filesystem::path>("--trace");
+        m_metricsPath = m_parser.get<std::filesystem::path>("--metrics-json");
     }
     catch (const std::exception& error)
     {
         printError(error.what());
     }
-     
-    return dpa::fileutil::isValidImage(m_imagePath) && dpa::fileutil::isValidDirectory(m_outputPath);
+
+    dpa::trace::Tracer::instance().setEnabled(!m_tracePath.empty());
+
+    // Anything other than a single image is a batch, even if it only holds one
+    m_images = dpa::fileutil::collectImages(m_imagePath);
+    m_isBatch = !dpa::fileutil::isValidImage(m_imagePath);
+
+    // Worker threads can't stop and ask before overwriting
+    if (m_isBatch && m_overwritePolicy == OverwritePolicy::ePrompt)
+        m_overwritePolicy = OverwritePolicy::eSkip;
+
+    if (m_images.empty() || !dpa::fileutil::isValidDirectory(m_outputPath))
+        return false;
+
+    // Every image's outputs are placed before any are written, so no two workers write the same file
+    m_outputStems = getOutputStems();
+    return true;
 }
 
-bool ProgramDriver::render(dpa::graph::SimilarityGraph& graph)
+bool ProgramDriver::shouldWrite(const std::filesystem::path& filePath) const
 {
-    std::string fileName = m_imagePath.stem().filename().string() + "_similarity.tex";
-    
-    std::filesystem::path outPath = m_outputPath;
-    outPath.append(fileName);
+    if (!dpa::fileutil::fileExists(filePath))
+        return true;
+
+    switch (m_overwritePolicy)
+    {
+    case OverwritePolicy::eAlways:
+        return true;
+    case OverwritePolicy::eSkip:
+        return false;
+    default:
+        return ShouldOverwriteFile(filePath.filename().string());
+    }
+}
+
+bool ProgramDriver::render(dpa::graph::SimilarityGraph& graph, const std::filesystem::path& outputStem)
+{
+    std::filesystem::path outPath = outputStem;
+    outPath += "_similarity.tex";
 
     // Helper lambda to write the tex file
     const auto WriteFile = [this, &graph](const auto& filePath)
     {
         std::ofstream outFile{ filePath };
 
-        if (m_parser.get<bool>("--verbose"))
+        if (m_parser.get<bool>("--verbose") && !m_isBatch)
             std::cout << "-- Writing: " << filePath.string() << "\n\n";
 
         if (outFile.is_open())
@@ -184,26 +613,21 @@ bool ProgramDriver::render(dpa::graph::SimilarityGraph& graph)
         return false;
     };
 
-    // Prompt that the file will be overwritten if it already exists
-    if (dpa::fileutil::fileExists(outPath))
-        return (ShouldOverwriteFile(fileName)) ? WriteFile(outPath) : false;
-
-    return WriteFile(outPath);
+    // Follow the overwrite policy if the file already exists
+    return shouldWrite(outPath) ? WriteFile(outPath) : false;
 }
 
-bool ProgramDriver::render(dpa::voronoi::VoronoiDiagram& graph)
+bool ProgramDriver::render(dpa::voronoi::VoronoiDiagram& graph, const std::filesystem::path& outputStem)
 {
-    std::string fileName = m_imagePath.stem().filename().string() + "_voronoi.tex";
-
-    std::filesystem::path outPath = m_outputPath;
-    outPath.append(fileName);
+    std::filesystem::path outPath = outputStem;
+    outPath += "_voronoi.tex";
 
     // Helper lambda to write the tex file
     const auto WriteFile = [this, &graph](const auto& filePath)
     {
         std::ofstream outFile{ filePath };
 
-        if (m_parser.get<bool>("--verbose"))
+        if (m_parser.get<bool>("--verbose") && !m_isBatch)
             std::cout << "-- Writing: " << filePath.string() << "\n\n";
 
         if (outFile.is_open())
@@ -212,9 +636,6 @@ bool ProgramDriver::render(dpa::voronoi::VoronoiDiagram& graph)
         return false;
     };
 
-    // Prompt that the file will be overwritten if it already exists
-    if (dpa::fileutil::fileExists(outPath))
-        return (ShouldOverwriteFile(fileName)) ? WriteFile(outPath) : false;
-
-    return WriteFile(outPath);
+    // Follow the overwrite policy if the file already exists
+    return shouldWrite(outPath) ? WriteFile(outPath) : false;
 }
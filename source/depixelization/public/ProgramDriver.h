@@ -1,18 +1,32 @@
 #pragma once
 
+#include <Metrics.h>
 #include <ScopedTimer.h>
 #include <SimilarityGraph.h>
 #include <Voronoi.h>
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <filesystem>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include <argparse.hpp>
 
+/*
+    What to do when an output file already exists
+*/
+enum class OverwritePolicy
+{
+    ePrompt,
+    eAlways,
+    eSkip
+};
+
 /*
     A class that drives the depixelization process based on user-supplied arguments
 */
@@ -42,98 +56,147 @@ public:
 private:
 
     /*
-        Sets up the argument parser so it accepts arguments
+        The outcome of depixelizing a single image
+    */
+    struct RunResult
+    {
+        std::filesystem::path imagePath{};
 
-        @param programName  The name of the executable
+        bool succeeded{ false };
+        std::chrono::nanoseconds executionTime{ 0 };
+
+        std::string message{};
+
+        // How long each stage took, and what the graphs held once they were built
+        std::vector<dpa::metrics::StageMetrics> stages{};
+
+        std::size_t numPixels{ 0 };
+        std::size_t bytesAllocated{ 0 };
+
+        dpa::graph::SimilarityGraphStatistics graphStatistics{};
+        dpa::voronoi::VoronoiStatistics voronoiStatistics{};
+
+        // The contours extracted from the voronoi graph, and the points along them
+        std::size_t numVisibleContours{ 0 };
+        std::size_t numShadingContours{ 0 };
+        std::size_t numContourPoints{ 0 };
+    };
 
-        @returns An instance of the initialized argument parser
-    */
-    argparse::ArgumentParser prepareArguments(const std::string& programName);
-    
     /*
-        Validates the user-supplied arguments, ensuring they comply with what
-        the parser requires
+        Depixelizes a single image, writing any requested outputs
 
-        @param argc The number of arguments passed into the program
-        @param argv The list of arguments passed in by the user
+        @param imagePath    The image to depixelize
+        @param outputStem   The path of the outputs, without the suffix each one adds
+        @param isVerbose    Whether to print the progress of each stage
 
-        @returns True if the arguments were valid, false otherwise
+        @returns Whether the image was depixelized, and how long it took
     */
-    bool validateArguments(int argc, const char* const* argv);
+    RunResult depixelize(const std::filesystem::path& imagePath, const std::filesystem::path& outputStem, bool isVerbose);
 
     /*
-        Prints the given error message, program usage, and terminates the program
+        Runs one stage of depixelizing an image, timing it and recording its
+        metrics in the image's result
 
-        @tparam Message The type of message to print
+        @tparam Callable The type of the stage to run
 
-        @param mesesage The message to print to stdout
+        @param result       The result of the image being depixelized
+        @param isVerbose    Whether to print the progress of the stage
+        @param name         The name of the stage, which is also its trace span
+        @param startMessage The verbose message to print before the stage runs
+        @param endMessage   The verbose message to print, with its time, once it's done
+        @param callable     The stage to run
     */
-    template<typename Message>
-    void printError(const Message& message) const;
+    template<typename Callable>
+    void runStage(RunResult& result, bool isVerbose, const char* name,
+        const std::string& startMessage, const std::string& endMessage, Callable callable) const;
 
     /*
-        Processes the parameter pack of heuristics. Operates on all items except
-        the last. Head is the current tip of the parameter pack, and tail is the
-        remainder. The method strips off the head in each iteration (while there
-        are reamining items), and processes it
+        Depixelizes every image on a pool of worker threads, then prints a
+        summary of each image's outcome
 
-        @tparam Heuristic The type of the head item
-        @tparam Heuristics A parameter pack of types that remain
+        @param results  Filled with the outcome of every image, in the input order
 
-        @param graph    The similarity graph to apply the heuristic too
-        @param head     The tip of the parameter pack
-        @param tail     The remaining items in the parameter pack
+        @returns 0 if any image failed, 1 if they all succeeded
     */
-    template<typename Heuristic, typename...Heuristics>
-    void applyHeuristics(dpa::graph::SimilarityGraph& graph, const Heuristic& head, const Heuristics&... tail);
+    int goBatch(std::vector<RunResult>& results);
 
     /*
-        This processes the last item in the parameter pack
+        Writes the metrics of every image depixelized, and of the run as a whole, as JSON
 
-        @tparam Heuristic   The type of the last item in the parameter pack
+        @param output   The stream to write the JSON to
+        @param results  The outcome of every image
+        @param wallTime How long the whole run took
 
-        @param graph        The similarity graph to apply the heuristic too
-        @param heuristic    The heurisitc to apply to the similarity graph
+        @returns True if the metrics were written, false otherwise
     */
-    template<typename Heuristic>
-    void applyHeuristics(dpa::graph::SimilarityGraph& graph, const Heuristic& heuristic);
+    bool writeMetrics(std::ostream& output, const std::vector<RunResult>& results,
+        std::chrono::nanoseconds wallTime) const;
 
     /*
-        Applies the given heuristic to the given graph
+        Gets the path every image's outputs are written to, without the suffix each
+        output adds, and creates the directories they're written in. The images keep
+        their place in the source tree, whether they came from a directory, a pattern
+        or a list file, so same-named sprites in different folders don't collide. Those
+        that would still share a path are told apart by their extension
 
-        @tparam Heuristic   The type of heuristic to apply
-
-        @param graph        The similarity graph to apply the heuristic too
-        @param heuristic    The heuristic to apply
+        @returns The output stem of each image, in the same order as the images
     */
-    template<typename Heuristic>
-    void applyHeuristic(dpa::graph::SimilarityGraph& graph, const Heuristic& heuristic);
+    std::vector<std::filesystem::path> getOutputStems() const;
 
     /*
-        Gets the name of the heuristic based on its type
+        Sets up the argument parser so it accepts arguments
 
-        @tpararm Heuristic  The type of the given heuristic
+        @param programName  The name of the executable
 
-        @param heuristic    The heuristic to get a name for
+        @returns An instance of the initialized argument parser
+    */
+    argparse::ArgumentParser prepareArguments(const std::string& programName);
+    
+    /*
+        Validates the user-supplied arguments, ensuring they comply with what
+        the parser requires
 
-        @returns The name of the heuristic if there is one, an empty string otherwise
+        @param argc The number of arguments passed into the program
+        @param argv The list of arguments passed in by the user
+
+        @returns True if the arguments were valid, false otherwise
     */
-    template<typename Heuristic>
-    std::string getHeuristicName(const Heuristic& heuristic) const;
+    bool validateArguments(int argc, const char* const* argv);
+
+    /*
+        Prints the given error message, program usage, and terminates the program
+
+        @tparam Message The type of message to print
+
+        @param mesesage The message to print to stdout
+    */
+    template<typename Message>
+    void printError(const Message& message) const;
 
     /*
         Renders the given similarity graph to a tex file
 
-        @param graph    The similarity graph to render
+        @param graph        The similarity graph to render
+        @param outputStem   The path of the image's outputs, which the tex file's suffix is added to
     */
-    bool render(dpa::graph::SimilarityGraph& graph);
+    bool render(dpa::graph::SimilarityGraph& graph, const std::filesystem::path& outputStem);
 
     /*
         Renders the given voronoi graph to a tex file
 
-        @param graph    The voronoi graph to render
+        @param graph        The voronoi graph to render
+        @param outputStem   The path of the image's outputs, which the tex file's suffix is added to
+    */
+    bool render(dpa::voronoi::VoronoiDiagram& graph, const std::filesystem::path& outputStem);
+
+    /*
+        Determines if an output file should be written, following the overwrite policy
+
+        @param filePath The output file to write
+
+        @returns True if the file should be written, false otherwise
     */
-    bool render(dpa::voronoi::VoronoiDiagram& graph);
+    bool shouldWrite(const std::filesystem::path& filePath) const;
 
 private:
 
@@ -142,7 +205,22 @@ private:
     std::filesystem::path m_imagePath;
     std::filesystem::path m_outputPath;
 
-    long long m_totalExecutionTime{ 0 };
+    // Where to write the Chrome trace and the metrics of the run, if anywhere
+    std::filesystem::path m_tracePath;
+    std::filesystem::path m_metricsPath;
+
+    // Every image the input refers to, where each one's outputs are written, and whether it's a batch of them
+    std::vector<std::filesystem::path> m_images;
+    std::vector<std::filesystem::path> m_outputStems;
+    bool m_isBatch{ false };
+
+    // Whether the images are depixelized one at a time, so the process' CPU time can be split into stages
+    bool m_isOneImageAtATime{ true };
+
+    OverwritePolicy m_overwritePolicy{ OverwritePolicy::ePrompt };
+
+    // Serializes the messages printed by the worker threads
+    mutable std::mutex m_outputMutex;
 };
 
 template<typename Message>
@@ -154,52 +232,29 @@ void ProgramDriver::printError(const Message& message) const
     std::exit(0);
 }
 
-template<typename Heuristic>
-void ProgramDriver::applyHeuristic(dpa::graph::SimilarityGraph& graph, const Heuristic& heuristic)
+template<typename Callable>
+void ProgramDriver::runStage(RunResult& result, bool isVerbose, const char* name,
+    const std::string& startMessage, const std::string& endMessage, Callable callable) const
 {
-    const std::string heuristicName = getHeuristicName(heuristic);
-
-    ScopedTimer timer = {
-        m_parser.get<bool>("--verbose"),
-        "-- Applying the " + heuristicName + " heuristic\n",
-        "-- Heuristic applied in: ",
-        [&]() { graph.applyHeuristic(heuristic); },
-        [&](long long delta) { m_totalExecutionTime += delta; }
-    };
-}
+    dpa::metrics::StageMetrics stage{ name };
 
-template<typename Heuristic>
-void ProgramDriver::applyHeuristics(dpa::graph::SimilarityGraph& graph, const Heuristic& heuristic)
-{
-    applyHeuristic(graph, heuristic);
-}
-
-template<typename Heuristic, typename... Heuristics>
-void ProgramDriver::applyHeuristics(dpa::graph::SimilarityGraph& graph, const Heuristic& head, const Heuristics&... tail)
-{
-    applyHeuristic(graph, head);
-    applyHeuristics(graph, tail...);
-}
-
-template<typename Heuristic>
-std::string ProgramDriver::getHeuristicName(const Heuristic& heuristic) const
-{
-    static const std::string curves = "Curves";
-    static const std::string dissimilar = "Dissimilar Pixels";
-    static const std::string islands = "Islands";
-    static const std::string sparse = "Sparse Pixels";
-
-    if (std::is_same_v<Heuristic, dpa::graph::heuristics::Curves>)
-        return curves;
-
-    if (std::is_same_v<Heuristic, dpa::graph::heuristics::DissimilarPixels>)
-        return dissimilar;
+    const auto cpuStart = dpa::metrics::processCpuTime();
+    {
+        ScopedTimer timer = {
+            isVerbose,
+            startMessage,
+            endMessage,
+            callable,
+            [&](std::chrono::nanoseconds delta) { stage.wallTime = delta; },
+            name
+        };
+    }
 
-    if (std::is_same_v<Heuristic, dpa::graph::heuristics::Islands>)
-        return islands;
+    if (m_isOneImageAtATime)
+        stage.cpuTime = dpa::metrics::processCpuTime() - cpuStart;
 
-    if (std::is_same_v<Heuristic, dpa::graph::heuristics::SparsePixels>)
-        return sparse;
+    stage.peakResidentSetSize = dpa::metrics::peakResidentSetSize();
 
-    return "";
+    result.executionTime += stage.wallTime;
+    result.stages.push_back(stage);
 }
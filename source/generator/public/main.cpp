@@ -0,0 +1,140 @@
+#include <PixelArtGenerator.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <argparse.hpp>
+
+namespace
+{
+/*
+    Parses a whole number that has to be at least the given minimum
+
+    @param arg      The argument to parse
+    @param minimum  The smallest value the argument may have
+
+    @returns The parsed number
+*/
+int ParseAtLeast(const std::string& arg, int minimum)
+{
+    const auto value = std::stoi(arg);
+    if (value < minimum)
+        throw std::runtime_error("Expected a number of at least " + std::to_string(minimum) + ": " + arg);
+
+    return value;
+}
+
+/*
+    Parses a fraction, which has to be between 0 and 1
+
+    @param arg The argument to parse
+
+    @returns The parsed fraction
+*/
+double ParseFraction(const std::string& arg)
+{
+    const auto value = std::stod(arg);
+    if (value < 0 || value > 1)
+        throw std::runtime_error("Expected a fraction between 0 and 1: " + arg);
+
+    return value;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    using dpa::image::utility::PixelArtSettings;
+
+    const PixelArtSettings defaults;
+
+    argparse::ArgumentParser program{ "pixel-art-generator" };
+
+    program.add_argument("output")
+        .help("The image file to write, as a .png, .bmp or .tga")
+        .action([](auto arg) { return std::filesystem::path(arg); });
+
+    program.add_argument("-W", "--width")
+        .help("The width of the image")
+        .default_value(defaults.width)
+        .action([](const std::string& arg) { return ParseAtLeast(arg, 1); });
+
+    program.add_argument("-H", "--height")
+        .help("The height of the image")
+        .default_value(defaults.height)
+        .action([](const std::string& arg) { return ParseAtLeast(arg, 1); });
+
+    program.add_argument("-s", "--seed")
+        .help("The seed to generate the image from. The same seed and settings always give the same image")
+        .default_value(static_cast<int>(defaults.seed))
+        .action([](const std::string& arg) { return ParseAtLeast(arg, 0); });
+
+    program.add_argument("-p", "--palette")
+        .help("The number of colours to draw with, from 2 to 256")
+        .default_value(static_cast<int>(defaults.paletteSize))
+        .action([](const std::string& arg) { return ParseAtLeast(arg, 2); });
+
+    program.add_argument("-r", "--region")
+        .help("The side of the square regions each colour is laid down in")
+        .default_value(defaults.regionSize)
+        .action([](const std::string& arg) { return ParseAtLeast(arg, 1); });
+
+    program.add_argument("-f", "--flat")
+        .help("The fraction of regions that are a single flat colour")
+        .default_value(defaults.flatFraction)
+        .action(ParseFraction);
+
+    program.add_argument("-d", "--dither")
+        .help("The fraction of a dithered region's checkerboard drawn in its second colour")
+        .default_value(defaults.ditherDensity)
+        .action(ParseFraction);
+
+    program.add_argument("-l", "--diagonals")
+        .help("The number of diagonal strokes, per pixel along the image's edges")
+        .default_value(defaults.diagonalDensity)
+        .action([](const std::string& arg) { return std::max(std::stod(arg), 0.0); });
+
+    program.add_argument("-i", "--islands")
+        .help("The chance of any one pixel being a lone island of another colour")
+        .default_value(defaults.islandFrequency)
+        .action(ParseFraction);
+
+    PixelArtSettings settings;
+    std::filesystem::path outputPath;
+
+    try
+    {
+        program.parse_args(argc, argv);
+
+        outputPath = program.get<std::filesystem::path>("output");
+
+        settings.width = program.get<int>("--width");
+        settings.height = program.get<int>("--height");
+        settings.seed = static_cast<std::uint32_t>(program.get<int>("--seed"));
+        settings.paletteSize = static_cast<std::size_t>(program.get<int>("--palette"));
+        settings.regionSize = program.get<int>("--region");
+        settings.flatFraction = program.get<double>("--flat");
+        settings.ditherDensity = program.get<double>("--dither");
+        settings.diagonalDensity = program.get<double>("--diagonals");
+        settings.islandFrequency = program.get<double>("--islands");
+    }
+    catch (const std::exception& error)
+    {
+        std::cout << error.what() << "\n";
+        std::cout << program;
+
+        return 1;
+    }
+
+    const auto image = dpa::image::utility::GeneratePixelArt(settings);
+    if (!image.save(outputPath))
+    {
+        std::cout << "-- Could not write the image to: " << outputPath.string() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,42 @@
+#include <BenchmarkUtility.h>
+
+#include <PixelArtGenerator.h>
+#include <SimilarityGraph.h>
+
+#include <map>
+
+using namespace dpa::image;
+
+void ImageSizes(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->RangeMultiplier(4)->Range(16, 4096);
+}
+
+void SetPixelsProcessed(benchmark::State& state)
+{
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+
+const Image<RGB, stbi_uc>& GetBenchmarkImage(int size)
+{
+    static std::map<int, Image<RGB, stbi_uc>> images;
+
+    auto found = images.find(size);
+    if (found != std::end(images))
+        return found->second;
+
+    utility::PixelArtSettings settings;
+    settings.seed = static_cast<std::uint32_t>(size);
+    settings.width = size;
+    settings.height = size;
+
+    return images.emplace(size, utility::GeneratePixelArt(settings)).first->second;
+}
+
+std::vector<std::uint8_t> GetResolvedMasks(int size)
+{
+    dpa::graph::SimilarityGraph graph{ GetBenchmarkImage(size) };
+    graph.resolveCrossings();
+
+    return graph.getNeighbourMasks();
+}
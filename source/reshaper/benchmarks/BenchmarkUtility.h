@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Image.h>
+
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+/*
+    Registers the image sizes a benchmark is run over, which are square
+    images from 16x16 up to 4096x4096, growing by a factor of four
+
+    @param benchmark The benchmark to register the sizes with
+*/
+void ImageSizes(benchmark::internal::Benchmark* benchmark);
+
+/*
+    Reports how many pixels a benchmark processed, so the results also
+    read as a throughput
+
+    @param state The state of the benchmark that was run
+*/
+void SetPixelsProcessed(benchmark::State& state);
+
+/*
+    Gets a square piece of synthetic pixel art, generated with the default
+    settings. Each size is only generated once
+
+    @param size The width and height of the image
+
+    @returns The image
+*/
+const dpa::image::Image<dpa::image::RGB, stbi_uc>& GetBenchmarkImage(int size);
+
+/*
+    Gets the neighbour masks of the resolved similarity graph of a benchmark
+    image, which is what the voronoi diagram is built from
+
+    @param size The width and height of the image
+
+    @returns The neighbour masks, in row-major order
+*/
+std::vector<std::uint8_t> GetResolvedMasks(int size);
+
+/*
+    A stream buffer that throws away everything written to it, so the
+    writers can be timed without the cost of a file
+*/
+class DiscardBuffer final : public std::streambuf
+{
+protected:
+
+    int_type overflow(int_type letter) override { return traits_type::not_eof(letter); }
+    std::streamsize xsputn(const char_type*, std::streamsize count) override { return count; }
+};
@@ -0,0 +1,21 @@
+#include <BenchmarkUtility.h>
+
+#include <ImageUtil.h>
+
+using namespace dpa::image;
+
+/*
+    Converts a whole image from RGB to YCbCr, which is the first thing
+    building a similarity graph does
+*/
+void BM_RGB_To_YCbCr(benchmark::State& state)
+{
+    const auto& image = GetBenchmarkImage(static_cast<int>(state.range(0)));
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(utility::RGB_To_YCbCr(image));
+
+    SetPixelsProcessed(state);
+}
+
+BENCHMARK(BM_RGB_To_YCbCr)->Apply(ImageSizes);
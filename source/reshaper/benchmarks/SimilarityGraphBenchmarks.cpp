@@ -0,0 +1,193 @@
+#include <BenchmarkUtility.h>
+
+#include <Heuristics.h>
+#include <PixelArtGenerator.h>
+#include <SimilarityGraph.h>
+
+#include <optional>
+#include <ostream>
+#include <tuple>
+#include <type_traits>
+
+using namespace dpa::image;
+using namespace dpa::graph;
+using namespace dpa::graph::heuristics;
+
+namespace
+{
+/*
+    Makes a heuristic for an image of the given dimensions
+
+    @tparam Heuristic The type of heuristic to make
+
+    @param imageDims The width and height of the image
+
+    @returns The heuristic
+*/
+template<typename Heuristic>
+Heuristic MakeHeuristic(const std::tuple<int, int>& imageDims)
+{
+    if constexpr (std::is_same_v<Heuristic, DissimilarPixels>)
+        return DissimilarPixels{};
+    else
+        return Heuristic{ imageDims };
+}
+
+/*
+    Builds the similarity graph of a benchmark image, and applies every heuristic to it
+
+    @param graph    The graph to build
+    @param size     The width and height of the image
+*/
+void BuildFilteredGraph(SimilarityGraph& graph, int size)
+{
+    const auto imageDims = std::make_tuple(size, size);
+
+    graph.build(GetBenchmarkImage(size));
+    graph.applyHeuristic(DissimilarPixels{});
+    graph.applyHeuristic(Curves{ imageDims });
+    graph.applyHeuristic(Islands{ imageDims });
+    graph.applyHeuristic(SparsePixels{ imageDims });
+}
+}
+
+/*
+    Builds the 8-connected lattice of an image, including converting it to
+    YCbCr and palettizing it
+*/
+void BM_SimilarityGraphBuild(benchmark::State& state)
+{
+    const auto& image = GetBenchmarkImage(static_cast<int>(state.range(0)));
+
+    for (auto _ : state)
+    {
+        SimilarityGraph graph;
+        benchmark::DoNotOptimize(graph.build(image));
+    }
+
+    SetPixelsProcessed(state);
+}
+
+/*
+    Applies one heuristic to a freshly built graph. The crossing heuristics
+    only see crossings once the dissimilar edges have been found, so the
+    dissimilar pixels heuristic is applied to their graph first, untimed
+*/
+template<typename Heuristic>
+void BM_ApplyHeuristic(benchmark::State& state)
+{
+    const auto size = static_cast<int>(state.range(0));
+    const auto imageDims = std::make_tuple(size, size);
+    const auto& image = GetBenchmarkImage(size);
+
+    std::optional<SimilarityGraph> graph;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        graph.emplace(image);
+
+        if constexpr (!std::is_same_v<Heuristic, DissimilarPixels>)
+            graph->applyHeuristic(DissimilarPixels{});
+
+        state.ResumeTiming();
+
+        graph->applyHeuristic(MakeHeuristic<Heuristic>(imageDims));
+    }
+
+    SetPixelsProcessed(state);
+}
+
+/*
+    Resolves every crossing in a single pass, which is what the program
+    does instead of applying each heuristic
+*/
+void BM_ResolveCrossings(benchmark::State& state)
+{
+    const auto& image = GetBenchmarkImage(static_cast<int>(state.range(0)));
+
+    std::optional<SimilarityGraph> graph;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        graph.emplace(image);
+        state.ResumeTiming();
+
+        graph->resolveCrossings();
+    }
+
+    SetPixelsProcessed(state);
+}
+
+/*
+    Resolves the crossings of images with more and more of what the crossing
+    heuristics spend their time on: diagonal strokes, which the curves
+    heuristic follows, and dithering and islands, which the sparse pixels
+    and islands heuristics measure
+*/
+void BM_ResolveCrossingsSweep(benchmark::State& state)
+{
+    dpa::image::utility::PixelArtSettings settings;
+    settings.width = 256;
+    settings.height = 256;
+    settings.flatFraction = 0.5;
+    settings.diagonalDensity = state.range(0) / 100.0;
+    settings.ditherDensity = state.range(1) / 100.0;
+    settings.islandFrequency = state.range(2) / 1000.0;
+
+    const auto image = dpa::image::utility::GeneratePixelArt(settings);
+
+    std::optional<SimilarityGraph> graph;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        graph.emplace(image);
+        state.ResumeTiming();
+
+        graph->resolveCrossings();
+    }
+
+    state.SetItemsProcessed(state.iterations() * settings.width * settings.height);
+}
+
+/*
+    Reads back the edges left once every heuristic's edges are filtered out
+*/
+void BM_GetEdges(benchmark::State& state)
+{
+    SimilarityGraph graph;
+    BuildFilteredGraph(graph, static_cast<int>(state.range(0)));
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(graph.getEdges(FilteredEdges::eAll));
+
+    SetPixelsProcessed(state);
+}
+
+/*
+    Writes the filtered graph as LaTeX, to a stream that discards it
+*/
+void BM_SimilarityGraphWriteTex(benchmark::State& state)
+{
+    SimilarityGraph graph;
+    BuildFilteredGraph(graph, static_cast<int>(state.range(0)));
+
+    DiscardBuffer buffer;
+    std::ostream output{ &buffer };
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(graph.writeTex(output, FilteredEdges::eAll));
+
+    SetPixelsProcessed(state);
+}
+
+BENCHMARK(BM_SimilarityGraphBuild)->Apply(ImageSizes);
+BENCHMARK_TEMPLATE(BM_ApplyHeuristic, DissimilarPixels)->Apply(ImageSizes);
+BENCHMARK_TEMPLATE(BM_ApplyHeuristic, Curves)->Apply(ImageSizes);
+BENCHMARK_TEMPLATE(BM_ApplyHeuristic, Islands)->Apply(ImageSizes);
+BENCHMARK_TEMPLATE(BM_ApplyHeuristic, SparsePixels)->Apply(ImageSizes);
+BENCHMARK(BM_ResolveCrossings)->Apply(ImageSizes);
+BENCHMARK(BM_ResolveCrossingsSweep)
+    ->ArgNames({ "diagonals%", "dither%", "islands_per_mille" })
+    ->ArgsProduct({ { 0, 5, 20 }, { 0, 50, 100 }, { 0, 5, 20 } });
+BENCHMARK(BM_GetEdges)->Apply(ImageSizes);
+BENCHMARK(BM_SimilarityGraphWriteTex)->Apply(ImageSizes);
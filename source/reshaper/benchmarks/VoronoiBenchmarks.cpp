@@ -0,0 +1,133 @@
+#include <BenchmarkUtility.h>
+
+#include <ImageUtil.h>
+#include <PixelArtGenerator.h>
+#include <SimilarityGraph.h>
+#include <Voronoi.h>
+#include <VoronoiImpl.h>
+
+#include <execution>
+#include <ostream>
+#include <tuple>
+
+using namespace dpa::voronoi;
+
+/*
+    Builds the block code of every 2x2 block of pixels from the neighbour masks
+*/
+template<typename ExecutionPolicy>
+void BM_BuildBlockGrid(benchmark::State& state, const ExecutionPolicy& policy)
+{
+    const auto size = static_cast<int>(state.range(0));
+    const auto neighbourMasks = GetResolvedMasks(size);
+
+    internal::VoronoiImpl voronoi;
+    voronoi.setDimensions(std::make_tuple(size, size));
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(voronoi.dispatchGridBuilder(policy, neighbourMasks));
+
+    SetPixelsProcessed(state);
+}
+
+/*
+    Lays out the cell of every block and welds the cells together
+*/
+template<typename ExecutionPolicy>
+void BM_BuildVoronoiGraph(benchmark::State& state, const ExecutionPolicy& policy)
+{
+    const auto size = static_cast<int>(state.range(0));
+
+    internal::VoronoiImpl voronoi;
+    voronoi.setDimensions(std::make_tuple(size, size));
+
+    const auto blocks = voronoi.dispatchGridBuilder(std::execution::seq, GetResolvedMasks(size));
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(voronoi.dispatchVoronoiBuilder(policy, blocks));
+
+    SetPixelsProcessed(state);
+}
+
+/*
+    Builds the voronoi diagrams of images with flatter and flatter regions,
+    where more of the cells' border points are welded together
+*/
+void BM_BuildVoronoiGraphSweep(benchmark::State& state)
+{
+    dpa::image::utility::PixelArtSettings settings;
+    settings.width = 256;
+    settings.height = 256;
+    settings.regionSize = static_cast<int>(state.range(0));
+    settings.flatFraction = state.range(1) / 100.0;
+
+    dpa::graph::SimilarityGraph graph{ dpa::image::utility::GeneratePixelArt(settings) };
+    graph.resolveCrossings();
+
+    internal::VoronoiImpl voronoi;
+    voronoi.setDimensions(std::make_tuple(settings.width, settings.height));
+
+    const auto blocks = voronoi.dispatchGridBuilder(std::execution::seq, graph.getNeighbourMasks());
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(voronoi.dispatchVoronoiBuilder(std::execution::seq, blocks));
+
+    state.SetItemsProcessed(state.iterations() * settings.width * settings.height);
+}
+
+/*
+    Extracts the contours of the voronoi diagram, with the counts of contours
+    and of their points as counters, to check they grow linearly with the image
+*/
+void BM_ExtractContours(benchmark::State& state)
+{
+    const auto size = static_cast<int>(state.range(0));
+    const auto image = dpa::image::utility::RGB_To_YCbCr(GetBenchmarkImage(size)).value();
+
+    internal::VoronoiImpl voronoi;
+    voronoi.setDimensions(std::make_tuple(size, size));
+    voronoi.build(GetResolvedMasks(size));
+
+    ContourSet contours;
+    for (auto _ : state)
+    {
+        contours = voronoi.extractContours(image);
+        benchmark::DoNotOptimize(contours.coordinates.data());
+    }
+
+    state.counters["contours"] = static_cast<double>(contours.size());
+    state.counters["points"] = static_cast<double>(contours.getNumPoints());
+
+    SetPixelsProcessed(state);
+}
+
+/*
+    Writes the voronoi diagram as LaTeX, to a stream that discards it
+*/
+void BM_VoronoiWriteTex(benchmark::State& state)
+{
+    const auto size = static_cast<int>(state.range(0));
+    auto imageDims = std::make_tuple(size, size);
+
+    VoronoiDiagram voronoi{ imageDims };
+    voronoi.build(GetResolvedMasks(size));
+
+    DiscardBuffer buffer;
+    std::ostream output{ &buffer };
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(voronoi.writeTex(output));
+
+    SetPixelsProcessed(state);
+}
+
+BENCHMARK_CAPTURE(BM_BuildBlockGrid, seq, std::execution::seq)->Apply(ImageSizes);
+BENCHMARK_CAPTURE(BM_BuildBlockGrid, par, std::execution::par)->Apply(ImageSizes);
+BENCHMARK_CAPTURE(BM_BuildBlockGrid, par_unseq, std::execution::par_unseq)->Apply(ImageSizes);
+BENCHMARK_CAPTURE(BM_BuildVoronoiGraph, seq, std::execution::seq)->Apply(ImageSizes);
+BENCHMARK_CAPTURE(BM_BuildVoronoiGraph, par, std::execution::par)->Apply(ImageSizes);
+BENCHMARK(BM_BuildVoronoiGraphSweep)
+    ->ArgNames({ "region", "flat%" })
+    ->ArgsProduct({ { 2, 8, 32 }, { 0, 50, 100 } });
+BENCHMARK(BM_ExtractContours)->Apply(ImageSizes);
+BENCHMARK(BM_VoronoiWriteTex)->Apply(ImageSizes);
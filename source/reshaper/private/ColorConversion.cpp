@@ -0,0 +1,447 @@
+#include <ColorConversion.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    #define DPA_COLOR_KERNELS_X86
+
+    #include <immintrin.h>
+
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+
+        // MSVC allows any intrinsic to be used without changing the target architecture
+        #define DPA_TARGET_AVX2
+    #else
+        #define DPA_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+namespace
+{
+/*
+    Converts a colour space coefficient into fixed point, rounding to nearest
+
+    @param coefficient The coefficient to convert
+    @param fractionBits The number of fractional bits in the result
+    @returns The fixed point coefficient
+*/
+constexpr std::int32_t ToFixed(double coefficient, int fractionBits) noexcept
+{
+    return static_cast<std::int32_t>(coefficient * (1 << fractionBits) + 0.5);
+}
+
+// RGB -> YCbCr uses 16 fractional bits. The Cb and Cr rows both sum to zero,
+// so every result is within [0, 255] without clamping
+constexpr int kForwardBits = 16;
+
+constexpr std::int32_t kYR = ToFixed(0.299000, kForwardBits);
+constexpr std::int32_t kYG = ToFixed(0.587000, kForwardBits);
+constexpr std::int32_t kYB = ToFixed(0.114000, kForwardBits);
+
+constexpr std::int32_t kCbR = ToFixed(0.168736, kForwardBits);
+constexpr std::int32_t kCbG = ToFixed(0.331264, kForwardBits);
+constexpr std::int32_t kCbB = ToFixed(0.500000, kForwardBits);
+
+constexpr std::int32_t kCrR = ToFixed(0.500000, kForwardBits);
+constexpr std::int32_t kCrG = ToFixed(0.418688, kForwardBits);
+constexpr std::int32_t kCrB = ToFixed(0.081312, kForwardBits);
+
+constexpr std::int32_t kChromaBias = 128 << kForwardBits;
+
+// YCbCr -> RGB uses 14 fractional bits, so each coefficient fits in a signed 16-bit lane
+constexpr int kInverseBits = 14;
+
+constexpr std::int32_t kRCr = ToFixed(1.402000, kInverseBits);
+constexpr std::int32_t kGCb = ToFixed(0.344136, kInverseBits);
+constexpr std::int32_t kGCr = ToFixed(0.714136, kInverseBits);
+constexpr std::int32_t kBCb = ToFixed(1.772000, kInverseBits);
+
+static_assert(kYR + kYG + kYB == 1 << kForwardBits, "Y must map white to 255");
+static_assert(kCbB - kCbR - kCbG == 0 && kCrR - kCrG - kCrB == 0, "Chroma must be zero for greys");
+
+/*
+    Clamps a fixed point result into the range of a channel
+
+    @param value The fixed point value to clamp
+    @returns The value's integer part, clamped to [0, 255]
+*/
+stbi_uc ClampInverse(std::int32_t value) noexcept
+{
+    return static_cast<stbi_uc>(std::clamp(value >> kInverseBits, 0, 255));
+}
+
+void RGBToYCbCrPixel(const stbi_uc* in, stbi_uc* out) noexcept
+{
+    const std::int32_t R = in[0];
+    const std::int32_t G = in[1];
+    const std::int32_t B = in[2];
+
+    out[0] = static_cast<stbi_uc>((kYR * R + kYG * G + kYB * B) >> kForwardBits);
+    out[1] = static_cast<stbi_uc>((kChromaBias - kCbR * R - kCbG * G + kCbB * B) >> kForwardBits);
+    out[2] = static_cast<stbi_uc>((kChromaBias + kCrR * R - kCrG * G - kCrB * B) >> kForwardBits);
+}
+
+void YCbCrToRGBPixel(const stbi_uc* in, stbi_uc* out) noexcept
+{
+    const std::int32_t Y = in[0] << kInverseBits;
+    const std::int32_t Cb = in[1] - 128;
+    const std::int32_t Cr = in[2] - 128;
+
+    out[0] = ClampInverse(Y + kRCr * Cr);
+    out[1] = ClampInverse(Y - kGCb * Cb - kGCr * Cr);
+    out[2] = ClampInverse(Y + kBCb * Cb);
+}
+
+void RGBToYCbCrScalar(const stbi_uc* in, stbi_uc* out, int width)
+{
+    for (auto w = 0; w < width; ++w, in += 3, out += 3)
+        RGBToYCbCrPixel(in, out);
+}
+
+void YCbCrToRGBScalar(const stbi_uc* in, stbi_uc* out, int width)
+{
+    for (auto w = 0; w < width; ++w, in += 3, out += 3)
+        YCbCrToRGBPixel(in, out);
+}
+
+#if defined(DPA_COLOR_KERNELS_X86)
+
+/*
+    Loads one channel of 8 interleaved pixels into 16-bit lanes
+
+    @param in The first channel of the first pixel
+    @returns The channel of each pixel, zero extended
+*/
+__m128i LoadChannelSSE2(const stbi_uc* in) noexcept
+{
+    return _mm_setr_epi16(in[0], in[3], in[6], in[9], in[12], in[15], in[18], in[21]);
+}
+
+/*
+    Interleaves three planes of 8 channels back into 8 pixels
+
+    @param out The first channel of the first destination pixel
+    @param a, b, c The saturated channels, packed into the low 8 bytes
+*/
+void StorePixelsSSE2(stbi_uc* out, __m128i a, __m128i b, __m128i c) noexcept
+{
+    alignas(16) stbi_uc planes[3][16];
+    _mm_store_si128(reinterpret_cast<__m128i*>(planes[0]), a);
+    _mm_store_si128(reinterpret_cast<__m128i*>(planes[1]), b);
+    _mm_store_si128(reinterpret_cast<__m128i*>(planes[2]), c);
+
+    for (auto i = 0; i < 8; ++i, out += 3)
+    {
+        out[0] = planes[0][i];
+        out[1] = planes[1][i];
+        out[2] = planes[2][i];
+    }
+}
+
+/*
+    Multiplies unsigned 16-bit lanes by an unsigned 16-bit coefficient,
+    widening the products into two vectors of 32-bit lanes
+
+    @param value The values to multiply
+    @param coefficient The coefficient, broadcast to every lane
+    @param low Receives the products of the lower 4 lanes
+    @param high Receives the products of the upper 4 lanes
+*/
+void MultiplyWidenSSE2(__m128i value, __m128i coefficient, __m128i& low, __m128i& high) noexcept
+{
+    const auto productLow = _mm_mullo_epi16(value, coefficient);
+    const auto productHigh = _mm_mulhi_epu16(value, coefficient);
+
+    low = _mm_unpacklo_epi16(productLow, productHigh);
+    high = _mm_unpackhi_epi16(productLow, productHigh);
+}
+
+/*
+    Computes (bias + a * ca + b * cb + c * cc) >> kForwardBits for 8 lanes, where each
+    coefficient's sign is applied after the unsigned multiply
+
+    @returns The 8 results, packed into the low 8 bytes with unsigned saturation
+*/
+__m128i DotForwardSSE2(__m128i a, __m128i b, __m128i c,
+                       std::int32_t ca, std::int32_t cb, std::int32_t cc, std::int32_t bias) noexcept
+{
+    __m128i aLow, aHigh, bLow, bHigh, cLow, cHigh;
+    MultiplyWidenSSE2(a, _mm_set1_epi16(static_cast<short>(std::abs(ca))), aLow, aHigh);
+    MultiplyWidenSSE2(b, _mm_set1_epi16(static_cast<short>(std::abs(cb))), bLow, bHigh);
+    MultiplyWidenSSE2(c, _mm_set1_epi16(static_cast<short>(std::abs(cc))), cLow, cHigh);
+
+    auto accumulate = [](__m128i sum, __m128i product, std::int32_t sign)
+    {
+        return sign < 0 ? _mm_sub_epi32(sum, product) : _mm_add_epi32(sum, product);
+    };
+
+    auto low = _mm_set1_epi32(bias);
+    low = accumulate(low, aLow, ca);
+    low = accumulate(low, bLow, cb);
+    low = accumulate(low, cLow, cc);
+
+    auto high = _mm_set1_epi32(bias);
+    high = accumulate(high, aHigh, ca);
+    high = accumulate(high, bHigh, cb);
+    high = accumulate(high, cHigh, cc);
+
+    const auto packed = _mm_packs_epi32(_mm_srai_epi32(low, kForwardBits), _mm_srai_epi32(high, kForwardBits));
+    return _mm_packus_epi16(packed, _mm_setzero_si128());
+}
+
+void RGBToYCbCrSSE2(const stbi_uc* in, stbi_uc* out, int width)
+{
+    auto w = 0;
+    for (; w + 8 <= width; w += 8, in += 24, out += 24)
+    {
+        const auto R = LoadChannelSSE2(in);
+        const auto G = LoadChannelSSE2(in + 1);
+        const auto B = LoadChannelSSE2(in + 2);
+
+        const auto Y = DotForwardSSE2(R, G, B, kYR, kYG, kYB, 0);
+        const auto Cb = DotForwardSSE2(R, G, B, -kCbR, -kCbG, kCbB, kChromaBias);
+        const auto Cr = DotForwardSSE2(R, G, B, kCrR, -kCrG, -kCrB, kChromaBias);
+
+        StorePixelsSSE2(out, Y, Cb, Cr);
+    }
+
+    RGBToYCbCrScalar(in, out, width - w);
+}
+
+/*
+    Computes (y << kInverseBits + chromaA * ca + chromaB * cb) >> kInverseBits for 8 lanes
+
+    @returns The 8 results, packed into the low 8 bytes and clamped to [0, 255]
+*/
+__m128i DotInverseSSE2(__m128i Y, __m128i Cb, __m128i Cr, std::int32_t cb, std::int32_t cr) noexcept
+{
+    const auto coefficients = _mm_setr_epi16(
+        static_cast<short>(cb), static_cast<short>(cr), static_cast<short>(cb), static_cast<short>(cr),
+        static_cast<short>(cb), static_cast<short>(cr), static_cast<short>(cb), static_cast<short>(cr));
+
+    const auto zero = _mm_setzero_si128();
+
+    auto low = _mm_madd_epi16(_mm_unpacklo_epi16(Cb, Cr), coefficients);
+    auto high = _mm_madd_epi16(_mm_unpackhi_epi16(Cb, Cr), coefficients);
+
+    low = _mm_add_epi32(low, _mm_slli_epi32(_mm_unpacklo_epi16(Y, zero), kInverseBits));
+    high = _mm_add_epi32(high, _mm_slli_epi32(_mm_unpackhi_epi16(Y, zero), kInverseBits));
+
+    const auto packed = _mm_packs_epi32(_mm_srai_epi32(low, kInverseBits), _mm_srai_epi32(high, kInverseBits));
+    return _mm_packus_epi16(packed, zero);
+}
+
+void YCbCrToRGBSSE2(const stbi_uc* in, stbi_uc* out, int width)
+{
+    const auto bias = _mm_set1_epi16(128);
+
+    auto w = 0;
+    for (; w + 8 <= width; w += 8, in += 24, out += 24)
+    {
+        const auto Y = LoadChannelSSE2(in);
+        const auto Cb = _mm_sub_epi16(LoadChannelSSE2(in + 1), bias);
+        const auto Cr = _mm_sub_epi16(LoadChannelSSE2(in + 2), bias);
+
+        const auto R = DotInverseSSE2(Y, Cb, Cr, 0, kRCr);
+        const auto G = DotInverseSSE2(Y, Cb, Cr, -kGCb, -kGCr);
+        const auto B = DotInverseSSE2(Y, Cb, Cr, kBCb, 0);
+
+        StorePixelsSSE2(out, R, G, B);
+    }
+
+    YCbCrToRGBScalar(in, out, width - w);
+}
+
+/*
+    Loads 8 interleaved pixels, 4 into each 128-bit lane, reading 28 bytes
+
+    @param in The first channel of the first pixel
+    @returns The pixels, with each lane holding 4 pixels in its low 12 bytes
+*/
+DPA_TARGET_AVX2 __m256i LoadPixelsAVX2(const stbi_uc* in) noexcept
+{
+    const auto low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    const auto high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 12));
+
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+}
+
+/*
+    Extracts one channel of the loaded pixels into zero extended 32-bit lanes
+
+    @tparam Channel The channel to extract
+    @param pixels The pixels returned by LoadPixelsAVX2
+    @returns The channel of each pixel
+*/
+template<char Channel>
+DPA_TARGET_AVX2 __m256i ExtractChannelAVX2(__m256i pixels) noexcept
+{
+    constexpr char z = -1;
+    constexpr char c0 = Channel, c1 = Channel + 3, c2 = Channel + 6, c3 = Channel + 9;
+
+    const auto mask = _mm256_setr_epi8(
+        c0, z, z, z, c1, z, z, z, c2, z, z, z, c3, z, z, z,
+        c0, z, z, z, c1, z, z, z, c2, z, z, z, c3, z, z, z);
+
+    return _mm256_shuffle_epi8(pixels, mask);
+}
+
+/*
+    Multiplies 32-bit lanes by a coefficient, keeping the low 32 bits of each product
+*/
+DPA_TARGET_AVX2 __m256i MultiplyAVX2(__m256i value, std::int32_t coefficient) noexcept
+{
+    return _mm256_mullo_epi32(value, _mm256_set1_epi32(coefficient));
+}
+
+/*
+    Shifts fixed point results down to integers and clamps them to [0, 255]
+*/
+DPA_TARGET_AVX2 __m256i ClampInverseAVX2(__m256i value) noexcept
+{
+    value = _mm256_srai_epi32(value, kInverseBits);
+    return _mm256_min_epi32(_mm256_max_epi32(value, _mm256_setzero_si256()), _mm256_set1_epi32(255));
+}
+
+/*
+    Interleaves three channels of 8 pixels and stores them, writing 28 bytes. The
+    4 bytes past the 8th pixel are clobbered
+
+    @param out The first channel of the first destination pixel
+    @param a, b, c The channels of each pixel, in [0, 255]
+*/
+DPA_TARGET_AVX2 void StorePixelsAVX2(stbi_uc* out, __m256i a, __m256i b, __m256i c) noexcept
+{
+    const char z = -1;
+    const auto mask = _mm256_setr_epi8(
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, z, z, z, z,
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, z, z, z, z);
+
+    const auto combined = _mm256_or_si256(a, _mm256_or_si256(_mm256_slli_epi32(b, 8), _mm256_slli_epi32(c, 16)));
+    const auto packed = _mm256_shuffle_epi8(combined, mask);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(packed));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm256_extracti128_si256(packed, 1));
+}
+
+DPA_TARGET_AVX2 void RGBToYCbCrAVX2(const stbi_uc* in, stbi_uc* out, int width)
+{
+    const auto bias = _mm256_set1_epi32(kChromaBias);
+
+    // Both the loads and stores run 4 bytes past the 8 pixels being converted,
+    // so leave at least 2 pixels for the scalar tail
+    auto w = 0;
+    for (; w + 10 <= width; w += 8, in += 24, out += 24)
+    {
+        const auto pixels = LoadPixelsAVX2(in);
+
+        const auto R = ExtractChannelAVX2<0>(pixels);
+        const auto G = ExtractChannelAVX2<1>(pixels);
+        const auto B = ExtractChannelAVX2<2>(pixels);
+
+        auto Y = _mm256_add_epi32(MultiplyAVX2(R, kYR), _mm256_add_epi32(MultiplyAVX2(G, kYG), MultiplyAVX2(B, kYB)));
+        auto Cb = _mm256_sub_epi32(_mm256_add_epi32(bias, MultiplyAVX2(B, kCbB)), _mm256_add_epi32(MultiplyAVX2(R, kCbR), MultiplyAVX2(G, kCbG)));
+        auto Cr = _mm256_sub_epi32(_mm256_add_epi32(bias, MultiplyAVX2(R, kCrR)), _mm256_add_epi32(MultiplyAVX2(G, kCrG), MultiplyAVX2(B, kCrB)));
+
+        Y = _mm256_srai_epi32(Y, kForwardBits);
+        Cb = _mm256_srai_epi32(Cb, kForwardBits);
+        Cr = _mm256_srai_epi32(Cr, kForwardBits);
+
+        StorePixelsAVX2(out, Y, Cb, Cr);
+    }
+
+    RGBToYCbCrScalar(in, out, width - w);
+}
+
+DPA_TARGET_AVX2 void YCbCrToRGBAVX2(const stbi_uc* in, stbi_uc* out, int width)
+{
+    const auto bias = _mm256_set1_epi32(128);
+
+    auto w = 0;
+    for (; w + 10 <= width; w += 8, in += 24, out += 24)
+    {
+        const auto pixels = LoadPixelsAVX2(in);
+
+        const auto Y = _mm256_slli_epi32(ExtractChannelAVX2<0>(pixels), kInverseBits);
+        const auto Cb = _mm256_sub_epi32(ExtractChannelAVX2<1>(pixels), bias);
+        const auto Cr = _mm256_sub_epi32(ExtractChannelAVX2<2>(pixels), bias);
+
+        const auto R = ClampInverseAVX2(_mm256_add_epi32(Y, MultiplyAVX2(Cr, kRCr)));
+        const auto G = ClampInverseAVX2(_mm256_sub_epi32(Y, _mm256_add_epi32(MultiplyAVX2(Cb, kGCb), MultiplyAVX2(Cr, kGCr))));
+        const auto B = ClampInverseAVX2(_mm256_add_epi32(Y, MultiplyAVX2(Cb, kBCb)));
+
+        StorePixelsAVX2(out, R, G, B);
+    }
+
+    YCbCrToRGBScalar(in, out, width - w);
+}
+
+#endif
+}
+
+namespace dpa::image::internal
+{
+ColorKernelIsa DetectColorKernelIsa() noexcept
+{
+#if defined(DPA_COLOR_KERNELS_X86)
+    #if defined(_MSC_VER)
+        int info[4]{};
+        __cpuid(info, 0);
+        const auto maxLeaf = info[0];
+
+        __cpuid(info, 1);
+        const bool hasSSE2 = (info[3] & (1 << 26)) != 0;
+        const bool hasAVX = (info[2] & (1 << 28)) != 0;
+        const bool hasOSXSave = (info[2] & (1 << 27)) != 0;
+
+        // The OS has to save the upper halves of the ymm registers on a context switch
+        bool hasAVX2 = false;
+        if (maxLeaf >= 7 && hasAVX && hasOSXSave && (_xgetbv(0) & 0x6) == 0x6)
+        {
+            __cpuidex(info, 7, 0);
+            hasAVX2 = (info[1] & (1 << 5)) != 0;
+        }
+    #else
+        __builtin_cpu_init();
+
+        const bool hasSSE2 = __builtin_cpu_supports("sse2") != 0;
+        const bool hasAVX2 = __builtin_cpu_supports("avx2") != 0;
+    #endif
+
+    if (hasAVX2)
+        return ColorKernelIsa::eAVX2;
+
+    if (hasSSE2)
+        return ColorKernelIsa::eSSE2;
+#endif
+
+    return ColorKernelIsa::eScalar;
+}
+
+ColorKernels GetColorKernels(ColorKernelIsa isa) noexcept
+{
+#if defined(DPA_COLOR_KERNELS_X86)
+    switch (isa)
+    {
+    case ColorKernelIsa::eAVX2:
+        return { ColorKernelIsa::eAVX2, RGBToYCbCrAVX2, YCbCrToRGBAVX2 };
+    case ColorKernelIsa::eSSE2:
+        return { ColorKernelIsa::eSSE2, RGBToYCbCrSSE2, YCbCrToRGBSSE2 };
+    default:
+        break;
+    }
+#else
+    static_cast<void>(isa);
+#endif
+
+    return { ColorKernelIsa::eScalar, RGBToYCbCrScalar, YCbCrToRGBScalar };
+}
+
+const ColorKernels& GetColorKernels() noexcept
+{
+    static const ColorKernels kernels = GetColorKernels(DetectColorKernelIsa());
+    return kernels;
+}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+
+#include <stb_image.h>
+
+namespace dpa::image::internal
+{
+/*
+    The instruction sets the colour conversion kernels are implemented with,
+    ordered from least to most capable
+*/
+enum class ColorKernelIsa
+{
+    eScalar, eSSE2, eAVX2
+};
+
+/*
+    Converts a row of interleaved 8-bit pixels from one colour space to another.
+    The input and output rows must not overlap
+
+    @param in The first channel of the first pixel in the source row
+    @param out The first channel of the first pixel in the destination row
+    @param width The number of pixels in the row
+*/
+using ColorRowKernel = void(*)(const stbi_uc* in, stbi_uc* out, int width);
+
+/*
+    A matching set of colour conversion kernels. Every kernel set produces
+    bit-identical results, so the output never depends on the machine it ran on
+*/
+struct ColorKernels
+{
+    ColorKernelIsa isa{ ColorKernelIsa::eScalar };
+
+    ColorRowKernel rgbToYCbCr{ nullptr };
+    ColorRowKernel yCbCrToRGB{ nullptr };
+};
+
+/*
+    Determines the most capable instruction set that's both compiled in
+    and supported by the CPU we're running on
+
+    @returns The best available instruction set
+*/
+ColorKernelIsa DetectColorKernelIsa() noexcept;
+
+/*
+    Gets the kernels implemented with the given instruction set. If they
+    aren't compiled in, the next most capable kernels are returned instead.
+    The caller is responsible for checking the CPU supports the instruction set
+
+    @param isa The instruction set to get the kernels for
+    @returns The kernels for the instruction set
+*/
+ColorKernels GetColorKernels(ColorKernelIsa isa) noexcept;
+
+/*
+    Gets the kernels for the best instruction set on this machine. This is
+    detected once, the first time it's called
+
+    @returns The fastest kernels available
+*/
+const ColorKernels& GetColorKernels() noexcept;
+}
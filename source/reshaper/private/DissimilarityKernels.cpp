@@ -0,0 +1,253 @@
+#include <DissimilarityKernels.h>
+
+#include <LatticeGraph.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    #define DPA_DISSIMILARITY_KERNELS_X86
+
+    #include <immintrin.h>
+
+    #if defined(_MSC_VER)
+        // MSVC allows any intrinsic to be used without changing the target architecture
+        #define DPA_TARGET_AVX2
+    #else
+        #define DPA_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+namespace
+{
+using dpa::graph::internal::DissimilarityThresholds;
+using dpa::graph::internal::LatticeDirection;
+using dpa::graph::internal::PlanarRow;
+
+/*
+    Gets the bit a direction is stored in, in a neighbour mask
+
+    @param direction The direction to get the bit of
+    @returns The direction's bit
+*/
+constexpr std::uint8_t DirectionBit(LatticeDirection direction) noexcept
+{
+    return static_cast<std::uint8_t>(1 << static_cast<std::uint8_t>(direction));
+}
+
+constexpr std::uint8_t kEastBit = DirectionBit(LatticeDirection::eEast);
+constexpr std::uint8_t kSouthBit = DirectionBit(LatticeDirection::eSouth);
+constexpr std::uint8_t kSouthWestBit = DirectionBit(LatticeDirection::eSouthWest);
+constexpr std::uint8_t kSouthEastBit = DirectionBit(LatticeDirection::eSouthEast);
+
+constexpr bool IsDissimilarChannel(stbi_uc a, stbi_uc b, stbi_uc threshold) noexcept
+{
+    return ((a > b) ? a - b : b - a) >= threshold;
+}
+
+bool IsDissimilar(const PlanarRow& a, int i, const PlanarRow& b, int j, const DissimilarityThresholds& thresholds) noexcept
+{
+    return IsDissimilarChannel(a.Y[i], b.Y[j], thresholds.Y) ||
+           IsDissimilarChannel(a.Cb[i], b.Cb[j], thresholds.Cb) ||
+           IsDissimilarChannel(a.Cr[i], b.Cr[j], thresholds.Cr);
+}
+
+/*
+    Finds the dissimilar edges of a range of pixels in a row, one pixel at a time
+
+    @param first The first pixel in the range
+    @param last One past the last pixel in the range
+*/
+void FindDissimilarEdgesRange(const PlanarRow& row, const PlanarRow& next,
+    const DissimilarityThresholds& thresholds, std::uint8_t* out, int width, int first, int last)
+{
+    for (auto w = first; w < last; ++w)
+    {
+        std::uint8_t mask = 0;
+        const bool hasEast = w + 1 < width;
+
+        if (hasEast && IsDissimilar(row, w, row, w + 1, thresholds))
+            mask |= kEastBit;
+
+        if (next.Y)
+        {
+            if (IsDissimilar(row, w, next, w, thresholds))
+                mask |= kSouthBit;
+
+            if (w > 0 && IsDissimilar(row, w, next, w - 1, thresholds))
+                mask |= kSouthWestBit;
+
+            if (hasEast && IsDissimilar(row, w, next, w + 1, thresholds))
+                mask |= kSouthEastBit;
+        }
+
+        out[w] = mask;
+    }
+}
+
+void FindDissimilarEdgesScalar(const PlanarRow& row, const PlanarRow& next,
+    const DissimilarityThresholds& thresholds, std::uint8_t* out, int width)
+{
+    FindDissimilarEdgesRange(row, next, thresholds, out, width, 0, width);
+}
+
+#if defined(DPA_DISSIMILARITY_KERNELS_X86)
+
+/*
+    Compares one channel of 16 pixels against 16 others
+
+    @param lhs The channel of the first pixels
+    @param rhs The channel of the second pixels
+    @param threshold The channel's threshold, broadcast to every lane
+    @returns 0xFF in each lane where the difference reaches the threshold, zero otherwise
+*/
+__m128i CompareChannelSSE2(const stbi_uc* lhs, const stbi_uc* rhs, __m128i threshold) noexcept
+{
+    const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs));
+    const auto y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs));
+
+    // Unsigned bytes have no absolute difference, but only one of the saturated differences is non-zero
+    const auto delta = _mm_or_si128(_mm_subs_epu8(x, y), _mm_subs_epu8(y, x));
+    return _mm_cmpeq_epi8(_mm_max_epu8(delta, threshold), delta);
+}
+
+/*
+    Compares 16 pixels against 16 others, one channel at a time
+
+    @param a The row of the first pixels, starting at pixel i
+    @param b The row of the second pixels, starting at pixel j
+    @param thresholds Each channel's threshold, broadcast to every lane
+    @returns 0xFF in each lane where the pixels are dissimilar, zero otherwise
+*/
+__m128i DissimilarSSE2(const PlanarRow& a, int i, const PlanarRow& b, int j, const __m128i (&thresholds)[3]) noexcept
+{
+    return _mm_or_si128(CompareChannelSSE2(a.Y + i, b.Y + j, thresholds[0]),
+           _mm_or_si128(CompareChannelSSE2(a.Cb + i, b.Cb + j, thresholds[1]),
+                        CompareChannelSSE2(a.Cr + i, b.Cr + j, thresholds[2])));
+}
+
+void FindDissimilarEdgesSSE2(const PlanarRow& row, const PlanarRow& next,
+    const DissimilarityThresholds& thresholds, std::uint8_t* out, int width)
+{
+    const __m128i limits[3] = { _mm_set1_epi8(static_cast<char>(thresholds.Y)),
+                                _mm_set1_epi8(static_cast<char>(thresholds.Cb)),
+                                _mm_set1_epi8(static_cast<char>(thresholds.Cr)) };
+
+    const auto east = _mm_set1_epi8(static_cast<char>(kEastBit));
+    const auto south = _mm_set1_epi8(static_cast<char>(kSouthBit));
+    const auto southWest = _mm_set1_epi8(static_cast<char>(kSouthWestBit));
+    const auto southEast = _mm_set1_epi8(static_cast<char>(kSouthEastBit));
+
+    // The first pixel has no south west neighbour, and every pixel in a block
+    // needs an east one, so the vectorized blocks run from 1 to width - 1
+    FindDissimilarEdgesRange(row, next, thresholds, out, width, 0, width < 1 ? width : 1);
+
+    auto w = 1;
+    for (; w + 17 <= width; w += 16)
+    {
+        auto mask = _mm_and_si128(DissimilarSSE2(row, w, row, w + 1, limits), east);
+
+        if (next.Y)
+        {
+            mask = _mm_or_si128(mask, _mm_and_si128(DissimilarSSE2(row, w, next, w, limits), south));
+            mask = _mm_or_si128(mask, _mm_and_si128(DissimilarSSE2(row, w, next, w - 1, limits), southWest));
+            mask = _mm_or_si128(mask, _mm_and_si128(DissimilarSSE2(row, w, next, w + 1, limits), southEast));
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + w), mask);
+    }
+
+    FindDissimilarEdgesRange(row, next, thresholds, out, width, w, width);
+}
+
+/*
+    Compares one channel of 32 pixels against 32 others
+
+    @param lhs The channel of the first pixels
+    @param rhs The channel of the second pixels
+    @param threshold The channel's threshold, broadcast to every lane
+    @returns 0xFF in each lane where the difference reaches the threshold, zero otherwise
+*/
+DPA_TARGET_AVX2 __m256i CompareChannelAVX2(const stbi_uc* lhs, const stbi_uc* rhs, __m256i threshold) noexcept
+{
+    const auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs));
+    const auto y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs));
+
+    const auto delta = _mm256_or_si256(_mm256_subs_epu8(x, y), _mm256_subs_epu8(y, x));
+    return _mm256_cmpeq_epi8(_mm256_max_epu8(delta, threshold), delta);
+}
+
+/*
+    Compares 32 pixels against 32 others, one channel at a time
+
+    @param a The row of the first pixels, starting at pixel i
+    @param b The row of the second pixels, starting at pixel j
+    @param thresholds Each channel's threshold, broadcast to every lane
+    @returns 0xFF in each lane where the pixels are dissimilar, zero otherwise
+*/
+DPA_TARGET_AVX2 __m256i DissimilarAVX2(const PlanarRow& a, int i, const PlanarRow& b, int j, const __m256i (&thresholds)[3]) noexcept
+{
+    return _mm256_or_si256(CompareChannelAVX2(a.Y + i, b.Y + j, thresholds[0]),
+           _mm256_or_si256(CompareChannelAVX2(a.Cb + i, b.Cb + j, thresholds[1]),
+                           CompareChannelAVX2(a.Cr + i, b.Cr + j, thresholds[2])));
+}
+
+DPA_TARGET_AVX2 void FindDissimilarEdgesAVX2(const PlanarRow& row, const PlanarRow& next,
+    const DissimilarityThresholds& thresholds, std::uint8_t* out, int width)
+{
+    const __m256i limits[3] = { _mm256_set1_epi8(static_cast<char>(thresholds.Y)),
+                                _mm256_set1_epi8(static_cast<char>(thresholds.Cb)),
+                                _mm256_set1_epi8(static_cast<char>(thresholds.Cr)) };
+
+    const auto east = _mm256_set1_epi8(static_cast<char>(kEastBit));
+    const auto south = _mm256_set1_epi8(static_cast<char>(kSouthBit));
+    const auto southWest = _mm256_set1_epi8(static_cast<char>(kSouthWestBit));
+    const auto southEast = _mm256_set1_epi8(static_cast<char>(kSouthEastBit));
+
+    FindDissimilarEdgesRange(row, next, thresholds, out, width, 0, width < 1 ? width : 1);
+
+    auto w = 1;
+    for (; w + 33 <= width; w += 32)
+    {
+        auto mask = _mm256_and_si256(DissimilarAVX2(row, w, row, w + 1, limits), east);
+
+        if (next.Y)
+        {
+            mask = _mm256_or_si256(mask, _mm256_and_si256(DissimilarAVX2(row, w, next, w, limits), south));
+            mask = _mm256_or_si256(mask, _mm256_and_si256(DissimilarAVX2(row, w, next, w - 1, limits), southWest));
+            mask = _mm256_or_si256(mask, _mm256_and_si256(DissimilarAVX2(row, w, next, w + 1, limits), southEast));
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + w), mask);
+    }
+
+    FindDissimilarEdgesRange(row, next, thresholds, out, width, w, width);
+}
+
+#endif
+}
+
+namespace dpa::graph::internal
+{
+DissimilarityKernels GetDissimilarityKernels(ColorKernelIsa isa) noexcept
+{
+#if defined(DPA_DISSIMILARITY_KERNELS_X86)
+    switch (isa)
+    {
+    case ColorKernelIsa::eAVX2:
+        return { ColorKernelIsa::eAVX2, FindDissimilarEdgesAVX2 };
+    case ColorKernelIsa::eSSE2:
+        return { ColorKernelIsa::eSSE2, FindDissimilarEdgesSSE2 };
+    default:
+        break;
+    }
+#else
+    static_cast<void>(isa);
+#endif
+
+    return { ColorKernelIsa::eScalar, FindDissimilarEdgesScalar };
+}
+
+const DissimilarityKernels& GetDissimilarityKernels() noexcept
+{
+    static const DissimilarityKernels kernels = GetDissimilarityKernels(dpa::image::internal::DetectColorKernelIsa());
+    return kernels;
+}
+}
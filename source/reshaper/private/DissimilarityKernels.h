@@ -0,0 +1,78 @@
+#pragma once
+
+#include <ColorConversion.h>
+
+#include <cstdint>
+
+#include <stb_image.h>
+
+namespace dpa::graph::internal
+{
+using dpa::image::internal::ColorKernelIsa;
+
+/*
+    The smallest absolute difference in each channel that makes two pixels dissimilar
+*/
+struct DissimilarityThresholds
+{
+    stbi_uc Y{ 1 };
+    stbi_uc Cb{ 1 };
+    stbi_uc Cr{ 1 };
+};
+
+/*
+    A row of an image split into separate Y, Cb and Cr planes
+*/
+struct PlanarRow
+{
+    const stbi_uc* Y{ nullptr };
+    const stbi_uc* Cb{ nullptr };
+    const stbi_uc* Cr{ nullptr };
+};
+
+/*
+    Finds the dissimilar edges each pixel in a row owns. These are the edges it
+    leaves in the east, south, south west and south east directions, and the
+    dissimilar ones are written as a neighbour mask, with bit n set for the
+    LatticeDirection with an underlying value of n. Edges that would leave
+    the image are never set
+
+    @param row The row to find the dissimilar edges of
+    @param next The row below it, or a row of null planes if it's the last row
+    @param thresholds The smallest differences that are dissimilar
+    @param out The mask of each pixel in the row
+    @param width The number of pixels in the row
+*/
+using DissimilarityRowKernel = void(*)(const PlanarRow& row, const PlanarRow& next,
+    const DissimilarityThresholds& thresholds, std::uint8_t* out, int width);
+
+/*
+    The dissimilarity kernel implemented with some instruction set. Every
+    kernel produces identical masks, so the output never depends on the
+    machine it ran on
+*/
+struct DissimilarityKernels
+{
+    ColorKernelIsa isa{ ColorKernelIsa::eScalar };
+
+    DissimilarityRowKernel findDissimilarEdges{ nullptr };
+};
+
+/*
+    Gets the kernel implemented with the given instruction set. If it isn't
+    compiled in, the next most capable kernel is returned instead. The caller
+    is responsible for checking the CPU supports the instruction set
+
+    @param isa The instruction set to get the kernel for
+    @returns The kernel for the instruction set
+*/
+DissimilarityKernels GetDissimilarityKernels(ColorKernelIsa isa) noexcept;
+
+/*
+    Gets the kernel for the best instruction set on this machine. This is
+    detected once, the first time it's called
+
+    @returns The fastest kernel available
+*/
+const DissimilarityKernels& GetDissimilarityKernels() noexcept;
+}
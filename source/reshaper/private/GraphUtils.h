@@ -2,10 +2,16 @@
 
 #include <cmath>
 
+#include <array>
+#include <bitset>
+#include <cstdint>
 #include <limits>
 #include <tuple>
+#include <vector>
 
 #include <boost/graph/depth_first_search.hpp>
+#include <boost/graph/properties.hpp>
+#include <boost/range/iterator_range.hpp>
 
 namespace dpa::graph::utility
 {
@@ -143,36 +149,213 @@ constexpr Point2D<Vertex> GetCrossingEdge(const Vertex start, const Vertex end,
 }
 
 /*
-    A dfs visitor that counts the number of edges in a curve
-    feature in the similarity graph
+    Decomposes a graph into chains of valence-2 vertices, and records the
+    length of the curve each chain is part of. This is built once in linear time,
+    after which the curve length of any vertex can be looked up in constant time
 */
-class EdgeCounter : public boost::default_dfs_visitor
+class ValenceChains
 {
 public:
 
-    explicit EdgeCounter(long long& count)
-        : m_length(count)
-    {}
+    /*
+        Labels every valence-2 vertex in the graph with the chain it belongs to.
+        A chain's curve length is the number of edges a depth first visit from any
+        of its vertices would traverse, if the visit stopped at every vertex that
+        doesn't have a valence of 2. That's every vertex in the chain, plus the
+        distinct vertices the chain ends on, minus one
+
+        @param graph The graph to decompose
+    */
+    template<typename Graph>
+    void build(const Graph& graph)
+    {
+        // The graph functions are called unqualified so they're found through ADL
+        const auto index = get(boost::vertex_index, graph);
+        const auto vertexCount = num_vertices(graph);
+
+        std::vector<bool> isChain(vertexCount);
+        for (const auto vertex : boost::make_iterator_range(vertices(graph)))
+            isChain[index[vertex]] = out_degree(vertex, graph) == 2;
+
+        m_chainIds.assign(vertexCount, kNoChain);
+        m_chainLengths.clear();
+
+        std::vector<typename boost::graph_traits<Graph>::vertex_descriptor> stack;
+        for (const auto start : boost::make_iterator_range(vertices(graph)))
+        {
+            if (!isChain[index[start]] || m_chainIds[index[start]] != kNoChain)
+                continue;
+
+            const auto chainId = static_cast<std::uint32_t>(m_chainLengths.size());
+            m_chainIds[index[start]] = chainId;
+            stack.assign(1, start);
+
+            long long chainSize = 0;
+            long long endCount = 0;
+            std::size_t firstEnd = 0;
+
+            while (!stack.empty())
+            {
+                const auto vertex = stack.back();
+                stack.pop_back();
+                ++chainSize;
+
+                for (const auto& edge : boost::make_iterator_range(out_edges(vertex, graph)))
+                {
+                    const auto neighbour = target(edge, graph);
+                    const auto neighbourIndex = index[neighbour];
+
+                    if (!isChain[neighbourIndex])
+                    {
+                        // Both ends of a chain can land on the same vertex
+                        if (!endCount)
+                        {
+                            firstEnd = neighbourIndex;
+                            endCount = 1;
+                        }
+                        else if (neighbourIndex != firstEnd)
+                        {
+                            endCount = 2;
+                        }
+                    }
+                    else if (m_chainIds[neighbourIndex] == kNoChain)
+                    {
+                        m_chainIds[neighbourIndex] = chainId;
+                        stack.push_back(neighbour);
+                    }
+                }
+            }
+
+            m_chainLengths.push_back(chainSize + endCount - 1);
+        }
 
-    EdgeCounter(const EdgeCounter& other)
-        : m_length(other.m_length)
-    {}
+        m_built = true;
+    }
 
     /*
-        Increments the edge count by 1 for every edge examined
+        Determines if the chains have been built
 
-        @param edge Unused
-        @param graph Unused
+        @returns True if build has been called, false otherwise
     */
-    template<typename Edge, typename Graph>
-    void tree_edge(Edge, const Graph&)
+    bool isBuilt() const noexcept
     {
-        ++m_length;
+        return m_built;
+    }
+
+    /*
+        Forgets the chains, so the next lookup has to build them again
+        from whatever graph it's given
+    */
+    void reset() noexcept
+    {
+        m_chainIds.clear();
+        m_chainLengths.clear();
+        m_built = false;
+    }
+
+    /*
+        Gets the length of the curve passing through the given vertex. Vertices
+        that don't have a valence of 2 aren't part of a curve, and have a length of 1
+
+        @param vertex The index of the vertex
+        @returns The length of the curve
+    */
+    long long getCurveLength(std::size_t vertex) const noexcept
+    {
+        const auto chainId = m_chainIds[vertex];
+        return chainId == kNoChain ? 1 : m_chainLengths[chainId];
     }
 
 private:
 
-    long long& m_length;
+    static constexpr std::uint32_t kNoChain = std::numeric_limits<std::uint32_t>::max();
+
+    std::vector<std::uint32_t> m_chainIds{};
+    std::vector<long long> m_chainLengths{};
 
+    bool m_built{ false };
 };
-}
\ No newline at end of file
+
+/*
+    A flood fill that's confined to a square window of the graph's pixel lattice.
+    The visited set is a bitmap over the window and its one pixel border, and the
+    work list is a fixed size stack, so nothing is allocated on the heap
+
+    @tparam WindowSize The width and height of the window, in pixels
+*/
+template<std::size_t WindowSize>
+class WindowFloodFill
+{
+public:
+
+    /*
+        Counts the edges a depth first visit from the given vertex would traverse, if
+        the visit stopped at every vertex outside of the window. Those are all the vertices
+        connected to the start through the window, plus their neighbours just outside
+        of it, minus one
+
+        @param graph The graph to search
+        @param start The vertex to start at
+        @param imageWidth The width of the image the graph was built from
+        @param origin The (x, y) position of the top left pixel of the window
+        @returns The number of edges traversed, or 0 if the start is outside the window
+    */
+    template<typename Graph>
+    static long long CountEdges(const Graph& graph, std::size_t start, std::size_t imageWidth,
+                                const Point2D<long long>& origin) noexcept
+    {
+        // The window, plus a border for the vertices the search stops at
+        constexpr auto kSide = WindowSize + 2;
+
+        const auto [left, top] = origin;
+
+        auto withinWindow = [&](long long x, long long y)
+        {
+            return left <= x && x < left + static_cast<long long>(WindowSize) &&
+                   top <= y && y < top + static_cast<long long>(WindowSize);
+        };
+
+        auto cellOf = [&](long long x, long long y)
+        {
+            return static_cast<std::size_t>((y - top + 1) * static_cast<long long>(kSide) + (x - left + 1));
+        };
+
+        const auto [startX, startY] = ExpandIndex<long long>(start, imageWidth);
+        if (!withinWindow(startX, startY))
+            return 0;
+
+        std::bitset<kSide * kSide> discovered;
+        discovered.set(cellOf(startX, startY));
+
+        // Only vertices inside the window are expanded, so each is pushed at most once
+        std::array<std::size_t, WindowSize * WindowSize> stack;
+        std::size_t stackSize = 0;
+        stack[stackSize++] = start;
+
+        long long edgeCount = 0;
+        while (stackSize)
+        {
+            const auto vertex = stack[--stackSize];
+
+            // The graph functions are called unqualified so they're found through ADL
+            for (const auto& edge : boost::make_iterator_range(out_edges(vertex, graph)))
+            {
+                const std::size_t neighbour = target(edge, graph);
+                const auto [x, y] = ExpandIndex<long long>(neighbour, imageWidth);
+
+                const auto cell = cellOf(x, y);
+                if (discovered.test(cell))
+                    continue;
+
+                discovered.set(cell);
+                ++edgeCount;
+
+                if (withinWindow(x, y))
+                    stack[stackSize++] = neighbour;
+            }
+        }
+
+        return edgeCount;
+    }
+};
+}
@@ -1,26 +1,91 @@
 #include <HeuristicHelper.h>
 
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+/*
+    Gets the slot an edge's orientation is stored in. The two orientations
+    of an edge point in opposite directions, so they differ in the lowest bit
+
+    @param edge An edge in the lattice graph
+    @returns The key of the edge's orientation in the lookup
+*/
+std::size_t GetSlot(const dpa::graph::internal::LatticeEdge& edge) noexcept
+{
+    return edge.index() * 2 + (static_cast<std::uint8_t>(edge.direction) & 1);
+}
+}
+
 namespace dpa::graph::heuristics
 {
-void HeuristicHelper::clearMarkedEdges(const boost::uuids::uuid& uuid) noexcept
+void EdgeMarks::reset(std::size_t numMarks)
+{
+    m_marked.clear();
+    m_lookup.clear();
+    resize(numMarks);
+}
+
+void EdgeMarks::clear() noexcept
+{
+    std::fill(std::begin(m_lookup), std::end(m_lookup), LookupEntry{});
+    m_marked.clear();
+}
+
+void EdgeMarks::mark(const internal::LatticeEdge& edge, EdgeProperty value)
 {
-    m_markedEdges.erase(uuid);
+    if (2 * (m_marked.size() + 1) > m_lookup.size())
+        resize(2 * (m_marked.size() + 1));
+
+    const auto slot = GetSlot(edge);
+    if (auto& entry = find(slot); entry.mark)
+    {
+        m_marked[entry.mark - 1].second = value;
+    }
+    else
+    {
+        m_marked.emplace_back(edge, value);
+        entry = { slot, static_cast<std::uint32_t>(m_marked.size()) };
+    }
 }
 
-const HeuristicHelper::EdgeMap& HeuristicHelper::getMarkedEdges(const boost::uuids::uuid& uuid) noexcept
+EdgeMarks::LookupEntry& EdgeMarks::find(std::size_t slot) noexcept
 {
-    return m_markedEdges[uuid];
+    // Fibonacci hashing spreads the neighbouring slots of a crossing block across the table
+    const std::size_t mask = m_lookup.size() - 1;
+    std::size_t index = static_cast<std::size_t>((static_cast<std::uint64_t>(slot) * 0x9E3779B97F4A7C15ull) >> m_lookupShift) & mask;
+
+    while (m_lookup[index].mark && m_lookup[index].slot != slot)
+        index = (index + 1) & mask;
+
+    return m_lookup[index];
 }
 
-void HeuristicHelper::insertMarkedEdge(const boost::uuids::uuid& uuid, const Edge& edge,
-                                       EdgeProperty value) noexcept
+void EdgeMarks::resize(std::size_t numMarks)
 {
-    m_markedEdges[uuid][edge] = value;
+    std::size_t size = kMinLookupSize;
+    m_lookupShift = 64 - kMinLookupBits;
+    while (size < 2 * numMarks)
+    {
+        size *= 2;
+        --m_lookupShift;
+    }
+
+    m_lookup.assign(size, LookupEntry{});
+    for (std::size_t i = 0; i < m_marked.size(); ++i)
+    {
+        const auto slot = GetSlot(m_marked[i].first);
+        find(slot) = { slot, static_cast<std::uint32_t>(i + 1) };
+    }
 }
 
-HeuristicHelper& HeuristicHelper::instance() noexcept
+EdgeMarks::EdgeMap EdgeMarks::toEdgeMap() const
 {
-    static HeuristicHelper instance;
-    return instance;
+    EdgeMap ret;
+    for (const auto& [edge, value] : m_marked)
+        ret.emplace(Edge{ edge.source, edge.target }, value);
+
+    return ret;
 }
 }
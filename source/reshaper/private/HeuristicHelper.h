@@ -1,74 +1,148 @@
 #pragma once
 
+#include <LatticeGraph.h>
+
+#include <array>
+#include <cstdint>
 #include <map>
-#include <unordered_map>
 #include <tuple>
+#include <utility>
 #include <variant>
-
-#include <boost/uuid/uuid_hash.hpp>
+#include <vector>
 
 namespace dpa::graph::heuristics
 {
 /*
-    A singleton class that stores arbitrary edge properties
-    based on what a specific heuristic discovers during its
-    graph traversal
+    Stores the edge properties a heuristic discovers during its graph
+    traversal. Each heuristic owns one of these, which is shared by every
+    copy of the heuristic the search makes, so concurrent runs never touch
+    each other's marks.
+
+    Marks are looked up through a small hash table keyed by the lattice edge
+    id and orientation, which is sized to the marks a search expects to make
+    rather than to the whole graph. They're recorded in the order they're made,
+    so applying them back to the graph never has to search for the marked edges
 */
-class HeuristicHelper
+class EdgeMarks
 {
 public:
 
     using Edge = std::tuple<std::size_t, std::size_t>;
     using EdgeProperty = std::variant<bool, double>;
     using EdgeMap = std::map<Edge, EdgeProperty>;
-    using HashedEdgeMap = std::unordered_map<boost::uuids::uuid, EdgeMap,
-        boost::hash<boost::uuids::uuid>>;
+    using MarkedEdge = std::pair<internal::LatticeEdge, EdgeProperty>;
 
 public:
 
     /*
-        Clears the edges set by the heuristic with the given uuid
+        Clears the marks, and sizes the lookup for the given number of them. More
+        marks than that can still be made, but the lookup has to grow to hold them
+
+        @param numMarks The number of marks the search is expected to make
+    */
+    void reset(std::size_t numMarks);
+
+    /*
+        Clears the marks
+    */
+    void clear() noexcept;
+
+    /*
+        Marks an edge in the orientation it was given in. Marking the same
+        orientation again overwrites its value
 
-        @param uuid The uuid of the heuristic
+        @param edge An edge_descriptor in the lattice graph
+        @param value The property to mark the edge with
     */
-    void clearMarkedEdges(const boost::uuids::uuid& uuid) noexcept;
+    void mark(const internal::LatticeEdge& edge, EdgeProperty value);
 
     /*
-        Gets the marked edges set by the heuristic with the given uuid
-        
-        @param uuid The uuid of the heuristic
+        Gets the marked edges, in the order they were first marked
+
         @returns A constant reference to the marked edges
     */
-    const EdgeMap& getMarkedEdges(const boost::uuids::uuid& uuid) noexcept;
+    const std::vector<MarkedEdge>& getMarked() const noexcept { return m_marked; }
 
     /*
-        Inserts a marked edge into the edge map associated with the
-        heuristic with the given uuid
+        Gets the marked edges keyed by their (source, target) vertices
 
-        @param uuid
-        @param edge An edge_descriptor in the graph
+        @returns The marked edges, ordered by their vertices
     */
-    void insertMarkedEdge(const boost::uuids::uuid& uuid, const Edge& edge,
-                          EdgeProperty value) noexcept;
+    EdgeMap toEdgeMap() const;
 
 private:
 
-    HashedEdgeMap m_markedEdges{};
+    /*
+        An entry in the lookup, which maps an edge orientation onto
+        one plus the position of its mark, or zero if it's empty
+    */
+    struct LookupEntry
+    {
+        std::size_t slot{ 0 };
+        std::uint32_t mark{ 0 };
+    };
+
+    /*
+        Finds the entry for an edge orientation, which is empty if the orientation isn't marked
+
+        @param slot The edge's index and orientation
+        @returns A reference to the orientation's entry
+    */
+    LookupEntry& find(std::size_t slot) noexcept;
+
+    /*
+        Resizes the lookup to hold at least the given number of marks, re-entering the current ones
+
+        @param numMarks The number of marks to make room for
+    */
+    void resize(std::size_t numMarks);
 
 private:
 
-    friend class Curves;
-    friend class DissimilarPixels;
-    friend class Islands;
-    friend class SparsePixels;
+    static constexpr std::size_t kMinLookupBits = 4;
+    static constexpr std::size_t kMinLookupSize = std::size_t{ 1 } << kMinLookupBits;
 
-    // Just look the other way..
-    HeuristicHelper() = default;
+    // An open addressing table, with a power of two entries that's kept at most half full.
+    // The shift takes a slot's hash down to the bits that index the table
+    std::vector<LookupEntry> m_lookup{};
+    std::size_t m_lookupShift{ 0 };
 
-    static HeuristicHelper& instance() noexcept;
+    std::vector<MarkedEdge> m_marked{};
 
 };
 
+/*
+    The weights a heuristic awards to the diagonals of a crossing block. There's
+    one for each orientation, in the order top left to bottom right, bottom right
+    to top left, top right to bottom left, and bottom left to top right
+*/
+using BlockWeights = std::array<double, 4>;
+
+/*
+    Splits the votes on a crossing block into the weights of its orientations.
+    A positive vote goes to the orientation it was cast for, and a negative
+    one goes to the orientation that crosses it
+
+    @param topLeftVote The vote for top left to bottom right, against bottom left to top right
+    @param bottomRightVote The vote for bottom right to top left, against top right to bottom left
+    @returns The weights of each orientation of the block's diagonals
+*/
+inline BlockWeights SplitBlockVotes(double topLeftVote, double bottomRightVote) noexcept
+{
+    BlockWeights weights{};
+    if (topLeftVote > 0)
+        weights[0] = topLeftVote;
+    else if (topLeftVote < 0)
+        weights[3] = -topLeftVote;
+
+    if (bottomRightVote > 0)
+        weights[1] = bottomRightVote;
+    else if (bottomRightVote < 0)
+        weights[2] = -bottomRightVote;
+
+    return weights;
+}
+
 /*
     Interface for getting and clearing marked edges
 */
@@ -77,18 +151,31 @@ class IMarkedEdgeHelper
 public:
 
     /*
-        Gets the edges that were marked as dissimilar
+        Gets the edges that were marked by the heuristic
 
-        @returns A const reference to the marked edges
+        @returns The marked edges, keyed by their (source, target) vertices
     */
-    virtual const HeuristicHelper::EdgeMap& getMarkedEdges() const noexcept = 0;
+    virtual EdgeMarks::EdgeMap getMarkedEdges() const = 0;
 
     /*
-        Clears the edges set by the heuristic with the given uuid
+        Gets the mark buffer the heuristic writes to
 
-        @param uuid The uuid of the heuristic
+        @returns A constant reference to the heuristic's marks
+    */
+    virtual const EdgeMarks& getEdgeMarks() const noexcept = 0;
+
+    /*
+        Clears the edges marked by the heuristic
     */
     virtual void clearMarkedEdges() const noexcept = 0;
 
+    /*
+        Clears the edges marked by the heuristic, and prepares it
+        for a search that's expected to make the given number of marks
+
+        @param numMarks The number of marks the search is expected to make
+    */
+    virtual void resetMarkedEdges(std::size_t numMarks) const = 0;
+
 };
 }
@@ -6,6 +6,8 @@
 #include <optional>
 #include <stdexcept>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include <stb_image.h>
 
@@ -13,6 +15,160 @@ namespace dpa::image::internal
 {
 using Point2D = std::tuple<int, int>;
 
+/*
+    Converts the channels of a single interleaved pixel into a pixel tuple
+
+    @param pixelData A pointer to the first channel of the pixel
+    @returns The pixel stored at the given address
+*/
+template<template<typename> class Channels, typename BitDepth, std::size_t... Index>
+Channels<BitDepth> LoadPixel(const BitDepth* pixelData, std::index_sequence<Index...>) noexcept
+{
+    return { pixelData[Index]... };
+}
+
+/*
+    Writes a pixel tuple into interleaved channel data
+
+    @param pixelData A pointer to the first channel of the destination pixel
+    @param pixel The pixel to write
+*/
+template<template<typename> class Channels, typename BitDepth, std::size_t... Index>
+void StorePixel(BitDepth* pixelData, const Channels<BitDepth>& pixel, std::index_sequence<Index...>) noexcept
+{
+    ((pixelData[Index] = std::get<Index>(pixel)), ...);
+}
+
+/*
+    A contiguous row of interleaved pixels. The row is bounds checked once when
+    it's created, so reading and writing pixels through it doesn't check or
+    allocate anything
+
+    @tparam Element The channel type, which is const qualified for read only rows
+*/
+template<template<typename> class Channels, typename Element>
+class PixelRow final
+{
+public:
+
+    using BitDepth = std::remove_const_t<Element>;
+    using Pixel = Channels<BitDepth>;
+    using Indices = std::make_index_sequence<channel_count_v<Channels>>;
+
+    PixelRow() = default;
+    PixelRow(Element* rowData, int width) noexcept
+        : m_pData(rowData), m_width(width)
+    {}
+
+    /*
+        Gets the pixel at the given column. No bounds checking is done
+
+        @param x The column to read
+        @returns The pixel in that column
+    */
+    Pixel operator[](int x) const noexcept
+    {
+        return LoadPixel<Channels, BitDepth>(m_pData + x * channel_count_v<Channels>, Indices{});
+    }
+
+    /*
+        Sets the pixel at the given column. No bounds checking is done
+
+        @param x The column to write
+        @param pixel The pixel to write
+    */
+    void set(int x, const Pixel& pixel) const noexcept
+    {
+        static_assert(!std::is_const_v<Element>, "Can't write to a read only row");
+        StorePixel<Channels, BitDepth>(m_pData + x * channel_count_v<Channels>, pixel, Indices{});
+    }
+
+    /*
+        Gets the raw channel data of the row, which holds size() * channel_count_v<Channels>
+        interleaved channels
+    */
+    Element* data() const noexcept { return m_pData; }
+
+    /*
+        Gets the number of pixels in the row
+    */
+    int size() const noexcept { return m_width; }
+
+private:
+
+    Element* m_pData{ nullptr };
+    int m_width{ 0 };
+};
+
+/*
+    A strided 2D view over interleaved pixel data. Rows don't have to be
+    tightly packed, which allows viewing a sub-rectangle of a larger image
+*/
+template<template<typename> class Channels, typename Element>
+class PixelView2D final
+{
+public:
+
+    PixelView2D() = default;
+
+    /*
+        Constructs a new strided view
+
+        @param pixelData A pointer to the first channel of the top left pixel
+        @param dimensions The width and height of the view, in pixels
+        @param stride The distance between the start of consecutive rows, in channels
+    */
+    PixelView2D(Element* pixelData, const Point2D& dimensions, int stride) noexcept
+        : m_pData(pixelData), m_stride(stride)
+    {
+        std::tie(m_width, m_height) = dimensions;
+    }
+
+    /*
+        Gets a row of the view. No bounds checking is done
+
+        @param y The row to get
+        @returns A span over the pixels in that row
+    */
+    PixelRow<Channels, Element> row(int y) const noexcept
+    {
+        return { m_pData + static_cast<std::ptrdiff_t>(y) * m_stride, m_width };
+    }
+
+    /*
+        Gets a view of a rectangular region of this view
+
+        @param origin The top left pixel of the region
+        @param dimensions The width and height of the region
+        @returns A valid optional containing the region's view if it was within
+                 the bounds of this view, an empty optional otherwise
+    */
+    std::optional<PixelView2D> subview(const Point2D& origin, const Point2D& dimensions) const noexcept
+    {
+        const auto [x, y] = origin;
+        const auto [width, height] = dimensions;
+
+        if (x < 0 || y < 0 || width < 0 || height < 0 || x + width > m_width || y + height > m_height)
+            return {};
+
+        return PixelView2D{ row(y).data() + x * channel_count_v<Channels>, dimensions, m_stride };
+    }
+
+    Element* data() const noexcept { return m_pData; }
+
+    int getWidth() const noexcept { return m_width; }
+    int getHeight() const noexcept { return m_height; }
+    int getStride() const noexcept { return m_stride; }
+
+private:
+
+    Element* m_pData{ nullptr };
+
+    int m_width{ 0 };
+    int m_height{ 0 };
+    int m_stride{ 0 };
+};
+
 /*
     Represents a view for an image loaded by stb. Provides
     an interface for pixel I/O
@@ -28,6 +184,9 @@ public:
     std::optional<Channels<BitDepth>> getPixelAt(const Point2D& position) const noexcept;
     bool setPixelAt(const Point2D& position, const Channels<BitDepth>& pixel) noexcept;
 
+    std::optional<PixelRow<Channels, BitDepth>> row(int y) const noexcept;
+    PixelView2D<Channels, BitDepth> pixels() const noexcept;
+
     BitDepth* getData() const noexcept;
 
     int getChannels() const noexcept;
@@ -122,6 +281,31 @@ bool ImageView<Channels, BitDepth>::setPixelAt(const Point2D& position,
     return true;
 }
 
+/*
+    Gets a contiguous row of pixels
+
+    @param y The row to get
+    @returns A valid optional containing the row, if it was within the
+             bounds of the image. An empty optional otherwise
+*/
+template<template<typename> class Channels, typename BitDepth>
+std::optional<PixelRow<Channels, BitDepth>> ImageView<Channels, BitDepth>::row(int y) const noexcept
+{
+    if (y < 0 || y >= m_height)
+        return {};
+
+    return PixelRow<Channels, BitDepth>{ seekTo({ 0, y }), m_width };
+}
+
+/*
+    Gets a 2D view over every pixel in the image
+*/
+template<template<typename> class Channels, typename BitDepth>
+PixelView2D<Channels, BitDepth> ImageView<Channels, BitDepth>::pixels() const noexcept
+{
+    return { m_pData, { m_width, m_height }, m_width * m_channels };
+}
+
 /*
     Gets the pixel data that was stored within the view
 */
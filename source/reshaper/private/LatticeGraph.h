@@ -0,0 +1,668 @@
+#pragma once
+
+#include <RunArena.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/*
+    Disable warnings thrown in boost
+    4100 - Unreferenced formal parameter
+*/
+#pragma warning( push )
+#pragma warning( disable: 4996 4127 4100 )
+
+#include <boost/graph/adjacency_iterator.hpp>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/properties.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/property_map/property_map.hpp>
+
+#pragma warning( pop )
+
+namespace dpa::graph::internal
+{
+/*
+    The eight directions a pixel can be connected in. The order of the
+    enumerators is the order out edges are visited in, and pairs of
+    opposite directions only differ in their lowest bit
+
+    NW  N  NE
+      \ | /
+    W - o - E
+      / | \
+    SW  S  SE
+*/
+enum class LatticeDirection : std::uint8_t
+{
+    eWest, eEast, eNorth, eSouth, eNorthEast, eSouthWest, eNorthWest, eSouthEast
+};
+
+/*
+    Gets the direction that points back at the given direction
+
+    @param direction The direction to flip
+    @returns The opposite direction
+*/
+constexpr LatticeDirection Opposite(LatticeDirection direction) noexcept
+{
+    return static_cast<LatticeDirection>(static_cast<std::uint8_t>(direction) ^ 1);
+}
+
+/*
+    Gets the (x, y) step taken when moving one pixel in the given direction
+
+    @param direction The direction to step in
+    @returns The x and y offsets of the step
+*/
+constexpr std::tuple<int, int> DirectionOffset(LatticeDirection direction) noexcept
+{
+    constexpr int dx[] = { -1, 1, 0, 0, 1, -1, -1, 1 };
+    constexpr int dy[] = { 0, 0, -1, 1, -1, 1, -1, 1 };
+
+    const auto index = static_cast<std::uint8_t>(direction);
+    return { dx[index], dy[index] };
+}
+
+/*
+    An edge in the lattice graph. Each undirected edge is stored once by the
+    endpoint it leaves in an east, south, south west or south east direction,
+    so both orientations of an edge map to the same edge index
+*/
+struct LatticeEdge
+{
+    std::size_t source{ 0 };
+    std::size_t target{ 0 };
+    LatticeDirection direction{ LatticeDirection::eEast };
+
+    /*
+        Gets the flat index of this edge, which is (owning pixel, edge slot)
+
+        @returns An index in the range [0, 4 * num_vertices)
+    */
+    constexpr std::size_t index() const noexcept
+    {
+        const auto bits = static_cast<std::uint8_t>(direction);
+        return ((bits & 1) ? source : target) * 4 + (bits >> 1);
+    }
+
+    friend constexpr bool operator==(const LatticeEdge& lhs, const LatticeEdge& rhs) noexcept
+    {
+        return lhs.index() == rhs.index();
+    }
+
+    friend constexpr bool operator!=(const LatticeEdge& lhs, const LatticeEdge& rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+    friend constexpr bool operator<(const LatticeEdge& lhs, const LatticeEdge& rhs) noexcept
+    {
+        return lhs.index() < rhs.index();
+    }
+};
+
+/*
+    A graph specialised for 8-connected pixel lattices. The adjacency of each
+    pixel is implied by its position, so a pixel only stores an 8-bit mask of
+    which of its neighbours it's connected to, and another of which of those
+    edges are flagged. Edge properties live in a flat array indexed by LatticeEdge::index. This models the Boost Graph Library's
+    incidence, bidirectional, adjacency, vertex list and edge list concepts,
+    so it can be searched and wrapped in a filtered_graph like any other graph
+
+    @tparam VertexProperty The bundled property stored for each pixel
+    @tparam EdgeProperty The bundled property stored for each edge
+*/
+template<typename VertexProperty, typename EdgeProperty>
+class LatticeGraph
+{
+public:
+
+    using vertex_descriptor = std::size_t;
+    using edge_descriptor = LatticeEdge;
+
+    using directed_category = boost::undirected_tag;
+    using edge_parallel_category = boost::disallow_parallel_edge_tag;
+
+    struct traversal_category
+        : boost::bidirectional_graph_tag,
+          boost::adjacency_graph_tag,
+          boost::vertex_list_graph_tag,
+          boost::edge_list_graph_tag
+    {};
+
+    using vertices_size_type = std::size_t;
+    using edges_size_type = std::size_t;
+    using degree_size_type = std::size_t;
+
+    using vertex_bundled = VertexProperty;
+    using edge_bundled = EdgeProperty;
+    using graph_bundled = boost::no_property;
+
+    using vertex_property_type = VertexProperty;
+    using edge_property_type = EdgeProperty;
+    using graph_property_type = boost::no_property;
+
+    /*
+        Iterates over the edges incident to a single vertex. Out edges
+        have the vertex as their source, and in edges have it as their target
+    */
+    template<bool Incoming>
+    class IncidentEdgeIterator : public boost::iterator_facade<IncidentEdgeIterator<Incoming>,
+        LatticeEdge, boost::forward_traversal_tag, LatticeEdge>
+    {
+    public:
+
+        IncidentEdgeIterator() = default;
+
+        IncidentEdgeIterator(vertex_descriptor vertex, std::uint8_t mask, std::size_t width) noexcept
+            : m_vertex(vertex), m_mask(mask), m_width(width)
+        {}
+
+    private:
+
+        friend class boost::iterator_core_access;
+
+        LatticeEdge dereference() const noexcept
+        {
+            auto direction = LowestDirection(m_mask);
+            auto neighbour = Neighbour(m_vertex, direction, m_width);
+
+            if constexpr (Incoming)
+                return { neighbour, m_vertex, Opposite(direction) };
+            else
+                return { m_vertex, neighbour, direction };
+        }
+
+        void increment() noexcept
+        {
+            m_mask &= static_cast<std::uint8_t>(m_mask - 1);
+        }
+
+        bool equal(const IncidentEdgeIterator& other) const noexcept
+        {
+            return m_vertex == other.m_vertex && m_mask == other.m_mask;
+        }
+
+        vertex_descriptor m_vertex{ 0 };
+        std::uint8_t m_mask{ 0 };
+        std::size_t m_width{ 0 };
+    };
+
+    using out_edge_iterator = IncidentEdgeIterator<false>;
+    using in_edge_iterator = IncidentEdgeIterator<true>;
+
+    using adjacency_iterator = typename boost::adjacency_iterator_generator<
+        LatticeGraph, vertex_descriptor, out_edge_iterator>::type;
+
+    using vertex_iterator = boost::counting_iterator<vertex_descriptor>;
+
+    /*
+        Iterates over every edge in the graph once, in order of edge index
+    */
+    class EdgeIterator : public boost::iterator_facade<EdgeIterator,
+        LatticeEdge, boost::forward_traversal_tag, LatticeEdge>
+    {
+    public:
+
+        EdgeIterator() = default;
+
+        EdgeIterator(const LatticeGraph* graph, std::size_t edgeIndex) noexcept
+            : m_graph(graph), m_index(edgeIndex)
+        {
+            skipMissing();
+        }
+
+    private:
+
+        friend class boost::iterator_core_access;
+
+        LatticeEdge dereference() const noexcept
+        {
+            const auto vertex = m_index / 4;
+            const auto direction = OwnedDirection(m_index % 4);
+
+            return { vertex, Neighbour(vertex, direction, m_graph->m_width), direction };
+        }
+
+        void increment() noexcept
+        {
+            ++m_index;
+            skipMissing();
+        }
+
+        bool equal(const EdgeIterator& other) const noexcept
+        {
+            return m_index == other.m_index;
+        }
+
+        void skipMissing() noexcept
+        {
+            const auto end = m_graph->m_masks.size() * 4;
+            while (m_index < end && !m_graph->hasEdge(m_index / 4, OwnedDirection(m_index % 4)))
+                ++m_index;
+        }
+
+        const LatticeGraph* m_graph{ nullptr };
+        std::size_t m_index{ 0 };
+    };
+
+    using edge_iterator = EdgeIterator;
+
+public:
+
+    /*
+        Constructs an empty graph
+    */
+    LatticeGraph() = default;
+
+    /*
+        Constructs a graph with a vertex for every pixel in the image. No
+        vertices are connected until edges are added
+
+        @param width The width of the image
+        @param height The height of the image
+        @param resource The memory resource to allocate the edge flags and the vertex and edge properties from
+    */
+    LatticeGraph(std::size_t width, std::size_t height,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : m_width(width), m_height(height),
+          m_masks(width * height, 0),
+          m_flags(width * height, 0, memory::ArenaAllocator<std::uint8_t>{ resource }),
+          m_vertexProperties(width * height, memory::ArenaAllocator<VertexProperty>{ resource }),
+          m_edgeProperties(width * height * 4, memory::ArenaAllocator<EdgeProperty>{ resource })
+    {}
+
+    /*
+        Gets the bundled property of a vertex
+
+        @param vertex The vertex to get the property of
+        @returns A reference to the vertex's property
+    */
+    VertexProperty& operator[](vertex_descriptor vertex) noexcept { return m_vertexProperties[vertex]; }
+    const VertexProperty& operator[](vertex_descriptor vertex) const noexcept { return m_vertexProperties[vertex]; }
+
+    /*
+        Gets the bundled property of an edge
+
+        @param edge The edge to get the property of
+        @returns A reference to the edge's property
+    */
+    EdgeProperty& operator[](const edge_descriptor& edge) noexcept { return m_edgeProperties[edge.index()]; }
+    const EdgeProperty& operator[](const edge_descriptor& edge) const noexcept { return m_edgeProperties[edge.index()]; }
+
+    /*
+        Gets the mask of directions the given vertex is connected in. Bit n is set
+        when the vertex has an edge in the direction with an underlying value of n
+
+        @param vertex The vertex to get the mask of
+        @returns The vertex's neighbour mask
+    */
+    std::uint8_t getNeighbourMask(vertex_descriptor vertex) const noexcept { return m_masks[vertex]; }
+
+    /*
+        Gets the neighbour mask of every vertex, in row-major order
+
+        @returns A constant reference to the neighbour masks
+    */
+    const std::vector<std::uint8_t>& getNeighbourMasks() const noexcept { return m_masks; }
+
+    /*
+        Determines if the vertex is connected in the given direction
+
+        @param vertex The vertex to check
+        @param direction The direction to check
+        @returns True if there's an edge in that direction, false otherwise
+    */
+    bool hasEdge(vertex_descriptor vertex, LatticeDirection direction) const noexcept
+    {
+        return (m_masks[vertex] >> static_cast<std::uint8_t>(direction)) & 1;
+    }
+
+    /*
+        Determines if the edge in the given direction is flagged. Like the edge
+        properties, a flag is kept whether or not the vertices are connected
+
+        @param vertex The vertex to check
+        @param direction The direction to check
+        @returns True if the edge in that direction is flagged, false otherwise
+    */
+    bool hasEdgeFlag(vertex_descriptor vertex, LatticeDirection direction) const noexcept
+    {
+        return (m_flags[vertex] >> static_cast<std::uint8_t>(direction)) & 1;
+    }
+
+    /*
+        Determines if the edge is flagged
+
+        @param edge The edge to check
+        @returns True if the edge is flagged, false otherwise
+    */
+    bool hasEdgeFlag(const edge_descriptor& edge) const noexcept { return hasEdgeFlag(edge.source, edge.direction); }
+
+    /*
+        Flags or unflags the edge in the given direction, updating both endpoints. This
+        is one bit per edge, where a field in the edge properties would be a byte or more
+
+        @param vertex The vertex to update
+        @param direction The direction of the edge
+        @param flagged True to flag the edge, false to clear its flag
+    */
+    void setEdgeFlag(vertex_descriptor vertex, LatticeDirection direction, bool flagged) noexcept
+    {
+        const auto neighbour = Neighbour(vertex, direction, m_width);
+        const auto bit = static_cast<std::uint8_t>(1 << static_cast<std::uint8_t>(direction));
+        const auto oppositeBit = static_cast<std::uint8_t>(1 << static_cast<std::uint8_t>(Opposite(direction)));
+
+        if (flagged)
+        {
+            m_flags[vertex] |= bit;
+            m_flags[neighbour] |= oppositeBit;
+        }
+        else
+        {
+            m_flags[vertex] &= static_cast<std::uint8_t>(~bit);
+            m_flags[neighbour] &= static_cast<std::uint8_t>(~oppositeBit);
+        }
+    }
+
+    std::size_t getWidth() const noexcept { return m_width; }
+    std::size_t getHeight() const noexcept { return m_height; }
+
+    static vertex_descriptor null_vertex() noexcept { return static_cast<vertex_descriptor>(-1); }
+
+    /*
+        Gets the vertex one step away in the given direction. No bounds checking is done
+
+        @param vertex The vertex to step from
+        @param direction The direction to step in
+        @param width The width of the lattice
+        @returns The neighbouring vertex
+    */
+    static vertex_descriptor Neighbour(vertex_descriptor vertex, LatticeDirection direction, std::size_t width) noexcept
+    {
+        const auto [dx, dy] = DirectionOffset(direction);
+        const auto offset = dy * static_cast<std::ptrdiff_t>(width) + dx;
+        return static_cast<vertex_descriptor>(static_cast<std::ptrdiff_t>(vertex) + offset);
+    }
+
+    /*
+        Finds the direction that leads from source to target
+
+        @param source The vertex to step from
+        @param target The vertex to step to
+        @returns The direction, and true if the vertices are neighbours in
+                 the lattice. The direction is meaningless when false
+    */
+    std::pair<LatticeDirection, bool> directionBetween(vertex_descriptor source, vertex_descriptor target) const noexcept
+    {
+        if (!m_width || source >= m_masks.size() || target >= m_masks.size())
+            return { LatticeDirection::eWest, false };
+
+        const auto dx = static_cast<long long>(target % m_width) - static_cast<long long>(source % m_width);
+        const auto dy = static_cast<long long>(target / m_width) - static_cast<long long>(source / m_width);
+
+        for (std::uint8_t bits = 0; bits < 8; ++bits)
+        {
+            const auto direction = static_cast<LatticeDirection>(bits);
+            const auto [stepX, stepY] = DirectionOffset(direction);
+
+            if (stepX == dx && stepY == dy)
+                return { direction, true };
+        }
+
+        return { LatticeDirection::eWest, false };
+    }
+
+    /*
+        Connects or disconnects the vertex in the given direction, updating both endpoints
+
+        @param vertex The vertex to update
+        @param direction The direction of the edge
+        @param connected True to add the edge, false to remove it
+    */
+    void setEdge(vertex_descriptor vertex, LatticeDirection direction, bool connected) noexcept
+    {
+        if (hasEdge(vertex, direction) == connected)
+            return;
+
+        const auto neighbour = Neighbour(vertex, direction, m_width);
+        const auto bit = static_cast<std::uint8_t>(1 << static_cast<std::uint8_t>(direction));
+        const auto oppositeBit = static_cast<std::uint8_t>(1 << static_cast<std::uint8_t>(Opposite(direction)));
+
+        if (connected)
+        {
+            m_masks[vertex] |= bit;
+            m_masks[neighbour] |= oppositeBit;
+            ++m_numEdges;
+        }
+        else
+        {
+            m_masks[vertex] &= static_cast<std::uint8_t>(~bit);
+            m_masks[neighbour] &= static_cast<std::uint8_t>(~oppositeBit);
+            --m_numEdges;
+        }
+    }
+
+    std::size_t numVertices() const noexcept { return m_masks.size(); }
+    std::size_t numEdges() const noexcept { return m_numEdges; }
+
+private:
+
+    /*
+        Gets the lowest set direction in the mask
+
+        @param mask A non-zero neighbour mask
+        @returns The direction of the lowest set bit
+    */
+    static LatticeDirection LowestDirection(std::uint8_t mask) noexcept
+    {
+        std::uint8_t bits = 0;
+        while (!((mask >> bits) & 1))
+            ++bits;
+
+        return static_cast<LatticeDirection>(bits);
+    }
+
+    /*
+        Maps an edge slot onto the direction its owning vertex stores it in
+
+        @param slot The slot of the edge, in the range [0, 4)
+        @returns East, south, south west or south east
+    */
+    static LatticeDirection OwnedDirection(std::size_t slot) noexcept
+    {
+        return static_cast<LatticeDirection>(slot * 2 + 1);
+    }
+
+private:
+
+    std::size_t m_width{ 0 };
+    std::size_t m_height{ 0 };
+    std::size_t m_numEdges{ 0 };
+
+    // The neighbour masks are handed out through the public interface, so they're
+    // allocated normally, while the flags and properties can live in a run arena
+    std::vector<std::uint8_t> m_masks{};
+    memory::ArenaVector<std::uint8_t> m_flags{};
+    memory::ArenaVector<VertexProperty> m_vertexProperties{};
+    memory::ArenaVector<EdgeProperty> m_edgeProperties{};
+
+};
+
+/*
+    Boost Graph Library free functions for the lattice graph. These are found
+    through argument dependent lookup inside of boost's algorithms, and are
+    pulled into the boost namespace below so qualified calls work too
+*/
+
+template<typename V, typename E>
+std::size_t source(const LatticeEdge& edge, const LatticeGraph<V, E>&) noexcept
+{
+    return edge.source;
+}
+
+template<typename V, typename E>
+std::size_t target(const LatticeEdge& edge, const LatticeGraph<V, E>&) noexcept
+{
+    return edge.target;
+}
+
+template<typename V, typename E>
+auto vertices(const LatticeGraph<V, E>& graph) noexcept
+{
+    using Iterator = typename LatticeGraph<V, E>::vertex_iterator;
+    return std::make_pair(Iterator{ 0 }, Iterator{ graph.numVertices() });
+}
+
+template<typename V, typename E>
+std::size_t num_vertices(const LatticeGraph<V, E>& graph) noexcept
+{
+    return graph.numVertices();
+}
+
+template<typename V, typename E>
+auto edges(const LatticeGraph<V, E>& graph) noexcept
+{
+    using Iterator = typename LatticeGraph<V, E>::edge_iterator;
+    return std::make_pair(Iterator{ &graph, 0 }, Iterator{ &graph, graph.numVertices() * 4 });
+}
+
+template<typename V, typename E>
+std::size_t num_edges(const LatticeGraph<V, E>& graph) noexcept
+{
+    return graph.numEdges();
+}
+
+template<typename V, typename E>
+auto out_edges(std::size_t vertex, const LatticeGraph<V, E>& graph) noexcept
+{
+    using Iterator = typename LatticeGraph<V, E>::out_edge_iterator;
+    return std::make_pair(Iterator{ vertex, graph.getNeighbourMask(vertex), graph.getWidth() },
+                          Iterator{ vertex, 0, graph.getWidth() });
+}
+
+template<typename V, typename E>
+auto in_edges(std::size_t vertex, const LatticeGraph<V, E>& graph) noexcept
+{
+    using Iterator = typename LatticeGraph<V, E>::in_edge_iterator;
+    return std::make_pair(Iterator{ vertex, graph.getNeighbourMask(vertex), graph.getWidth() },
+                          Iterator{ vertex, 0, graph.getWidth() });
+}
+
+template<typename V, typename E>
+auto adjacent_vertices(std::size_t vertex, const LatticeGraph<V, E>& graph) noexcept
+{
+    using Iterator = typename LatticeGraph<V, E>::adjacency_iterator;
+    const auto [first, last] = out_edges(vertex, graph);
+
+    return std::make_pair(Iterator{ first, &graph }, Iterator{ last, &graph });
+}
+
+template<typename V, typename E>
+std::size_t out_degree(std::size_t vertex, const LatticeGraph<V, E>& graph) noexcept
+{
+    std::size_t degree = 0;
+    for (auto mask = graph.getNeighbourMask(vertex); mask; mask &= static_cast<std::uint8_t>(mask - 1))
+        ++degree;
+
+    return degree;
+}
+
+template<typename V, typename E>
+std::size_t in_degree(std::size_t vertex, const LatticeGraph<V, E>& graph) noexcept
+{
+    return out_degree(vertex, graph);
+}
+
+template<typename V, typename E>
+std::size_t degree(std::size_t vertex, const LatticeGraph<V, E>& graph) noexcept
+{
+    return out_degree(vertex, graph);
+}
+
+template<typename V, typename E>
+std::pair<LatticeEdge, bool> edge(std::size_t source, std::size_t target, const LatticeGraph<V, E>& graph) noexcept
+{
+    const auto [direction, adjacent] = graph.directionBetween(source, target);
+
+    if (!adjacent || !graph.hasEdge(source, direction))
+        return { LatticeEdge{}, false };
+
+    return { LatticeEdge{ source, target, direction }, true };
+}
+
+template<typename V, typename E>
+std::pair<LatticeEdge, bool> add_edge(std::size_t source, std::size_t target, LatticeGraph<V, E>& graph) noexcept
+{
+    const auto [direction, adjacent] = graph.directionBetween(source, target);
+
+    if (!adjacent || graph.hasEdge(source, direction))
+        return { LatticeEdge{ source, target, direction }, false };
+
+    graph.setEdge(source, direction, true);
+    return { LatticeEdge{ source, target, direction }, true };
+}
+
+template<typename V, typename E>
+void remove_edge(std::size_t source, std::size_t target, LatticeGraph<V, E>& graph) noexcept
+{
+    if (const auto [direction, adjacent] = graph.directionBetween(source, target); adjacent)
+        graph.setEdge(source, direction, false);
+}
+
+template<typename V, typename E>
+void remove_edge(const LatticeEdge& edge, LatticeGraph<V, E>& graph) noexcept
+{
+    graph.setEdge(edge.source, edge.direction, false);
+}
+
+template<typename V, typename E>
+boost::typed_identity_property_map<std::size_t> get(boost::vertex_index_t, const LatticeGraph<V, E>&) noexcept
+{
+    return {};
+}
+
+template<typename V, typename E>
+std::size_t get(boost::vertex_index_t, const LatticeGraph<V, E>&, std::size_t vertex) noexcept
+{
+    return vertex;
+}
+}
+
+namespace boost
+{
+using dpa::graph::internal::adjacent_vertices;
+using dpa::graph::internal::add_edge;
+using dpa::graph::internal::degree;
+using dpa::graph::internal::edge;
+using dpa::graph::internal::edges;
+using dpa::graph::internal::get;
+using dpa::graph::internal::in_degree;
+using dpa::graph::internal::in_edges;
+using dpa::graph::internal::num_edges;
+using dpa::graph::internal::num_vertices;
+using dpa::graph::internal::out_degree;
+using dpa::graph::internal::out_edges;
+using dpa::graph::internal::remove_edge;
+using dpa::graph::internal::source;
+using dpa::graph::internal::target;
+using dpa::graph::internal::vertices;
+
+template<typename V, typename E>
+struct property_map<dpa::graph::internal::LatticeGraph<V, E>, vertex_index_t>
+{
+    using type = typed_identity_property_map<std::size_t>;
+    using const_type = type;
+};
+
+template<typename V, typename E>
+struct property_map<const dpa::graph::internal::LatticeGraph<V, E>, vertex_index_t>
+    : property_map<dpa::graph::internal::LatticeGraph<V, E>, vertex_index_t>
+{};
+}
@@ -1,32 +1,31 @@
 #include <SimilarityGraphImpl.h>
 
+#include <DissimilarityKernels.h>
 #include <ImageUtil.h>
 #include <GraphUtils.h>
 #include <SimilarityGraphVisualizationStrategy.h>
+#include <Trace.h>
 
 #include <boost/graph/graph_utility.hpp>
 
+#include <algorithm>
+#include <execution>
 #include <numeric>
 #include <tuple>
 
 namespace
 {
 /*
-    Composes the given functions into a single
-    function that returns the sum of their return values
+    Converts a dissimilar pixels threshold into the smallest whole difference
+    that reaches it, since the heuristic only ever compares whole differences
 
-    @param funcA A function that returns a valid operand of operator +
-    @param funcA A function that returns a valid operand of operator +
-    @returns A new function that sums the given functions and returns
-             a valid operand of operator +
+    @param threshold The threshold to convert
+    @returns The threshold, rounded up
 */
-template<typename FuncA, typename FuncB>
-auto recursiveSum(FuncA funcA, FuncB funcB)
+constexpr stbi_uc ToWholeThreshold(float threshold) noexcept
 {
-    return [=](const auto& edge)
-    {
-        return funcA(edge) + funcB(edge);
-    };
+    const auto whole = static_cast<int>(threshold);
+    return static_cast<stbi_uc>(static_cast<float>(whole) < threshold ? whole + 1 : whole);
 }
 }
 
@@ -38,16 +37,33 @@ bool SimilarityGraphImpl::build(const di::Image<di::RGB, stbi_uc>& image)
     if (!image.getHeight() || !image.getWidth())
         return false;
 
-    if (auto convertedImage = di::utility::RGB_To_YCbCr(image); convertedImage)
+    auto convertedImage = [&]()
     {
-        // Create the adjacency matrix with the correct number of vertices
-        m_graph = Graph(convertedImage.value().getWidth() * convertedImage.value().getHeight());
+        trace::TraceSpan span{ "RGB_To_YCbCr", "graph" };
+        return di::utility::RGB_To_YCbCr(image);
+    }();
+
+    if (!convertedImage)
+        return false;
+
+    // Create the lattice with a vertex for every pixel
+    m_graph = Graph(convertedImage.value().getWidth(), convertedImage.value().getHeight(), m_resource);
+    m_statistics = {};
+    invalidateNeighbourMasks(heuristics::FilteredEdges::eAll);
+
+    // Set the pixel colors on each node
+    if (!setNodeProperties(convertedImage.value()))
+        return false;
 
-        // Set the pixel colors on each node
-        if (!setNodeProperties(convertedImage.value()))
-            return false;
+    // Pixel art rarely uses more than a palette's worth of colours, so comparing
+    // pixels can usually be reduced to looking up a pair of palette indices
+    {
+        trace::TraceSpan span{ "buildPalette", "graph" };
+        buildPalette(convertedImage.value());
     }
 
+    trace::TraceSpan span{ "connect", "graph" };
+
     const di::internal::Point2D imageDims = { image.getWidth(), image.getHeight() };
 
     // Connect each of the nodes to make an 8-connected lattice graph
@@ -59,6 +75,12 @@ bool SimilarityGraphImpl::build(const di::Image<di::RGB, stbi_uc>& image)
     // Set the image dimensions so we can visualize the graph properly
     m_imageDims = { image.getWidth(), image.getHeight() };
 
+    m_statistics.numVertices = m_graph.numVertices();
+    m_statistics.numEdges = m_graph.numEdges();
+
+    // Every diagonal is similar until the dissimilar pixels heuristic says otherwise
+    indexCrossings();
+
     return true;
 }
 
@@ -67,207 +89,478 @@ void SimilarityGraphImpl::printGraph(std::ostream& stream) const noexcept
     boost::print_graph(m_graph, boost::get(boost::vertex_index, m_graph), stream);
 }
 
-void SimilarityGraphImpl::connectHorizontally(const utility::Point2D<Vertex>& dims)
+void SimilarityGraphImpl::resolveCrossings()
 {
-    const auto [imageWidth, imageHeight] = dims;
-    for (auto h = 0; h < imageHeight; ++h)
+    // Cut the dissimilar edges, which leaves the graph the crossing heuristics search
     {
-        for (auto w = 1; w < imageWidth; ++w)
+        trace::TraceSpan span{ "flagDissimilarEdges", "graph" };
+        flagDissimilarEdges(true);
+    }
+
+    trace::TraceSpan span{ "voteOnCrossings", "graph" };
+
+    m_statistics.numCrossings = m_crossings.size();
+
+    heuristics::Curves curves{ m_imageDims };
+    heuristics::Islands islands{ m_imageDims };
+    heuristics::SparsePixels sparsePixels{ m_imageDims };
+
+    // Every vote has to be cast before any diagonal is cut, since cutting one changes
+    // what the neighbouring votes see. A tie cuts both diagonals, so each block cuts at most two
+    memory::ArenaVector<std::pair<Vertex, LatticeDirection>> cuts{ m_resource };
+    cuts.reserve(2 * m_crossings.size());
+
+    for (const Vertex topLeft : m_crossings)
+    {
+        const Vertex topRight = topLeft + 1;
+
+        // Each heuristic weighs every orientation of the block's diagonals, in the order top
+        // left to bottom right, bottom right to top left, top right to bottom left, and bottom
+        // left to top right
+        const heuristics::BlockWeights weights[] =
         {
-            auto curr = utility::FlattenPoint<Vertex>({ w, h }, imageWidth);
-            auto prev = utility::FlattenPoint<Vertex>({ w - 1, h }, imageWidth);
+            curves.voteOnBlock(topLeft, m_graph),
+            islands.voteOnBlock(topLeft, m_graph),
+            sparsePixels.voteOnBlock(topLeft, m_graph)
+        };
+
+        double backwardWeight = 0;
+        double forwardWeight = 0;
+        for (const auto& weight : weights)
+        {
+            backwardWeight += weight[0] + weight[1];
+            forwardWeight += weight[2] + weight[3];
+        }
+
+        // The heavier diagonal stays, and a tie cuts both
+        if (backwardWeight <= forwardWeight)
+            cuts.emplace_back(topLeft, LatticeDirection::eSouthEast);
+
+        if (forwardWeight <= backwardWeight)
+            cuts.emplace_back(topRight, LatticeDirection::eSouthWest);
 
-            boost::add_edge(prev, curr, m_graph);
+        if (backwardWeight == forwardWeight)
+        {
+            ++m_statistics.numTies;
+            continue;
+        }
+
+        // Credit the cut to the heuristics that favoured the diagonal that stays
+        const double keptSign = backwardWeight > forwardWeight ? 1 : -1;
+        std::size_t* const credits[] =
+        {
+            &m_statistics.numCutByCurves, &m_statistics.numCutByIslands, &m_statistics.numCutBySparsePixels
+        };
+
+        for (std::size_t heuristic = 0; heuristic < 3; ++heuristic)
+        {
+            const auto& weight = weights[heuristic];
+            if (keptSign * (weight[0] + weight[1] - weight[2] - weight[3]) > 0)
+                ++*credits[heuristic];
         }
     }
+
+    for (const auto& [vertex, direction] : cuts)
+        m_graph.setEdge(vertex, direction, false);
+
+    m_statistics.numCutDiagonals = cuts.size();
+
+    m_crossings.clear();
+    invalidateNeighbourMasks(heuristics::FilteredEdges::eAll);
 }
 
-void SimilarityGraphImpl::connectVertically(const utility::Point2D<Vertex>& dims)
+const std::vector<std::uint8_t>& SimilarityGraphImpl::getNeighbourMasks(heuristics::FilteredEdges filteredEdges) const
 {
-    const auto [imageWidth, imageHeight] = dims;
-    for (auto w = 0; w < imageWidth; ++w)
+    // Nothing is filtered, so the lattice's own masks are already the answer
+    if (filteredEdges == heuristics::FilteredEdges::eNone)
+        return m_graph.getNeighbourMasks();
+
+    const auto index = static_cast<std::size_t>(filteredEdges);
+    auto& masks = m_filteredMasks[index];
+    if (m_cachedMasks.test(index))
+        return masks;
+
+    const auto imageWidth = m_graph.getWidth();
+
+    // Each edge is owned by the vertex it leaves in one of these directions
+    constexpr LatticeDirection ownedDirections[] =
     {
-        for (auto h = 1; h < imageHeight; ++h)
+        LatticeDirection::eEast, LatticeDirection::eSouth,
+        LatticeDirection::eSouthWest, LatticeDirection::eSouthEast
+    };
+
+    masks.assign(m_graph.numVertices(), 0);
+    visitEdgeFilter(filteredEdges, [&](auto filter)
         {
-            auto curr = utility::FlattenPoint<Vertex>({ w, h }, imageWidth);
-            auto prev = utility::FlattenPoint<Vertex>({ w, h - 1 }, imageWidth);
+            for (Vertex vertex = 0; vertex < m_graph.numVertices(); ++vertex)
+            {
+                for (const auto direction : ownedDirections)
+                {
+                    if (!m_graph.hasEdge(vertex, direction))
+                        continue;
 
-            boost::add_edge(prev, curr, m_graph);
-        }
+                    const Vertex neighbour = Graph::Neighbour(vertex, direction, imageWidth);
+                    if (!filter(Edge{ vertex, neighbour, direction }))
+                        continue;
+
+                    masks[vertex] |= static_cast<std::uint8_t>(1 << static_cast<std::uint8_t>(direction));
+                    masks[neighbour] |= static_cast<std::uint8_t>(1 << static_cast<std::uint8_t>(Opposite(direction)));
+                }
+            }
+        });
+
+    m_cachedMasks.set(index);
+    return masks;
+}
+
+void SimilarityGraphImpl::invalidateNeighbourMasks(heuristics::FilteredEdges changedEdges) noexcept
+{
+    // The weighted filters skip crossings whose other diagonal is dissimilar,
+    // so they all depend on the dissimilar flags too
+    auto dependencies = static_cast<std::size_t>(changedEdges);
+    if (heuristics::hasFilter(changedEdges, heuristics::FilteredEdges::eDissimilar))
+        dependencies = static_cast<std::size_t>(heuristics::FilteredEdges::eAll);
+
+    for (std::size_t index = 0; index < kNumFilterCombinations; ++index)
+    {
+        if (index & dependencies)
+            m_cachedMasks.reset(index);
     }
 }
 
-void SimilarityGraphImpl::connectBackwardDiagonally(const utility::Point2D<Vertex>& dims)
+std::vector<std::uint8_t> SimilarityGraphImpl::findDissimilarEdges() const
 {
-    const auto [imageWidth, imageHeight] = dims;
-    for (auto h = 1; h < imageHeight; ++h)
+    if (m_palette)
+        return findPaletteDissimilarEdges();
+
+    const auto imageWidth = m_graph.getWidth();
+    const auto imageHeight = m_graph.getHeight();
+    const auto numPixels = m_graph.numVertices();
+
+    // The kernels compare each channel separately, so the pixels are split into planes first
+    memory::ArenaVector<stbi_uc> planes(numPixels * 3, m_resource);
+    stbi_uc* Y = planes.data();
+    stbi_uc* Cb = Y + numPixels;
+    stbi_uc* Cr = Cb + numPixels;
+
+    for (Vertex vertex = 0; vertex < numPixels; ++vertex)
     {
-        for (auto w = 1; w < imageWidth; ++w)
-        {
-            auto curr = utility::FlattenPoint<Vertex>({ w, h }, imageWidth);
-            auto prev = utility::FlattenPoint<Vertex>({ w - 1, h - 1 }, imageWidth);
+        const auto& pixel = m_graph[vertex];
 
-            boost::add_edge(prev, curr, m_graph);
-        }
+        Y[vertex] = pixel.Y;
+        Cb[vertex] = pixel.Cb;
+        Cr[vertex] = pixel.Cr;
     }
+
+    const DissimilarityThresholds thresholds
+    {
+        ToWholeThreshold(heuristics::DissimilarPixels::kYThreshold),
+        ToWholeThreshold(heuristics::DissimilarPixels::kCbThreshold),
+        ToWholeThreshold(heuristics::DissimilarPixels::kCrThreshold)
+    };
+
+    const auto& kernels = GetDissimilarityKernels();
+
+    memory::ArenaVector<std::size_t> rows(imageHeight, m_resource);
+    std::iota(std::begin(rows), std::end(rows), 0);
+
+    std::vector<std::uint8_t> masks(numPixels, 0);
+    std::for_each(std::execution::par, std::cbegin(rows), std::cend(rows), [&](std::size_t h)
+        {
+            const auto rowStart = h * imageWidth;
+            const PlanarRow row{ Y + rowStart, Cb + rowStart, Cr + rowStart };
+
+            PlanarRow next{};
+            if (h + 1 < imageHeight)
+                next = { row.Y + imageWidth, row.Cb + imageWidth, row.Cr + imageWidth };
+
+            kernels.findDissimilarEdges(row, next, thresholds, masks.data() + rowStart, static_cast<int>(imageWidth));
+        });
+
+    return masks;
 }
 
-void SimilarityGraphImpl::connectForwardDiagonally(const utility::Point2D<Vertex>& dims)
+void SimilarityGraphImpl::applyDissimilarHeuristic(const heuristics::DissimilarPixels& visitor) const
 {
-    const auto [imageWidth, imageHeight] = dims;
-    for (auto h = 1; h < imageHeight; ++h)
+    const auto imageWidth = m_graph.getWidth();
+    const auto dissimilarMasks = findDissimilarEdges();
+
+    // Each dissimilar edge is in the mask of both of its pixels, and marks at most both of its orientations
+    std::size_t numMarks = 0;
+    for (Vertex vertex = 0; vertex < dissimilarMasks.size(); ++vertex)
+        numMarks += std::bitset<8>(dissimilarMasks[vertex] & m_graph.getNeighbourMask(vertex)).count();
+
+    visitor.resetMarkedEdges(numMarks);
+
+    for (Vertex vertex = 0; vertex < dissimilarMasks.size(); ++vertex)
     {
-        for (auto w = imageWidth - 1; w > 0; --w)
+        auto dissimilar = static_cast<std::uint8_t>(dissimilarMasks[vertex] & m_graph.getNeighbourMask(vertex));
+        for (std::uint8_t bits = 0; dissimilar; ++bits, dissimilar >>= 1)
         {
-            auto curr = utility::FlattenPoint<Vertex>({ w - 1, h }, imageWidth);
-            auto prev = utility::FlattenPoint<Vertex>({ w, h - 1 }, imageWidth);
+            if (!(dissimilar & 1))
+                continue;
+
+            const auto direction = static_cast<LatticeDirection>(bits);
+            const Vertex neighbour = Graph::Neighbour(vertex, direction, imageWidth);
 
-            boost::add_edge(curr, prev, m_graph);
+            // The heuristic compares in the direction of the edge, so it only marks
+            // the orientations that are dissimilar on their own
+            if (isDissimilar(vertex, neighbour))
+                visitor.markDissimilar(Edge{ vertex, neighbour, direction });
+
+            if (isDissimilar(neighbour, vertex))
+                visitor.markDissimilar(Edge{ neighbour, vertex, Opposite(direction) });
         }
     }
 }
 
-bool SimilarityGraphImpl::setNodeProperties(const di::Image<di::YCbCr, stbi_uc>& image)
+std::vector<std::uint8_t> SimilarityGraphImpl::findPaletteDissimilarEdges() const
 {
-    // The graph needs to be initialized with vertices first
-    if (!boost::num_vertices(m_graph))
-        return false;
+    const auto imageWidth = m_graph.getWidth();
+    const auto imageHeight = m_graph.getHeight();
+    const auto& palette = m_palette.value();
 
-    return di::utility::foreach_pixel(image,
-        [&](const di::internal::Point2D& pos, di::YCbCr<stbi_uc> pixel)
-        {
-            const auto idx = utility::FlattenPoint<Vertex>(pos, image.getWidth());
-            std::tie(m_graph[idx].Y, m_graph[idx].Cb, m_graph[idx].Cr) = pixel;
+    constexpr auto kEastBit = static_cast<std::uint8_t>(1 << static_cast<std::uint8_t>(LatticeDirection::eEast));
+    constexpr auto kSouthBit = static_cast<std::uint8_t>(1 << static_cast<std::uint8_t>(LatticeDirection::eSouth));
+    constexpr auto kSouthWestBit = static_cast<std::uint8_t>(1 << static_cast<std::uint8_t>(LatticeDirection::eSouthWest));
+    constexpr auto kSouthEastBit = static_cast<std::uint8_t>(1 << static_cast<std::uint8_t>(LatticeDirection::eSouthEast));
 
-            return true;
-        });
-}
+    memory::ArenaVector<std::size_t> rows(imageHeight, m_resource);
+    std::iota(std::begin(rows), std::end(rows), 0);
 
-SimilarityGraphImpl::OptionalEdgeFilter SimilarityGraphImpl::CreateEdgeWeightFilter(
-    heuristics::FilteredEdges filteredEdges, EdgeFilter dissimilar) const noexcept
-{
-    return [=](const Edge& edge)
-        -> std::optional<bool>
+    std::vector<std::uint8_t> masks(m_graph.numVertices(), 0);
+    std::for_each(std::execution::par, std::cbegin(rows), std::cend(rows), [&](std::size_t h)
         {
-            const auto source = boost::source(edge, m_graph);
-            const auto target = boost::target(edge, m_graph);
+            const auto rowStart = h * imageWidth;
+            const stbi_uc* row = palette.indices.data() + rowStart;
+            const stbi_uc* next = (h + 1 < imageHeight) ? row + imageWidth : nullptr;
 
-            const auto [imageWidth, imageHeight] = m_imageDims;
-
-            // Bail if we're working with a vertical or horizontal edge
-            if (utility::GetSlopeClassification(source, target, imageWidth) !=
-                utility::SlopeClassification::eInvalid)
+            for (std::size_t w = 0; w < imageWidth; ++w)
             {
-                // Ensure we're only evaluating crossing edges
-                const auto [xSource, xTarget] = utility::GetCrossingEdge(source, target, imageWidth);
-                if (auto [crossingEdge, found] = boost::edge(xSource, xTarget, m_graph); found)
+                // Either orientation of an edge being dissimilar makes the edge dissimilar
+                std::uint8_t mask = 0;
+                const bool hasEast = w + 1 < imageWidth;
+
+                if (hasEast && palette.compare(row[w], row[w + 1]))
+                    mask |= kEastBit;
+
+                if (next)
                 {
-                    // We need to only evaluate this against the crossing edge only
-                    // if the crossing edge is connected
-                    if (!dissimilar(crossingEdge))
-                    {
-                        auto crossingEdgeComparator = CreateCrossingEdgeFilter(filteredEdges);
-                        return crossingEdgeComparator(edge, crossingEdge);
-                    }
+                    if (palette.compare(row[w], next[w]))
+                        mask |= kSouthBit;
+
+                    if (w > 0 && palette.compare(row[w], next[w - 1]))
+                        mask |= kSouthWestBit;
+
+                    if (hasEast && palette.compare(row[w], next[w + 1]))
+                        mask |= kSouthEastBit;
                 }
+
+                masks[rowStart + w] = mask;
             }
+        });
 
-            return std::nullopt;
-        };
+    return masks;
 }
 
-SimilarityGraphImpl::EdgeWeightFunc SimilarityGraphImpl::CreateEdgeWeightAccumulator(
-    heuristics::FilteredEdges filteredEdges) const noexcept
+bool SimilarityGraphImpl::isDissimilar(Vertex start, Vertex end) const noexcept
 {
-    EdgeWeightFunc curvesWeight = [&](const auto& edge) { return m_graph[edge].curvesWeight; };
-    EdgeWeightFunc islandsWeight = [&](const auto& edge) { return m_graph[edge].islandsWeight; };
-    EdgeWeightFunc sparsePixelsWeight = [&](const auto& edge) { return m_graph[edge].sparsePixelsWeight; };
+    if (m_palette)
+        return m_palette->compare(m_palette->indices[start], m_palette->indices[end]) & PaletteTable::kForward;
+
+    return heuristics::DissimilarPixels::isDissimilar(start, end, m_graph);
+}
+
+void SimilarityGraphImpl::flagDissimilarEdges(bool removeEdges)
+{
+    const auto dissimilarMasks = findDissimilarEdges();
+
+    m_statistics.numDissimilarEdges = 0;
+
+    // Each edge is owned by the vertex it leaves in one of these directions
+    constexpr LatticeDirection ownedDirections[] =
+    {
+        LatticeDirection::eEast, LatticeDirection::eSouth,
+        LatticeDirection::eSouthWest, LatticeDirection::eSouthEast
+    };
 
-    // default to a zero ret function as to not affect the total weight
-    EdgeWeightFunc edgeWeightSum = [&](const auto&) { return 0; };
+    for (Vertex vertex = 0; vertex < dissimilarMasks.size(); ++vertex)
+    {
+        const auto dissimilar = dissimilarMasks[vertex] & m_graph.getNeighbourMask(vertex);
+        if (!dissimilar)
+            continue;
 
-    // Recursively compose weight functions based on the filter
-    heuristics::VisitEdgeFilters([&](heuristics::FilteredEdges edgeFilter)
+        for (const auto direction : ownedDirections)
         {
-            if ((edgeFilter & filteredEdges) == heuristics::FilteredEdges::eCurves)
-                edgeWeightSum = recursiveSum(edgeWeightSum, curvesWeight);
+            if (!((dissimilar >> static_cast<std::uint8_t>(direction)) & 1))
+                continue;
 
-            if ((edgeFilter & filteredEdges) == heuristics::FilteredEdges::eIslands)
-                edgeWeightSum = recursiveSum(edgeWeightSum, islandsWeight);
+            m_graph.setEdgeFlag(vertex, direction, true);
+            ++m_statistics.numDissimilarEdges;
 
-            if ((edgeFilter & filteredEdges) == heuristics::FilteredEdges::eSparsePixels)
-                edgeWeightSum = recursiveSum(edgeWeightSum, sparsePixelsWeight);
-        });
+            if (removeEdges)
+                m_graph.setEdge(vertex, direction, false);
+        }
+    }
 
-    return edgeWeightSum;
+    invalidateNeighbourMasks(heuristics::FilteredEdges::eDissimilar);
+    indexCrossings();
 }
 
-SimilarityGraphImpl::OptionalCrossingEdgeFilter SimilarityGraphImpl::CreateCrossingEdgeFilter(
-    heuristics::FilteredEdges filteredEdges) const noexcept
+SimilarityGraphStatistics SimilarityGraphImpl::getStatistics() const noexcept
 {
-    return [=](const Edge& edge, const Edge& crossing) 
-        -> std::optional<bool>
-    {
-        auto edgeWeightAccumulator = CreateEdgeWeightAccumulator(filteredEdges);
+    auto statistics = m_statistics;
+    statistics.numResolvedEdges = m_graph.numEdges();
 
-        auto edgeWeight = edgeWeightAccumulator(edge);
-        auto crossingWeight = edgeWeightAccumulator(crossing);
+    return statistics;
+}
 
-        if (edgeWeight == crossingWeight)
-            return std::make_optional(false);
-        else if (edgeWeight || crossingWeight)
-            return std::make_optional(edgeWeight > crossingWeight);
+void SimilarityGraphImpl::indexCrossings()
+{
+    m_crossings.clear();
 
-        return std::nullopt;
+    const auto [imageWidth, imageHeight] = m_imageDims;
+    auto isSimilar = [&](Vertex source, LatticeDirection direction)
+    {
+        return m_graph.hasEdge(source, direction) && !m_graph.hasEdgeFlag(source, direction);
     };
+
+    for (auto h = 1; h < imageHeight; ++h)
+    {
+        for (auto w = 1; w < imageWidth; ++w)
+        {
+            auto topLeft = utility::FlattenPoint<Vertex>({ w - 1, h - 1 }, imageWidth);
+            if (isSimilar(topLeft, LatticeDirection::eSouthEast) &&
+                isSimilar(topLeft + 1, LatticeDirection::eSouthWest))
+            {
+                m_crossings.push_back(topLeft);
+            }
+        }
+    }
 }
 
-SimilarityGraphImpl::EdgeFilter SimilarityGraphImpl::CreateEdgeFilter(heuristics::FilteredEdges filteredEdges) const noexcept
+void SimilarityGraphImpl::connectHorizontally(const utility::Point2D<Vertex>& dims)
 {
-    // if no filters are given, then we want to show every edge
-    EdgeFilter edgeFilter = [](const auto&) { return true; };
+    const auto [imageWidth, imageHeight] = dims;
+    for (auto h = 0; h < imageHeight; ++h)
+    {
+        for (auto w = 1; w < imageWidth; ++w)
+        {
+            auto prev = utility::FlattenPoint<Vertex>({ w - 1, h }, imageWidth);
+            m_graph.setEdge(prev, LatticeDirection::eEast, true);
+        }
+    }
+}
 
-    // If we have some flag packed in, then build the filter function
-    if (filteredEdges != heuristics::FilteredEdges::eNone)
+void SimilarityGraphImpl::connectVertically(const utility::Point2D<Vertex>& dims)
+{
+    const auto [imageWidth, imageHeight] = dims;
+    for (auto h = 1; h < imageHeight; ++h)
     {
-        edgeFilter = [=](const auto& edge)
+        for (auto w = 0; w < imageWidth; ++w)
         {
-            auto s = boost::source(edge, m_graph); s;
-            auto t = boost::target(edge, m_graph); t;
+            auto prev = utility::FlattenPoint<Vertex>({ w, h - 1 }, imageWidth);
+            m_graph.setEdge(prev, LatticeDirection::eSouth, true);
+        }
+    }
+}
 
-            // The paradigm here is that we want to return true to keep the edge,
-            // and false to remove it
-            EdgeFilter dissimilar = [&](const auto& edge) { return m_graph[edge].dissimilar; };
-            if (hasFilter(filteredEdges, heuristics::FilteredEdges::eDissimilar))
-            {
-                // If the edge is dissimilar, then we don't want to keep it. If it is similar,
-                // then we want to try and evaluate it with crossing edge filters
-                if (dissimilar(edge))
-                    return false;
-            }
+void SimilarityGraphImpl::connectBackwardDiagonally(const utility::Point2D<Vertex>& dims)
+{
+    const auto [imageWidth, imageHeight] = dims;
+    for (auto h = 1; h < imageHeight; ++h)
+    {
+        for (auto w = 1; w < imageWidth; ++w)
+        {
+            auto prev = utility::FlattenPoint<Vertex>({ w - 1, h - 1 }, imageWidth);
+            m_graph.setEdge(prev, LatticeDirection::eSouthEast, true);
+        }
+    }
+}
 
-            if (hasFilter(filteredEdges, heuristics::FilteredEdges::eCurves) ||
-                hasFilter(filteredEdges, heuristics::FilteredEdges::eIslands) ||
-                hasFilter(filteredEdges, heuristics::FilteredEdges::eSparsePixels))
-            {
-                // Only evaluate crossing edges that are connected
-                auto edgeWeightFilter = CreateEdgeWeightFilter(filteredEdges, dissimilar);
+void SimilarityGraphImpl::connectForwardDiagonally(const utility::Point2D<Vertex>& dims)
+{
+    const auto [imageWidth, imageHeight] = dims;
+    for (auto h = 1; h < imageHeight; ++h)
+    {
+        for (auto w = imageWidth - 1; w > 0; --w)
+        {
+            auto prev = utility::FlattenPoint<Vertex>({ w, h - 1 }, imageWidth);
+            m_graph.setEdge(prev, LatticeDirection::eSouthWest, true);
+        }
+    }
+}
 
-                if (auto crossingResult = edgeWeightFilter(edge); crossingResult.has_value())
-                    return crossingResult.value();
-            }
+void SimilarityGraphImpl::buildPalette(const di::Image<di::YCbCr, stbi_uc>& image)
+{
+    m_palette.reset();
 
-            return true;
-        };
+    auto indexedImage = di::utility::Palettize(image);
+    if (!indexedImage)
+        return;
+
+    // The heuristic compares vertex properties, so the palette is laid out as them too
+    const auto& colors = indexedImage.value().getPalette();
+
+    memory::ArenaVector<VertexProperty> palette{ m_resource };
+    palette.reserve(colors.size());
+
+    for (const auto& [Y, Cb, Cr] : colors)
+        palette.push_back({ Y, Cb, Cr });
+
+    PaletteTable table{ memory::ArenaVector<stbi_uc>{ m_resource }, palette.size(),
+        memory::ArenaVector<std::uint8_t>(palette.size() * palette.size(), 0, m_resource) };
+
+    for (std::size_t start = 0; start < table.numColors; ++start)
+    {
+        for (std::size_t end = 0; end < table.numColors; ++end)
+        {
+            auto& entry = table.dissimilarity[start * table.numColors + end];
+
+            if (heuristics::DissimilarPixels::isDissimilar(start, end, palette))
+                entry |= PaletteTable::kForward;
+
+            if (heuristics::DissimilarPixels::isDissimilar(end, start, palette))
+                entry |= PaletteTable::kBackward;
+        }
     }
 
-    return edgeFilter;
+    const auto& indices = indexedImage.value().getIndices();
+    table.indices.assign(std::cbegin(indices), std::cend(indices));
+    m_palette = std::move(table);
+}
+
+bool SimilarityGraphImpl::setNodeProperties(const di::Image<di::YCbCr, stbi_uc>& image)
+{
+    // The graph needs to be initialized with vertices first
+    if (!boost::num_vertices(m_graph))
+        return false;
+
+    const auto pixels = image.pixels();
+    if (boost::num_vertices(m_graph) != static_cast<std::size_t>(pixels.getWidth()) * pixels.getHeight())
+        return false;
+
+    // Vertices are laid out in the same row-major order as the pixels
+    Vertex idx = 0;
+    for (auto h = 0; h < pixels.getHeight(); ++h)
+    {
+        const stbi_uc* channels = pixels.row(h).data();
+        for (auto w = 0; w < pixels.getWidth(); ++w, ++idx, channels += 3)
+        {
+            auto& vertex = m_graph[idx];
+
+            vertex.Y = channels[0];
+            vertex.Cb = channels[1];
+            vertex.Cr = channels[2];
+        }
+    }
+
+    return true;
 }
 
 bool SimilarityGraphImpl::writeTex(std::ostream& output, heuristics::FilteredEdges filteredEdges)
 {
-    auto filter = CreateEdgeFilter(filteredEdges);
-    auto filteredGraph = boost::filtered_graph(m_graph, filter);
+    auto filteredGraph = boost::filtered_graph(m_graph, CachedEdgeFilter{ getNeighbourMasks(filteredEdges) });
 
     auto strategy = SimilarityGraphVisualizationStrategy<decltype(filteredGraph)>{};
     auto visualizer = LaTeXGraphVisualizer<decltype(filteredGraph)>{ strategy };
@@ -279,8 +572,7 @@ std::set<std::tuple<std::size_t, std::size_t>> SimilarityGraphImpl::getEdges(heu
 {
     std::set<std::tuple<std::size_t, std::size_t>> edges;
 
-    auto filter = CreateEdgeFilter(filteredEdges);
-    auto filteredGraph = boost::filtered_graph(m_graph, filter);
+    auto filteredGraph = boost::filtered_graph(m_graph, CachedEdgeFilter{ getNeighbourMasks(filteredEdges) });
 
     for (const auto& edge : boost::make_iterator_range(boost::edges(filteredGraph)))
         edges.insert({boost::source(edge, filteredGraph), boost::target(edge, filteredGraph)});
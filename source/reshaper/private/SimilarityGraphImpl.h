@@ -4,7 +4,10 @@
 #include <GraphUtils.h>
 #include <Heuristics.h>
 #include <Image.h>
+#include <LatticeGraph.h>
 #include <Pixel.h>
+#include <RunArena.h>
+#include <SimilarityGraph.h>
 
 /*
     Disable warnings thrown in boost
@@ -13,16 +16,20 @@
 #pragma warning( push )
 #pragma warning( disable: 4996 4127 4100 )
 
-#include <boost/graph/adjacency_list.hpp>
-#include <boost/graph/adjacency_matrix.hpp>
 #include <boost/graph/depth_first_search.hpp>
 #include <boost/graph/filtered_graph.hpp>
 
 #pragma warning( pop )
 
-#include <functional>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
 #include <set>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace di = dpa::image;
 namespace dpa::graph::internal
@@ -39,17 +46,17 @@ struct VertexProperty
 };
 
 /*
-    An edge property that supports marking edges as removed
-    by specific heuristics. This enables creating filtered graphs
-    based on each heuristic
+    An edge property that supports weighting edges by specific
+    heuristics. This enables creating filtered graphs based on each
+    heuristic. The weights are whole and half differences in small
+    counts, so they're exact as floats. Dissimilar edges are flagged
+    in the lattice graph instead, which stores a bit for each edge
 */
 struct EdgeProperty
 {
-    bool dissimilar{ false };
-
-    double curvesWeight{ 0 };
-    double islandsWeight{ 0 };
-    double sparsePixelsWeight{ 0 };
+    float curvesWeight{ 0 };
+    float islandsWeight{ 0 };
+    float sparsePixelsWeight{ 0 };
 };
 
 /*
@@ -59,15 +66,136 @@ class SimilarityGraphImpl final
 {
 public:
 
-    // using Graph = boost::adjacency_matrix<boost::undirectedS, VertexProperty, EdgeProperty>;
-    using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS, VertexProperty, EdgeProperty>; 
+    using Graph = LatticeGraph<VertexProperty, EdgeProperty>;
     using Edge = Graph::edge_descriptor;
     using Vertex = Graph::vertex_descriptor;
-  
-    using EdgeWeightFunc = std::function<double(const Edge&)>;
-    using EdgeFilter = std::function<bool(const Edge&)>;
-    using OptionalEdgeFilter = std::function<std::optional<bool>(const Edge&)>;
-    using OptionalCrossingEdgeFilter = std::function<std::optional<bool>(const Edge&, const Edge&)>;
+
+    /*
+        An edge filter specialised for one combination of filtered edges. The
+        filters are resolved at compile time, so keeping an edge costs at most a
+        few loads from the edge properties. In order for the specified edges to be
+        removed, the respective heuristic has to be run first. I.e., if you want to
+        filter out edges flagged by the dissimilar pixels heuristic, you have to
+        apply that heuristic first
+
+        @tparam Filters The edges to filter from the graph
+    */
+    template<heuristics::FilteredEdges Filters>
+    class EdgeFilter
+    {
+    public:
+
+        EdgeFilter() = default;
+
+        EdgeFilter(const Graph& graph) noexcept
+            : m_graph(&graph)
+        {}
+
+        /*
+            Determines if an edge is kept
+
+            @param edge The edge to check
+            @returns True to keep the edge, false to filter it from the graph
+        */
+        bool operator()(const Edge& edge) const noexcept
+        {
+            if constexpr (Filters != heuristics::FilteredEdges::eNone)
+            {
+                if constexpr (Has(heuristics::FilteredEdges::eDissimilar))
+                {
+                    if (m_graph->hasEdgeFlag(edge))
+                        return false;
+                }
+
+                if constexpr (kWeighted)
+                {
+                    // Only diagonals with a connected, similar crossing diagonal are weighed
+                    const auto slot = edge.index() % 4;
+                    if (slot < 2)
+                        return true;
+
+                    const Vertex owner = edge.index() / 4;
+                    const auto crossingDirection = (slot == 3) ? LatticeDirection::eSouthWest : LatticeDirection::eSouthEast;
+                    const Vertex crossingOwner = (slot == 3) ? owner + 1 : owner - 1;
+
+                    if (!m_graph->hasEdge(crossingOwner, crossingDirection))
+                        return true;
+
+                    const Edge crossing{ crossingOwner,
+                        Graph::Neighbour(crossingOwner, crossingDirection, m_graph->getWidth()), crossingDirection };
+
+                    if (m_graph->hasEdgeFlag(crossing))
+                        return true;
+
+                    // The heavier diagonal stays, and a tie removes both
+                    const double weight = Weight((*m_graph)[edge]);
+                    const double crossingWeight = Weight((*m_graph)[crossing]);
+
+                    return weight > crossingWeight;
+                }
+            }
+
+            return true;
+        }
+
+    private:
+
+        static constexpr bool Has(heuristics::FilteredEdges filter) noexcept
+        {
+            return (static_cast<int>(Filters) & static_cast<int>(filter)) != 0;
+        }
+
+        static constexpr bool kWeighted = Has(heuristics::FilteredEdges::eCurves) ||
+            Has(heuristics::FilteredEdges::eIslands) || Has(heuristics::FilteredEdges::eSparsePixels);
+
+        /*
+            Sums the weights of the filtered heuristics
+
+            @param property The properties of an edge
+            @returns The edge's total weight
+        */
+        static double Weight(const EdgeProperty& property) noexcept
+        {
+            double weight = 0;
+
+            if constexpr (Has(heuristics::FilteredEdges::eCurves))
+                weight += property.curvesWeight;
+
+            if constexpr (Has(heuristics::FilteredEdges::eIslands))
+                weight += property.islandsWeight;
+
+            if constexpr (Has(heuristics::FilteredEdges::eSparsePixels))
+                weight += property.sparsePixelsWeight;
+
+            return weight;
+        }
+
+        const Graph* m_graph{ nullptr };
+    };
+
+    /*
+        An edge filter that reads whether to keep an edge from the filtered
+        neighbour masks cached for some combination of filtered edges
+    */
+    class CachedEdgeFilter
+    {
+    public:
+
+        CachedEdgeFilter() = default;
+
+        CachedEdgeFilter(const std::vector<std::uint8_t>& masks) noexcept
+            : m_masks(&masks)
+        {}
+
+        bool operator()(const Edge& edge) const noexcept
+        {
+            return ((*m_masks)[edge.source] >> static_cast<std::uint8_t>(edge.direction)) & 1;
+        }
+
+    private:
+
+        const std::vector<std::uint8_t>* m_masks{ nullptr };
+    };
 
 public:
 
@@ -79,6 +207,14 @@ public:
     */
     bool build(const di::Image<di::RGB, stbi_uc>& image);
 
+    /*
+        Sets the memory resource the graph's per-image storage is allocated
+        from. This only applies to graphs built afterwards
+
+        @param resource The memory resource to allocate from
+    */
+    void setMemoryResource(std::pmr::memory_resource* resource) noexcept { m_resource = resource; }
+
     /*
         Applies the given heuristic to the similarity graph,
         which modifies the edges in the graph
@@ -91,18 +227,168 @@ public:
     void applyHeuristic(const Visitor& visitor,
         heuristics::FilteredEdges edgeFilter = heuristics::FilteredEdges::eNone) const noexcept
     {
+        // Every run starts with an empty mark buffer. The search can't tell how many
+        // edges it'll mark, so the buffer grows as it goes
+        visitor.resetMarkedEdges(0);
+
         if (edgeFilter == heuristics::FilteredEdges::eNone)
         {
             boost::depth_first_search(m_graph, boost::visitor(visitor));
             return;
         }
-   
-        EdgeFilter filter = CreateEdgeFilter(edgeFilter);
-        auto filteredGraph = boost::filtered_graph(m_graph, filter);
 
+        auto filteredGraph = boost::filtered_graph(m_graph, CachedEdgeFilter{ getNeighbourMasks(edgeFilter) });
         boost::depth_first_search(filteredGraph, boost::visitor(visitor));
     }
 
+    /*
+        Applies a crossing heuristic to every 2x2 block of pixels whose diagonals
+        cross, which marks edges in the heuristic. Only the blocks in the crossing
+        index are visited, rather than every edge in the graph. Each diagonal is
+        examined in both orientations, as it would be in a depth first search
+
+        @param visitor The heuristic to apply to the crossing blocks
+    */
+    template<typename Visitor>
+    void applyCrossingHeuristic(const Visitor& visitor) const
+    {
+        // A block that isn't a tie marks both orientations of one of its diagonals. Most
+        // blocks are ties, so the buffer starts with room for one mark per block
+        visitor.resetMarkedEdges(m_crossings.size());
+
+        // The heuristics still measure the surroundings of each crossing in the
+        // graph with the dissimilar edges removed
+        auto filteredGraph = boost::filtered_graph(m_graph,
+            CachedEdgeFilter{ getNeighbourMasks(heuristics::FilteredEdges::eDissimilar) });
+
+        const auto imageWidth = static_cast<Vertex>(std::get<0>(m_imageDims));
+
+        Visitor crossingVisitor{ visitor };
+        for (const Vertex topLeft : m_crossings)
+        {
+            const Vertex topRight = topLeft + 1;
+            const Vertex bottomLeft = topLeft + imageWidth;
+            const Vertex bottomRight = bottomLeft + 1;
+
+            const Edge backward{ topLeft, bottomRight, LatticeDirection::eSouthEast };
+            const Edge backwardReversed{ bottomRight, topLeft, LatticeDirection::eNorthWest };
+            const Edge forward{ topRight, bottomLeft, LatticeDirection::eSouthWest };
+            const Edge forwardReversed{ bottomLeft, topRight, LatticeDirection::eNorthEast };
+
+            crossingVisitor.examine_crossing(backward, forwardReversed, filteredGraph);
+            crossingVisitor.examine_crossing(backwardReversed, forward, filteredGraph);
+            crossingVisitor.examine_crossing(forward, backwardReversed, filteredGraph);
+            crossingVisitor.examine_crossing(forwardReversed, backward, filteredGraph);
+        }
+    }
+
+    /*
+        Resolves the graph in a single pass. Dissimilar edges are removed, and
+        then every crossing block is visited once, where the curves, islands and
+        sparse pixels votes are summed to decide which diagonal to keep. The
+        losing diagonal is removed from the graph, along with both diagonals
+        when the votes tie, so the graph is left holding the resolved edges
+    */
+    void resolveCrossings();
+
+    /*
+        Gets counts describing how the graph was built and resolved
+
+        @returns The graph's statistics, with the resolved edges counted now
+    */
+    SimilarityGraphStatistics getStatistics() const noexcept;
+
+    /*
+        Finds the dissimilar edges in the whole image at once. The channels are
+        compared a row at a time with the fastest dissimilarity kernel available,
+        and the rows are spread across threads. Edges are found whether or not
+        they're still in the graph
+
+        @returns The neighbour mask of each pixel's dissimilar east, south,
+                 south west and south east edges, in row-major order
+    */
+    std::vector<std::uint8_t> findDissimilarEdges() const;
+
+    /*
+        Determines if the graph was built from an image with few enough colours
+        to be palettized, in which case pixels are compared by looking up their
+        palette indices rather than their channels
+
+        @returns True if the pixels are compared through a palette, false otherwise
+    */
+    bool isPalettized() const noexcept { return m_palette.has_value(); }
+
+    /*
+        Applies the dissimilar pixels heuristic to the whole image at once, rather
+        than searching the graph. The kernel finds the dissimilar edges, and only
+        those are compared in each orientation, so the heuristic is left with the
+        same marks a depth first search would have made
+
+        @param visitor The heuristic to mark the dissimilar edges in
+    */
+    void applyDissimilarHeuristic(const heuristics::DissimilarPixels& visitor) const;
+
+    /*
+        Flags every dissimilar edge in the graph, which is what applying the
+        dissimilar pixels heuristic and setting its edge properties does
+
+        @param removeEdges True to also remove the dissimilar edges from the graph
+    */
+    void flagDissimilarEdges(bool removeEdges);
+
+    /*
+        Rebuilds the index of 2x2 blocks of pixels where both diagonals are
+        connected and similar. This needs to be called whenever the graph's
+        edges or their dissimilar flags change
+    */
+    void indexCrossings();
+
+    /*
+        Gets the top left vertex of every 2x2 block of pixels in the
+        crossing index, in row-major order
+
+        @returns The crossing blocks in the graph
+    */
+    const std::vector<Vertex>& getCrossings() const noexcept { return m_crossings; }
+
+    /*
+        Gets the neighbour mask of every pixel, in row-major order, with the given
+        edges filtered out. Bit n of a mask is set when the pixel is connected in
+        the LatticeDirection with an underlying value of n. The filtered masks are
+        cached, so the filter is only evaluated again once the edges it depends on
+        have been changed by a heuristic
+
+        @param filteredEdges The edges to filter from the graph
+        @returns A constant reference to the neighbour masks
+    */
+    const std::vector<std::uint8_t>& getNeighbourMasks(
+        heuristics::FilteredEdges filteredEdges = heuristics::FilteredEdges::eNone) const;
+
+    /*
+        Drops the cached neighbour masks of every combination of filtered edges
+        that depends on the given ones. This needs to be called whenever a
+        heuristic changes the properties those filters read
+
+        @param changedEdges The filtered edges whose properties were changed
+    */
+    void invalidateNeighbourMasks(heuristics::FilteredEdges changedEdges) noexcept;
+
+    /*
+        Determines if an edge was flagged by the dissimilar pixels heuristic
+
+        @param edge The edge to check
+        @returns True if the edge connects dissimilar pixels, false otherwise
+    */
+    bool isDissimilar(const Edge& edge) const noexcept { return m_graph.hasEdgeFlag(edge); }
+
+    /*
+        Flags or unflags an edge as connecting dissimilar pixels
+
+        @param edge The edge to flag
+        @param dissimilar True if the edge connects dissimilar pixels, false otherwise
+    */
+    void setDissimilar(const Edge& edge, bool dissimilar) noexcept { m_graph.setEdgeFlag(edge.source, edge.direction, dissimilar); }
+
     /*
         Prints a non-graphical representation of the graph
 
@@ -130,7 +416,8 @@ public:
 
     /*
         Sets the edge properties based on the results of the applied
-        heuristic
+        heuristic. The marks are lattice edges, so they index straight
+        into the graph's edge properties
 
         @param heuristic The heuristic that was run
         @param callback A callback function that sets the appropriate
@@ -139,16 +426,8 @@ public:
     template<typename Visitor, typename Callback>
     void setEdgeProperties(const Visitor& heuristic, Callback callback)
     {
-        for (const auto [markedEdge, value] : heuristic.getMarkedEdges())
-        {
-            const auto [start, end] = markedEdge;
-            const auto [edge, found] = boost::edge(start, end, m_graph);
-
-            if (!found)
-                throw std::runtime_error("Couldn't map the marked edge with what's in the graph");
-
+        for (const auto& [edge, value] : heuristic.getEdgeMarks().getMarked())
             callback(edge, value);
-        }
     }
 
 private:
@@ -190,47 +469,97 @@ private:
     bool setNodeProperties(const di::Image<di::YCbCr, stbi_uc>& image);
 
     /*
-        Creates and edge filtering function based on the specified filters.
-        In order for the specified edges to be removed, the respective heuristic
-        has to be run first. I.e., if you want to filter out edges flagged by the
-        dissimilar pixels heuristic, you have to apply that heuristic first
+        Palettizes the image, and compares every pair of colours in its palette
+        ahead of time. Nothing is stored if the image has too many colours
 
-        @param filteredEdges A flag containing edge types to filter from the graph
-        @returns An edge filtering function that removes the edges hidden by the
-                 specified filters
+        @param image An image in YCbCr color space containing pixel data
     */
-    EdgeFilter CreateEdgeFilter(heuristics::FilteredEdges filteredEdges) const noexcept;
-    
+    void buildPalette(const di::Image<di::YCbCr, stbi_uc>& image);
+
     /*
-        Creates a function that takes a set of crossing edges, and evaluates whether or not
-        the edge in the first parameter slot should be filtered or not. Invalid input
-        causes the returned function to return an std::nullopt
+        Finds the dissimilar edges in the whole image by looking up each pair
+        of neighbouring palette indices, rather than comparing their channels
 
-        @param filteredEdges A flag containing edge types to filter from the graph
-        @returns A function that evaluates crossing edges
+        @returns The neighbour mask of each pixel's dissimilar east, south,
+                 south west and south east edges, in row-major order
     */
-    OptionalCrossingEdgeFilter CreateCrossingEdgeFilter(heuristics::FilteredEdges filteredEdges) const noexcept;
-    
+    std::vector<std::uint8_t> findPaletteDissimilarEdges() const;
+
     /*
-        Creates a function that can filter any type of crossing edge filter
+        Compares the pixels at either end of an edge, in the direction of the
+        edge, the same way the dissimilar pixels heuristic does
 
-        @param filteredEdges A flag containing edge types to filter from the graph
-        @returns A function that can process any kind of crossing edge filter
+        @param start The vertex the edge starts at
+        @param end The vertex the edge ends at
+        @returns True if the pixels are dissimilar, false otherwise
     */
-    OptionalEdgeFilter CreateEdgeWeightFilter(heuristics::FilteredEdges filteredEdges, EdgeFilter dissimilar) const noexcept;
-    
+    bool isDissimilar(Vertex start, Vertex end) const noexcept;
+
     /*
-        Creates a function that accumulates the edge weights of the specified filters
+        Calls the given function with the edge filter specialised for the given
+        filtered edges. The filters are only dispatched on once, rather than on
+        every edge the filter is asked about
 
         @param filteredEdges A flag containing edge types to filter from the graph
-        @returns A function that accumulates the specified edges weights
+        @param callback A function that takes any of the EdgeFilter specialisations
+        @returns Whatever the callback returns
     */
-    EdgeWeightFunc CreateEdgeWeightAccumulator(heuristics::FilteredEdges filteredEdges) const noexcept;
+    template<int Filters = 0, typename Callback>
+    decltype(auto) visitEdgeFilter(heuristics::FilteredEdges filteredEdges, Callback&& callback) const
+    {
+        constexpr int kAllFilters = static_cast<int>(heuristics::FilteredEdges::eAll);
+
+        if constexpr (Filters < kAllFilters)
+        {
+            if (static_cast<int>(filteredEdges) != Filters)
+                return visitEdgeFilter<Filters + 1>(filteredEdges, std::forward<Callback>(callback));
+        }
+
+        return callback(EdgeFilter<static_cast<heuristics::FilteredEdges>(Filters)>{ m_graph });
+    }
 
 public:
 
-    Graph m_graph{ 0 };
+    Graph m_graph{};
     dpa::image::internal::Point2D m_imageDims;
 
+private:
+
+    // The top left vertex of each 2x2 block where both diagonals survive
+    std::vector<Vertex> m_crossings{};
+
+    // What building and resolving the graph has done so far
+    SimilarityGraphStatistics m_statistics{};
+
+    /*
+        The image's pixels as palette indices, along with whether each pair of
+        palette colours is dissimilar. Bit 0 of an entry is set when comparing
+        the first colour to the second is dissimilar, and bit 1 when comparing
+        the second to the first, since the heuristic's comparison is directional
+    */
+    struct PaletteTable
+    {
+        static constexpr std::uint8_t kForward = 1;
+        static constexpr std::uint8_t kBackward = 2;
+
+        memory::ArenaVector<stbi_uc> indices{};
+        std::size_t numColors{ 0 };
+        memory::ArenaVector<std::uint8_t> dissimilarity{};
+
+        std::uint8_t compare(stbi_uc start, stbi_uc end) const noexcept { return dissimilarity[start * numColors + end]; }
+    };
+
+    std::optional<PaletteTable> m_palette{};
+
+    // Where the lattice and the other per-image storage are allocated from
+    std::pmr::memory_resource* m_resource{ std::pmr::get_default_resource() };
+
+    // The neighbour masks of the graph for each combination of filtered
+    // edges, and which of them are up to date
+    static constexpr std::size_t kNumFilterCombinations = static_cast<std::size_t>(heuristics::FilteredEdges::eAll) + 1;
+
+    mutable std::array<std::vector<std::uint8_t>, kNumFilterCombinations> m_filteredMasks{};
+    mutable std::bitset<kNumFilterCombinations> m_cachedMasks{};
+
 };
 }
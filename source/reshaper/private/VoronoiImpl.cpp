@@ -2,6 +2,8 @@
 
 #include <GraphUtils.h>
 #include <GraphVisualizer.h>
+#include <LatticeGraph.h>
+#include <Trace.h>
 #include <VoronoiGraphVisualizationStrategy.h>
 
 #pragma warning(push)
@@ -11,7 +13,6 @@
 #include <boost/geometry/algorithms/transform.hpp>
 
 #include <boost/graph/graph_utility.hpp>
-#include <boost/graph/copy.hpp>
 
 #include <boost/property_map/property_map.hpp>
 
@@ -19,231 +20,336 @@
 
 #include <algorithm>
 #include <array>
-#include <map>
+#include <cmath>
 #include <iterator>
 #include <limits>
+#include <numeric>
 #include <set>
-#include <sstream>
+#include <thread>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 namespace
 {
-/*
-    A DFS visitor that copies the graph it visits
-*/
-template<typename Graph>
-class GraphCopier : public boost::default_dfs_visitor
-{
-public:
-
-    /*
-        Parameterized constructor.
-
-        @param dest         The graph to write into while visiting each
-                            node in the visited graph
-        @param vertexOffset The amount to offset each vertex in the graph
-                            when copying them into the output graph
-    */
-    explicit GraphCopier(Graph& dest, std::size_t vertexOffset)
-        : m_graph(dest), m_offset(vertexOffset)
-    {}
-
-    /*
-        Copy constructor.
-    */
-    GraphCopier(const GraphCopier& other)
-        : m_graph(other.m_graph), m_offset(other.m_offset)
-    {}
-
-    /*
-        The hook that's called when a vertex is first encountered
-        in the visited graph
-
-        @param vertex   The vertex that's being discovered
-        @param graph    The graph the vertex belongs too
-    */
-    template<typename Vertex>
-    void discover_vertex(Vertex vertex, const Graph& graph)
-    {
-        m_graph[vertex + m_offset].x = graph[vertex].x;
-        m_graph[vertex + m_offset].y = graph[vertex].y;
-    }
+// The number of lattice steps per pixel. Every point of a voronoi cell lies on a quarter pixel
+constexpr long k_latticeScale = 4;
 
-    /*
-        A hook that's called when an edge is examined. This occurs
-        whenever the edge is touched, and so this method could be called
-        many times for the same edge
+constexpr auto k_doubleMin = std::numeric_limits<double>::min();
 
-        @param edge     The edge to examine
-        @param graph    The graph the edge belongs to
-    */
-    template<typename Edge>
-    void examine_edge(Edge edge, const Graph& graph)
-    {
-        const auto start = boost::source(edge, graph);
-        const auto end = boost::target(edge, graph);
+// The number of bands of rows handed to each hardware thread, so uneven bands even out
+constexpr std::size_t k_bandsPerThread = 4;
 
-        if (m_insertedEdges.find({ start, end }) == std::end(m_insertedEdges))
-            boost::add_edge(start + m_offset, end + m_offset, m_graph);
+// The distance in YCbCr between two pixels' colours past which the contour between them is visible
+constexpr int k_visibleContourThreshold = 100;
 
-        if (m_insertedEdges.find({ end, start }) == std::end(m_insertedEdges))
-            boost::add_edge(end + m_offset, start + m_offset, m_graph);
+/*
+    Splits the rows of a grid into contiguous bands to be processed in parallel
 
-        m_insertedEdges.insert({ start, end });
-        m_insertedEdges.insert({ end, start });
-    }
+    @param numRows  The number of rows in the grid
 
-private:
+    @returns The first row, and one past the last row, of each band in order
+*/
+std::vector<std::pair<std::size_t, std::size_t>> PartitionRows(std::size_t numRows)
+{
+    const std::size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t numBands = std::clamp<std::size_t>(numThreads * k_bandsPerThread, 1, std::max<std::size_t>(numRows, 1));
+    const std::size_t bandSize = (numRows + numBands - 1) / numBands;
+
+    std::vector<std::pair<std::size_t, std::size_t>> bands;
+    for (std::size_t first = 0; first < numRows; first += bandSize)
+        bands.emplace_back(first, std::min(first + bandSize, numRows));
+
+    return bands;
+}
 
-    typedef typename Graph::vertex_descriptor Vertex;
-    std::set<std::tuple<Vertex, Vertex>> m_insertedEdges;
+/*
+    Picks a block edge out of a pixel's neighbour mask
 
-    std::size_t m_offset{ 0 };
-    Graph& m_graph;
+    @param mask         The neighbour mask of the pixel that owns the edge
+    @param direction    The direction the edge leaves the pixel in
+    @param edge         The PixelBlock::k* bit of the edge
 
-};
+    @returns The edge bit if the pixel is connected in that direction, zero otherwise
+*/
+constexpr std::uint8_t MaskToEdge(std::uint8_t mask, dpa::graph::internal::LatticeDirection direction, std::uint8_t edge) noexcept
+{
+    return ((mask >> static_cast<std::uint8_t>(direction)) & 1) ? edge : 0;
+}
 
 /*
-    Wraps a container in an object that provides
-    convenient syntax for searching
+    Finds the two corners of a block whose pixels' cells an edge of a cell runs between.
+    These are the corners nearest the middle of the edge on either side of it, since
+    corners on the line through the edge don't belong to either side
+
+    @param source   One end of the edge, relative to the block's center
+    @param target   The other end of the edge, relative to the block's center
 
-    @tparam Container   The type of container to search through
+    @returns The corners, numbered 0 to 3 in row-major order, with the lower one first
 */
-template<typename Container>
-struct Searchable
+std::tuple<std::uint8_t, std::uint8_t> SeparatedCorners(
+    const dpa::voronoi::internal::Point2D<double>& source, const dpa::voronoi::internal::Point2D<double>& target)
 {
-    /*
-        Parameterized constructor
+    constexpr double tolerance = 1e-9;
 
-        @param container    The container to search through
-    */
-    explicit Searchable(const Container& container) noexcept
-        : m_container(container)
-    {}
+    const double sourceX = boost::geometry::get<0>(source);
+    const double sourceY = boost::geometry::get<1>(source);
+    const double targetX = boost::geometry::get<0>(target);
+    const double targetY = boost::geometry::get<1>(target);
 
-    /*
-        Checks if the container has the given value
+    const double middleX = (sourceX + targetX) / 2;
+    const double middleY = (sourceY + targetY) / 2;
 
-        @param value The value to search for
-        @returns True if the value is contained, false otherwise
-    */
-    template<typename Value>
-    bool has(const Value& value) const noexcept;
+    // The normal of the edge, which tells the side a corner is on
+    const double normalX = sourceY - targetY;
+    const double normalY = targetX - sourceX;
 
-private:
+    std::array<std::uint8_t, 2> nearest{ 0, 0 };
+    std::array<double, 2> nearestDistance{ std::numeric_limits<double>::max(), std::numeric_limits<double>::max() };
 
-    const Container& m_container;
-};
+    for (std::uint8_t corner = 0; corner < 4; ++corner)
+    {
+        const double dx = (corner & 1 ? .5 : -.5) - middleX;
+        const double dy = (corner & 2 ? .5 : -.5) - middleY;
 
-template<typename Container>
-template<typename Value>
-bool Searchable<Container>::has(const Value& target) const noexcept
-{
-    return std::any_of(std::cbegin(m_container), std::cend(m_container),
-        [&](auto value)
+        const double side = normalX * dx + normalY * dy;
+        if (std::abs(side) < tolerance)
+            continue;
+
+        const std::size_t which = side > 0;
+        const double distance = dx * dx + dy * dy;
+        if (distance < nearestDistance[which])
         {
-            return value == target;
-        });
+            nearest[which] = corner;
+            nearestDistance[which] = distance;
+        }
+    }
+
+    return std::minmax(nearest[0], nearest[1]);
 }
 
 /*
-    Converts the given point into a tuple
+    Gets the block edge between two corners of a block
 
-    @param point A point to convert
-    @returns A tuple containing the point's values
+    @param first    The lower of the corners, numbered 0 to 3 in row-major order
+    @param second   The higher of the corners
+
+    @returns The PixelBlock::k* bit of the edge between the corners
 */
-std::tuple<double, double> AsTuple(const dpa::voronoi::internal::Point2D<double>& point)
+constexpr std::uint8_t CornerEdge(std::uint8_t first, std::uint8_t second) noexcept
 {
-    return std::make_tuple(point.get<0>(), point.get<1>());
+    using dpa::voronoi::internal::PixelBlock;
+
+    switch (first << 2 | second)
+    {
+    case 0 << 2 | 1: return PixelBlock::kTop;
+    case 2 << 2 | 3: return PixelBlock::kBottom;
+    case 0 << 2 | 2: return PixelBlock::kLeft;
+    case 1 << 2 | 3: return PixelBlock::kRight;
+    case 1 << 2 | 2: return PixelBlock::kForwardDiagonal;
+    case 0 << 2 | 3: return PixelBlock::kBackDiagonal;
+    default: return 0;
+    }
 }
 
 /*
-    Gets the upper left corner of the minimum bounding box around the given edge
+    Builds a cell template from a canonical cell, centered at 0, 0, by rotating it into place
 
-    @param edge The edge to get the reference point from
-    @param rowSize The width of the graph
+    @param points   The points of the canonical cell
+    @param edges    The edges between the points of the canonical cell
+    @param welds    The points on the border of the canonical cell
+    @param theta    The angle in degrees to rotate the canonical cell by
 
-    @returns The reference point of the edge
+    @returns The rotated cell template
 */
-std::tuple<double, double> GetReferencePoint(const dpa::voronoi::internal::PixelBlock& block, std::size_t rowSize)
+template<std::size_t NumPoints, std::size_t NumEdges>
+dpa::voronoi::internal::VoronoiCellTemplate MakeCellTemplate(
+    const std::array<dpa::voronoi::internal::Point2D<double>, NumPoints>& points,
+    const std::array<std::tuple<std::size_t, std::size_t>, NumEdges>& edges,
+    const std::array<std::size_t, dpa::voronoi::internal::VoronoiCellTemplate::kNumWelds>& welds,
+    double theta)
 {
-    namespace dvi = dpa::voronoi::internal;
+    using namespace boost::geometry::strategy;
 
-    const auto UnpackEdge = [rowSize](dvi::BlockEdge edge, auto retFn, auto tag)
-    {
-        const auto [s, t] = edge;
+    dpa::voronoi::internal::VoronoiCellTemplate cell;
+    transform::rotate_transformer<boost::geometry::degree, double, 2, 2> rotate(theta);
 
-        const auto [x1, y1] = dpa::graph::utility::ExpandIndex(s, rowSize);
-        const auto [x2, y2] = dpa::graph::utility::ExpandIndex(t, rowSize);
+    cell.numPoints = NumPoints;
+    for (std::size_t i = 0; i < NumPoints; ++i)
+        boost::geometry::transform(points[i], cell.points[i], rotate);
 
-        return retFn(x1, y1, x2, y2, tag);
-    };
+    cell.numEdges = NumEdges;
+    std::copy(std::cbegin(edges), std::cend(edges), std::begin(cell.edges));
 
-    return VisitPixelBlockEdges(block, UnpackEdge, dvi::PixelBlockDispatcher
-        {
-            [](std::size_t x1, std::size_t y1, std::size_t x2, std::size_t y2, dvi::PixelBlockLeftTag)
-            {
-                return std::make_tuple(static_cast<double>(std::min(x1, x2)), static_cast<double>(std::min(y1, y2)));
-            },
-            
-            [](std::size_t x1, std::size_t y1, std::size_t x2, std::size_t y2, dvi::PixelBlockRightTag)
-            {
-                return std::make_tuple(static_cast<double>(std::min(x1, x2) - 1), static_cast<double>(std::min(y1, y2)));
-            },
+    for (std::size_t i = 0; i < NumEdges; ++i)
+    {
+        const auto [source, target] = edges[i];
+        cell.edgeCorners[i] = SeparatedCorners(cell.points[source], cell.points[target]);
+    }
 
-            [](std::size_t x1, std::size_t y1, std::size_t x2, std::size_t y2, dvi::PixelBlockTopTag)
-            {
-                return std::make_tuple(static_cast<double>(std::min(x1, x2)), static_cast<double>(std::min(y1, y2)));
-            },
+    cell.welds = welds;
 
-            [](std::size_t x1, std::size_t y1, std::size_t x2, std::size_t y2, dvi::PixelBlockBottomTag)
-            {
-                return std::make_tuple(static_cast<double>(std::min(x1, x2)), static_cast<double>(std::min(y1, y2)) - 1);
-            },
+    // Each border point is the end of a single edge
+    for (std::size_t i = 0; i < welds.size(); ++i)
+    {
+        for (std::size_t j = 0; j < NumEdges; ++j)
+        {
+            const auto [source, target] = edges[j];
+            if (source != welds[i] && target != welds[i])
+                continue;
 
-            [](std::size_t x1, std::size_t y1, std::size_t x2, std::size_t y2, dvi::PixelBlockForwardDiagonalTag)
-            {
-                return std::make_tuple(static_cast<double>(std::min(x1, x2)), static_cast<double>(std::min(y1, y2)));
-            },
+            cell.weldAnchors[i] = source == welds[i] ? target : source;
+            cell.weldEdges[i] = j;
+        }
+    }
 
-            [](std::size_t x1, std::size_t y1, std::size_t x2, std::size_t y2, dvi::PixelBlockBackDiagonalTag)
-            {
-                return std::make_tuple(static_cast<double>(std::min(x1, x2)), static_cast<double>(std::min(y1, y2)));
-            },
-        });
+    return cell;
 }
-
-constexpr auto k_doubleMin = std::numeric_limits<double>::min();
 }
 
 namespace dpa::voronoi::internal
 {
-std::string PixelBlock::serialize() const noexcept
-{
-    std::ostringstream edgeConfig;
-
-    if (left)
-        edgeConfig << "l";
+BlockGrid::BlockGrid(std::size_t width, std::size_t height, std::pmr::memory_resource* resource)
+    : m_width(width), m_height(height), m_blocks(width * height, resource)
+{}
 
-    if (right)
-        edgeConfig << "r";
-
-    if (top)
-        edgeConfig << "t";
+std::optional<BlockEdge> BlockGrid::getEdge(std::size_t w, std::size_t h, std::uint8_t edge) const noexcept
+{
+    if (!at(w, h).has(edge))
+        return std::nullopt;
 
-    if (bottom)
-        edgeConfig << "b";
+    // The image is a pixel wider than the grid
+    const std::size_t topLeft = h * (m_width + 1) + w;
+    const std::size_t topRight = topLeft + 1;
+    const std::size_t bottomLeft = topLeft + m_width + 1;
+    const std::size_t bottomRight = bottomLeft + 1;
 
-    if (forwardDiagonal)
-        edgeConfig << "[fD]";
+    switch (edge)
+    {
+    case PixelBlock::kLeft: return BlockEdge{ topLeft, bottomLeft };
+    case PixelBlock::kRight: return BlockEdge{ topRight, bottomRight };
+    case PixelBlock::kTop: return BlockEdge{ topLeft, topRight };
+    case PixelBlock::kBottom: return BlockEdge{ bottomLeft, bottomRight };
+    case PixelBlock::kForwardDiagonal: return BlockEdge{ bottomLeft, topRight };
+    case PixelBlock::kBackDiagonal: return BlockEdge{ topLeft, bottomRight };
+    default: return std::nullopt;
+    }
+}
 
-    if (backDiagonal)
-        edgeConfig << "[bD]";
+const std::array<VoronoiCellTemplate, PixelBlock::kNumCodes>& GetVoronoiCellTemplates()
+{
+    static const auto templates = []
+    {
+        /*
+                *
+                |
+            *---*---*
+                |
+                *
+        */
+        const auto defaultCell = [](double theta)
+        {
+            return MakeCellTemplate<5, 4>(
+                {
+                    Point2D<double>{k_doubleMin, -.5},
+                    Point2D<double>{-.5, k_doubleMin},
+                    Point2D<double>{k_doubleMin, k_doubleMin},
+                    Point2D<double>{.5, k_doubleMin},
+                    Point2D<double>{k_doubleMin, .5},
+                },
+                {{ { 0, 2 }, { 1, 2 }, { 2, 3 }, { 2, 4 } }},
+                { 0, 1, 3, 4 }, theta);
+        };
+
+        const auto triangleCell = [](double theta)
+        {
+            return MakeCellTemplate<6, 5>(
+                {
+                    Point2D<double>{k_doubleMin, -.5},
+                    Point2D<double>{.25, -.25},
+                    Point2D<double>{-.5, k_doubleMin},
+                    Point2D<double>{k_doubleMin, k_doubleMin},
+                    Point2D<double>{.5, k_doubleMin},
+                    Point2D<double>{k_doubleMin, .5}
+                },
+                {{ { 0, 1 }, { 2, 3 }, { 3, 1 }, { 1, 4 }, { 3, 5 } }},
+                { 0, 2, 4, 5 }, theta);
+        };
+
+        const auto diagonalCell = [](double theta)
+        {
+            return MakeCellTemplate<7, 6>(
+                {
+                    Point2D<double>{k_doubleMin, -.5},
+                    Point2D<double>{-.25, -.25},
+                    Point2D<double>{-.5, k_doubleMin},
+                    Point2D<double>{k_doubleMin, k_doubleMin},
+                    Point2D<double>{.5, k_doubleMin},
+                    Point2D<double>{.25, .25},
+                    Point2D<double>{k_doubleMin, .5},
+                },
+                {{ { 0, 1 }, { 1, 2 }, { 1, 3 }, { 3, 5 }, { 5, 4 }, { 6, 5 } }},
+                { 0, 2, 4, 6 }, theta);
+        };
+
+        std::array<VoronoiCellTemplate, PixelBlock::kNumCodes> cells{};
+
+        // Any block with an edge on its border gets the default cell. A block that only
+        // has both diagonals was never resolved, and doesn't get a cell at all
+        constexpr auto borderEdges = PixelBlock::kLeft | PixelBlock::kRight | PixelBlock::kTop | PixelBlock::kBottom;
+        for (std::size_t code = 0; code < cells.size(); ++code)
+        {
+            if (code & borderEdges)
+                cells[code] = defaultCell(0);
+        }
 
-    return edgeConfig.str();
+        /*
+              *
+              |\
+              | \
+              *--*
+        */
+        cells[PixelBlock::kLeft | PixelBlock::kBottom | PixelBlock::kBackDiagonal] = triangleCell(0);
+
+        /*
+            *--*
+            | /
+            |/
+            *
+        */
+        cells[PixelBlock::kLeft | PixelBlock::kTop | PixelBlock::kForwardDiagonal] = triangleCell(270);
+
+        /*
+            *--*
+             \ |
+              \|
+               *
+        */
+        cells[PixelBlock::kRight | PixelBlock::kTop | PixelBlock::kBackDiagonal] = triangleCell(180);
+
+        /*
+               *
+              /|
+             / |
+            *--*
+        */
+        cells[PixelBlock::kRight | PixelBlock::kBottom | PixelBlock::kForwardDiagonal] = triangleCell(90);
+
+        cells[PixelBlock::kForwardDiagonal] = diagonalCell(0);
+        cells[PixelBlock::kBackDiagonal] = diagonalCell(90);
+
+        return cells;
+    }();
+
+    return templates;
 }
 
 void VoronoiImpl::build(const std::set<BlockEdge>& edges) noexcept
+{
+    build(buildNeighbourMasks(edges));
+}
+
+void VoronoiImpl::build(const std::vector<std::uint8_t>& neighbourMasks) noexcept
 {
     // Handle the single row or column special case...
     if (m_height < 2 || m_width < 2)
@@ -251,9 +357,33 @@ void VoronoiImpl::build(const std::set<BlockEdge>& edges) noexcept
         return;
     }
 
+    if (neighbourMasks.size() != static_cast<std::size_t>(m_width) * m_height)
+        return;
+
     // Handle everything else
-    m_blockGrid = dispatchGridBuilder(std::execution::seq, edges);
-    m_voronoiGraph = dispatchVoronoiBuilder(std::execution::seq, m_blockGrid);
+    const auto buildWith = [&](auto policy)
+    {
+        {
+            trace::TraceSpan span{ "buildBlockGrid", "voronoi" };
+            m_blockGrid = dispatchGridBuilder(policy, neighbourMasks);
+        }
+
+        trace::TraceSpan span{ "buildVoronoiGraph", "voronoi" };
+        m_voronoiGraph = dispatchVoronoiBuilder(policy, m_blockGrid);
+    };
+
+    switch (m_policy)
+    {
+    case ExecutionPolicy::eParallel:
+        buildWith(std::execution::par);
+        break;
+    case ExecutionPolicy::eParallelUnsequenced:
+        buildWith(std::execution::par_unseq);
+        break;
+    default:
+        buildWith(std::execution::seq);
+        break;
+    }
 }
 
 void VoronoiImpl::setDimensions(const std::tuple<int, int>& graphDims) noexcept
@@ -261,511 +391,511 @@ void VoronoiImpl::setDimensions(const std::tuple<int, int>& graphDims) noexcept
     std::tie(m_width, m_height) = graphDims;
 }
 
-bool VoronoiImpl::writeTex(std::ostream& output)
+VoronoiStatistics VoronoiImpl::getStatistics() const noexcept
 {
-    auto strategy = VoronoiVisualizationStrategy<Graph>{};
-    auto visualizer = dpa::graph::internal::LaTeXGraphVisualizer<Graph>{ strategy };
+    const auto& cells = GetVoronoiCellTemplates();
 
-    return visualizer.writeTex(m_voronoiGraph, std::make_tuple(m_width, m_height), output);
-}
+    VoronoiStatistics statistics;
+    statistics.numVertices = boost::num_vertices(m_voronoiGraph);
+    statistics.numEdges = boost::num_edges(m_voronoiGraph);
 
-void VoronoiImpl::printGraph(std::ostream& stream)
-{
-    boost::print_graph(m_voronoiGraph, boost::get(boost::vertex_index, m_voronoiGraph), stream);
-}
-
-void VoronoiImpl::printVertices(std::ostream& stream)
-{
-    const auto toString = [&](auto vertexDescriptor)
+    std::size_t numPoints = 0;
+    for (std::size_t h = 0; h < m_blockGrid.getHeight(); ++h)
     {
-        auto x = std::to_string(m_voronoiGraph[vertexDescriptor].x);
-        auto y = std::to_string(m_voronoiGraph[vertexDescriptor].y);
+        for (std::size_t w = 0; w < m_blockGrid.getWidth(); ++w)
+        {
+            const auto& cell = cells[m_blockGrid.at(w, h).code];
+            statistics.numCells += cell.numPoints != 0;
+            numPoints += cell.numPoints;
+        }
+    }
 
-        return "(" + x + ", " + y + ")";
-    };
+    if (numPoints > statistics.numVertices)
+        statistics.numWelds = (numPoints - statistics.numVertices) / 2;
 
-    for (auto iter : boost::make_iterator_range(boost::vertices(m_voronoiGraph)))
-        stream << iter << ": " << toString(iter) << "\n";
+    return statistics;
 }
 
-VoronoiImpl::BlockGrid VoronoiImpl::buildBlockGrid(const std::set<BlockEdge>& edges, std::execution::sequenced_policy) const
+ContourSet VoronoiImpl::extractContours(const dpa::image::Image<dpa::image::YCbCr, stbi_uc>& image) const
 {
-    // O(nlog(n))
-    using namespace dpa::graph::utility;
+    ContourSet contours;
 
-    BlockGrid blocks;
-    for (std::size_t h = 0; h < m_height - 1ull; ++h)
-    {
-        std::vector<PixelBlock> row;
-        for (std::size_t w = 0; w < m_width - 1ull; ++w)
-        {
-            std::size_t topLeft = FlattenPoint<std::size_t>({ w, h }, m_width);
-            std::size_t topRight = FlattenPoint<std::size_t>({ w + 1, h }, m_width);
-            std::size_t bottomLeft = FlattenPoint<std::size_t>({ w, h + 1 }, m_width);
-            std::size_t bottomRight = FlattenPoint<std::size_t>({ w + 1, h + 1 }, m_width);
+    const std::size_t numVertices = boost::num_vertices(m_voronoiGraph);
+    if (!numVertices || image.getWidth() != m_width || image.getHeight() != m_height)
+        return contours;
 
-            PixelBlock block = buildBlock({ topLeft, topRight, bottomLeft, bottomRight }, edges);
-            row.push_back(block);
-        }
+    trace::TraceSpan span{ "extractContours", "voronoi" };
 
-        blocks.push_back(row);
-    }
+    const stbi_uc* pixels = image.getData();
+    const std::size_t numChannels = image.getChannels();
 
-    return blocks;
-}
+    const auto classify = [&](const EdgeProperty& property)
+    {
+        const stbi_uc* first = pixels + property.firstPixel * numChannels;
+        const stbi_uc* second = pixels + property.secondPixel * numChannels;
 
-PixelBlock VoronoiImpl::buildBlock(const std::tuple<std::size_t, std::size_t, std::size_t, std::size_t>& vertices,
-                                   const std::set<BlockEdge>& edges) const noexcept
-{
-    using namespace dpa::graph::utility;
+        int distance = 0;
+        for (std::size_t channel = 0; channel < 3; ++channel)
+        {
+            const int delta = first[channel] - second[channel];
+            distance += delta * delta;
+        }
 
-    const auto [TL, TR, BL, BR] = vertices;
-    const auto GetEdge = [&](auto s, auto t) -> std::optional<BlockEdge>
-    {
-        return edges.find({ s, t }) != std::end(edges) || edges.find({ t, s }) != std::end(edges) ?
-            std::make_optional(BlockEdge{ s, t }) : std::nullopt;
+        return distance > k_visibleContourThreshold * k_visibleContourThreshold ? ContourType::eVisible : ContourType::eShading;
     };
 
-    return
+    // Gather the edges on contours, counting how many of them meet at each vertex
+    struct ContourEdge
     {
-        GetEdge(TL, BL),
-        GetEdge(TR, BR),
-        GetEdge(TL, TR),
-        GetEdge(BL, BR),
-        GetEdge(BL, TR),
-        GetEdge(TL, BR),
+        std::size_t source{ 0 };
+        std::size_t target{ 0 };
+        ContourType type{ ContourType::eVisible };
     };
-}
 
-VoronoiImpl::Graph VoronoiImpl::buildVoronoiGraph(const BlockGrid& blocks, std::execution::sequenced_policy) const
-{
-    WeldMap weldPoints;
+    const auto graphEdges = boost::make_iterator_range(boost::edges(m_voronoiGraph));
+    const auto numContourEdges = std::count_if(std::cbegin(graphEdges), std::cend(graphEdges), [&](const auto& edge)
+    {
+        return !m_voronoiGraph[edge].isConnected;
+    });
+
+    // Counted first, so the arena only ever holds one copy of the contour edges
+    memory::ArenaVector<ContourEdge> contourEdges{ m_resource };
+    contourEdges.reserve(static_cast<std::size_t>(numContourEdges));
 
-    std::vector<std::vector<VoronoiConfig>> disjointVoronoi;
-    for (auto h = 0; h < blocks.size(); ++h)
+    memory::ArenaVector<std::size_t> firstIncident(numVertices + 1, 0, m_resource);
+
+    for (const auto edge : graphEdges)
     {
-        std::vector<VoronoiConfig> row;
-        for (auto w = 0; w < blocks.front().size(); ++w)
-        {
-            auto [config, points] = getVoronoiCellConfiguration(blocks[h][w]);
-            row.push_back({ config, points });
-        }
+        const auto& property = m_voronoiGraph[edge];
+        if (property.isConnected)
+            continue;
+
+        const std::size_t source = boost::source(edge, m_voronoiGraph);
+        const std::size_t target = boost::target(edge, m_voronoiGraph);
 
-        disjointVoronoi.push_back(row);
+        contourEdges.push_back({ source, target, classify(property) });
+        ++firstIncident[source + 1];
+        ++firstIncident[target + 1];
     }
 
-    return WeldAsync(disjointVoronoi);
-}
+    if (contourEdges.empty())
+        return contours;
 
-VoronoiImpl::VoronoiConfig VoronoiImpl::getVoronoiCellConfiguration(const PixelBlock& block) const
-{
-    std::string edgeConfig = block.serialize();
-    static const auto pred = [&](auto config) { return config == edgeConfig; };
-    
-    static const std::array<std::string, 4> triangleConfigs =
+    // Lay the edges at each vertex out contiguously, so the walk never searches for them
+    std::partial_sum(std::cbegin(firstIncident), std::cend(firstIncident), std::begin(firstIncident));
+
+    memory::ArenaVector<std::size_t> incident(2 * contourEdges.size(), m_resource);
     {
-        "lb[bD]", "rb[fD]", "lt[fD]", "rt[bD]"
-    };
+        memory::ArenaVector<std::size_t> next(std::cbegin(firstIncident), std::cend(firstIncident) - 1, m_resource);
+        for (std::size_t edge = 0; edge < contourEdges.size(); ++edge)
+        {
+            incident[next[contourEdges[edge].source]++] = edge;
+            incident[next[contourEdges[edge].target]++] = edge;
+        }
+    }
 
-    static const std::array<std::string, 2> diagonalConfigs =
+    // A contour carries on through a vertex only when it's the sole contour there
+    const auto isEndpoint = [&](std::size_t vertex)
     {
-        "[fD]", "[bD]"
+        const std::size_t first = firstIncident[vertex];
+        if (firstIncident[vertex + 1] - first != 2)
+            return true;
+
+        return contourEdges[incident[first]].type != contourEdges[incident[first + 1]].type;
     };
- 
-    if (Searchable{ triangleConfigs }.has(edgeConfig))
-        return getConfiguration(block, TriangleTag{});
-    else if (Searchable{ diagonalConfigs }.has(edgeConfig))
-        return getConfiguration(block, DiagonalTag{});
-    
-    return getConfiguration(block, DefaultTag{});
-}
 
-VoronoiImpl::VoronoiConfig VoronoiImpl::getConfiguration(const PixelBlock& block, DefaultTag) const noexcept
-{
-    /*
-            *   
-            |
-        *---*---*
-            |
-            *
-    */
+    memory::ArenaVector<bool> visited(contourEdges.size(), false, m_resource);
 
-    // Edge configuration is centered at 0, 0, then translated into position
-    static const std::array<Point2D<double>, 5> pointCache =
+    const auto addPoint = [&](std::size_t vertex)
     {
-        Point2D<double>{k_doubleMin, -.5},
-        Point2D<double>{-.5, k_doubleMin},
-        Point2D<double>{k_doubleMin, k_doubleMin},
-        Point2D<double>{.5, k_doubleMin},
-        Point2D<double>{k_doubleMin, .5},
+        contours.coordinates.push_back(m_voronoiGraph[vertex].x);
+        contours.coordinates.push_back(m_voronoiGraph[vertex].y);
     };
 
-    if (auto parameters = getTransformParameters(block, DefaultTag{}); parameters)
+    // Follows a contour from a vertex along one of its edges, until it reaches
+    // an endpoint, or comes back around to an edge it's already been down
+    const auto walk = [&](std::size_t vertex, std::size_t edge)
     {
-        std::vector<Point2D<double>> ret;
-        std::transform(std::cbegin(pointCache), std::cend(pointCache), std::back_inserter(ret),
-            [=](const auto& point)
-            {
-                return transformPoint(point, parameters.value());
-            });
+        addPoint(vertex);
+        contours.types.push_back(contourEdges[edge].type);
 
-        Graph graph{ 5 };
-
-        boost::add_edge(0, 2, graph);
-        boost::add_edge(1, 2, graph);
-        boost::add_edge(2, 3, graph);
-        boost::add_edge(2, 4, graph);
+        while (true)
+        {
+            visited[edge] = true;
 
-        for (auto i = 0; i < pointCache.size(); ++i)
-            std::tie(graph[i].x, graph[i].y) = AsTuple(ret.at(i));
+            const auto& current = contourEdges[edge];
+            vertex = current.source == vertex ? current.target : current.source;
+            addPoint(vertex);
 
-        WeldMap points;
-        points.insert({ std::make_tuple(graph[0].x, graph[0].y), 0 });
-        points.insert({ std::make_tuple(graph[1].x, graph[1].y), 1 });
-        points.insert({ std::make_tuple(graph[3].x, graph[3].y), 3 });
-        points.insert({ std::make_tuple(graph[4].x, graph[4].y), 4 });
+            if (isEndpoint(vertex))
+                break;
 
-        return { graph, points };
-    }
+            const std::size_t first = firstIncident[vertex];
+            edge = incident[first] == edge ? incident[first + 1] : incident[first];
 
-    return { Graph{ 0 }, WeldMap{} };
-}
+            if (visited[edge])
+                break;
+        }
 
-VoronoiImpl::VoronoiConfig VoronoiImpl::getConfiguration(const PixelBlock& block, TriangleTag) const noexcept
-{
-    // Edge configuration is centered at 0, 0, then translated into position
-    static const std::array<Point2D<double>, 6> pointCache =
-    {
-        Point2D<double>{k_doubleMin, -.5},
-        Point2D<double>{.25, -.25},
-        Point2D<double>{-.5, k_doubleMin},
-        Point2D<double>{k_doubleMin, k_doubleMin},
-        Point2D<double>{.5, k_doubleMin},
-        Point2D<double>{k_doubleMin, .5}
+        contours.offsets.push_back(contours.getNumPoints());
     };
 
-    if (auto parameters = getTransformParameters(block, TriangleTag{}); parameters)
+    // Open contours start and end at endpoints. Whatever's left over are closed loops
+    for (std::size_t vertex = 0; vertex < numVertices; ++vertex)
     {
-        std::vector<Point2D<double>> ret;
-        std::transform(std::cbegin(pointCache), std::cend(pointCache), std::back_inserter(ret),
-            [=](const auto& point)
-            {
-                return transformPoint(point, parameters.value());
-            });
-
-        Graph graph{ 6 };
+        if (!isEndpoint(vertex))
+            continue;
 
-        boost::add_edge(0, 1, graph);
-        boost::add_edge(2, 3, graph);
-        boost::add_edge(3, 1, graph);
-        boost::add_edge(1, 4, graph);
-        boost::add_edge(3, 5, graph);
-
-        for (auto i = 0; i < pointCache.size(); ++i)
-            std::tie(graph[i].x, graph[i].y) = AsTuple(ret.at(i));
-
-        WeldMap points;
-        points.insert({ std::make_tuple(graph[0].x, graph[0].y), 0 });
-        points.insert({ std::make_tuple(graph[2].x, graph[2].y), 2 });
-        points.insert({ std::make_tuple(graph[4].x, graph[4].y), 4 });
-        points.insert({ std::make_tuple(graph[5].x, graph[5].y), 5 });
+        for (std::size_t i = firstIncident[vertex]; i < firstIncident[vertex + 1]; ++i)
+        {
+            if (!visited[incident[i]])
+                walk(vertex, incident[i]);
+        }
+    }
 
-        return { graph, points };
+    for (std::size_t edge = 0; edge < contourEdges.size(); ++edge)
+    {
+        if (!visited[edge])
+            walk(contourEdges[edge].source, edge);
     }
 
-    return { Graph{ 0 }, WeldMap{} };
+    return contours;
 }
 
-VoronoiImpl::VoronoiConfig VoronoiImpl::getConfiguration(const PixelBlock& block, DiagonalTag) const noexcept
+bool VoronoiImpl::writeTex(std::ostream& output)
 {
-    // Edge configuration is centered at 0, 0, then translated into position
-    static const std::array<Point2D<double>, 7> pointCache =
-    {
-        Point2D<double>{k_doubleMin, -.5},
-        Point2D<double>{-.25, -.25},
-        Point2D<double>{-.5, k_doubleMin},
-        Point2D<double>{k_doubleMin, k_doubleMin},
-        Point2D<double>{.5, k_doubleMin},
-        Point2D<double>{.25, .25},
-        Point2D<double>{k_doubleMin, .5},
-    };
+    auto strategy = VoronoiVisualizationStrategy<Graph>{};
+    auto visualizer = dpa::graph::internal::LaTeXGraphVisualizer<Graph>{ strategy };
 
-    if (auto parameters = getTransformParameters(block, DiagonalTag{}); parameters)
-    {
-        std::vector<Point2D<double>> ret;
-        std::transform(std::cbegin(pointCache), std::cend(pointCache), std::back_inserter(ret),
-            [=](const auto& point)
-            {
-                return transformPoint(point, parameters.value());
-            });
+    return visualizer.writeTex(m_voronoiGraph, std::make_tuple(m_width, m_height), output);
+}
 
-        Graph graph{ 7 };
+void VoronoiImpl::printGraph(std::ostream& stream)
+{
+    boost::print_graph(m_voronoiGraph, boost::get(boost::vertex_index, m_voronoiGraph), stream);
+}
 
-        boost::add_edge(0, 1, graph);
-        boost::add_edge(1, 2, graph);
-        boost::add_edge(1, 3, graph);
-        boost::add_edge(3, 5, graph);
-        boost::add_edge(5, 4, graph);
-        boost::add_edge(6, 5, graph);
+void VoronoiImpl::printVertices(std::ostream& stream)
+{
+    const auto toString = [&](auto vertexDescriptor)
+    {
+        auto x = std::to_string(m_voronoiGraph[vertexDescriptor].x);
+        auto y = std::to_string(m_voronoiGraph[vertexDescriptor].y);
 
-        for(auto i = 0; i < pointCache.size(); ++i)
-            std::tie(graph[i].x, graph[i].y) = AsTuple(ret.at(i));
+        return "(" + x + ", " + y + ")";
+    };
 
-        WeldMap points;
-        points.insert({ std::make_tuple(graph[0].x, graph[0].y), 0 });
-        points.insert({ std::make_tuple(graph[2].x, graph[2].y), 2 });
-        points.insert({ std::make_tuple(graph[4].x, graph[4].y), 4 });
-        points.insert({ std::make_tuple(graph[6].x, graph[6].y), 6 });
+    for (auto iter : boost::make_iterator_range(boost::vertices(m_voronoiGraph)))
+        stream << iter << ": " << toString(iter) << "\n";
+}
 
-        return { graph, points };
-    }
+BlockGrid VoronoiImpl::buildBlockGrid(const std::vector<std::uint8_t>& neighbourMasks, std::execution::sequenced_policy) const
+{
+    // O(n)
+    BlockGrid blocks{ m_width - 1ull, m_height - 1ull, m_resource };
+    for (std::size_t h = 0; h < blocks.getHeight(); ++h)
+        buildBlockRow(neighbourMasks, h, blocks);
 
-    return { Graph{ 0 }, WeldMap{} };
+    return blocks;
 }
 
-Point2D<double> VoronoiImpl::transformPoint(const Point2D<double>& point, TransformParameters parameters) const noexcept
+BlockGrid VoronoiImpl::buildBlockGrid(const std::vector<std::uint8_t>& neighbourMasks, std::execution::parallel_policy) const
 {
-    using namespace boost::geometry::strategy;
+    BlockGrid blocks{ m_width - 1ull, m_height - 1ull, m_resource };
 
-    Point2D<double> transformed;
+    memory::ArenaVector<std::size_t> rows(blocks.getHeight(), m_resource);
+    std::iota(std::begin(rows), std::end(rows), 0);
 
-    // Each point is contained within a 1x1 box that's rotated about the origin.
-    // I need to translate the box back into the first quadrant, which is the
-    // screen space the image is rendered in (top left is 0, 0)
-    constexpr double offset = .5;
+    std::for_each(std::execution::par, std::cbegin(rows), std::cend(rows), [&](std::size_t h)
+        {
+            buildBlockRow(neighbourMasks, h, blocks);
+        });
 
-    transform::rotate_transformer<boost::geometry::degree, double, 2, 2> rotate(parameters.theta);
-    transform::translate_transformer<double, 2, 2> translate(parameters.deltaX + offset, parameters.deltaY + offset);
+    return blocks;
+}
 
-    boost::geometry::transform(point, transformed, rotate);
-    boost::geometry::transform(transformed, transformed, translate);
+BlockGrid VoronoiImpl::buildBlockGrid(const std::vector<std::uint8_t>& neighbourMasks, std::execution::parallel_unsequenced_policy) const
+{
+    BlockGrid blocks{ m_width - 1ull, m_height - 1ull, m_resource };
 
-    auto round = [](auto value, auto radixPoint)
-    {
-        const auto radixOffset = std::pow(10, radixPoint);
+    memory::ArenaVector<std::size_t> rows(blocks.getHeight(), m_resource);
+    std::iota(std::begin(rows), std::end(rows), 0);
 
-        value *= radixOffset;
-        value = std::round(value);
-        value /= radixOffset;
+    std::for_each(std::execution::par_unseq, std::cbegin(rows), std::cend(rows), [&](std::size_t h)
+        {
+            buildBlockRow(neighbourMasks, h, blocks);
+        });
 
-        return value;
-    };
+    return blocks;
+}
 
-    auto value1 = boost::geometry::get<0>(transformed);
-    auto value2 = boost::geometry::get<1>(transformed);
+void VoronoiImpl::buildBlockRow(const std::vector<std::uint8_t>& neighbourMasks, std::size_t h, BlockGrid& blocks) const noexcept
+{
+    using dpa::graph::internal::LatticeDirection;
 
-    boost::geometry::set<0>(transformed, round(value1, 2));
-    boost::geometry::set<1>(transformed, round(value2, 2));
+    const std::uint8_t* top = neighbourMasks.data() + h * m_width;
+    const std::uint8_t* bottom = top + m_width;
 
-    return transformed;
+    for (std::size_t w = 0; w < blocks.getWidth(); ++w)
+    {
+        const std::uint8_t topLeft = top[w];
+        const std::uint8_t topRight = top[w + 1];
+        const std::uint8_t bottomLeft = bottom[w];
+
+        blocks.at(w, h).code =
+            MaskToEdge(topLeft, LatticeDirection::eSouth, PixelBlock::kLeft) |
+            MaskToEdge(topRight, LatticeDirection::eSouth, PixelBlock::kRight) |
+            MaskToEdge(topLeft, LatticeDirection::eEast, PixelBlock::kTop) |
+            MaskToEdge(bottomLeft, LatticeDirection::eEast, PixelBlock::kBottom) |
+            MaskToEdge(topRight, LatticeDirection::eSouthWest, PixelBlock::kForwardDiagonal) |
+            MaskToEdge(topLeft, LatticeDirection::eSouthEast, PixelBlock::kBackDiagonal);
+    }
 }
 
-std::optional<VoronoiImpl::TransformParameters> VoronoiImpl::getTransformParameters(const dpa::voronoi::internal::PixelBlock& block, DefaultTag) const noexcept
+std::vector<std::uint8_t> VoronoiImpl::buildNeighbourMasks(const std::set<BlockEdge>& edges) const
 {
-    const auto [x, y] = GetReferencePoint(block, m_width);
+    using namespace dpa::graph::internal;
 
-    if (block.left)
-        return TransformParameters{ 0, x, y };
+    const std::size_t width = m_width;
+    const std::size_t numPixels = width * m_height;
 
-    if (block.top)
-        return TransformParameters{ 0, x, y };
+    std::vector<std::uint8_t> masks(numPixels, 0);
+    for (const auto& [source, target] : edges)
+    {
+        if (source >= numPixels || target >= numPixels)
+            continue;
 
-    if (block.right)
-        return TransformParameters{ 0, std::max(x, x - 1), y };
+        const auto dx = static_cast<long long>(target % width) - static_cast<long long>(source % width);
+        const auto dy = static_cast<long long>(target / width) - static_cast<long long>(source / width);
 
-    if (block.bottom)
-        return TransformParameters{ 0, x, std::max(y, y - 1) };
+        for (std::uint8_t bits = 0; bits < 8; ++bits)
+        {
+            const auto direction = static_cast<LatticeDirection>(bits);
+            if (DirectionOffset(direction) != std::make_tuple(dx, dy))
+                continue;
 
-    return std::nullopt;
+            masks[source] |= static_cast<std::uint8_t>(1 << bits);
+            masks[target] |= static_cast<std::uint8_t>(1 << static_cast<std::uint8_t>(Opposite(direction)));
+            break;
+        }
+    }
+
+    return masks;
 }
 
-std::optional<VoronoiImpl::TransformParameters> VoronoiImpl::getTransformParameters(const dpa::voronoi::internal::PixelBlock& block, DiagonalTag) const noexcept
+VoronoiImpl::Graph VoronoiImpl::buildVoronoiGraph(const BlockGrid& blocks, std::execution::sequenced_policy) const
 {
-    const auto [x, y] = GetReferencePoint(block, m_width);
+    memory::ArenaVector<CellBand> bands{ m_resource };
+    bands.push_back(layoutCells(blocks, 0, blocks.getHeight()));
 
-    if (block.forwardDiagonal)
-        return TransformParameters{ 0, x, y };
+    return weldCells(bands);
+}
 
-    if (block.backDiagonal)
-        return TransformParameters{ 90, x, y };
+VoronoiImpl::Graph VoronoiImpl::buildVoronoiGraph(const BlockGrid& blocks, std::execution::parallel_policy) const
+{
+    const auto rowBands = PartitionRows(blocks.getHeight());
 
-    return std::nullopt;
+    memory::ArenaVector<CellBand> bands(rowBands.size(), m_resource);
+    std::transform(std::execution::par, std::cbegin(rowBands), std::cend(rowBands), std::begin(bands),
+        [&](const auto& rows)
+        {
+            return layoutCells(blocks, rows.first, rows.second);
+        });
+
+    return weldCells(bands);
 }
 
-std::optional<VoronoiImpl::TransformParameters> VoronoiImpl::getTransformParameters(const dpa::voronoi::internal::PixelBlock& block, TriangleTag) const noexcept
+VoronoiImpl::Graph VoronoiImpl::buildVoronoiGraph(const BlockGrid& blocks, std::execution::parallel_unsequenced_policy) const
 {
-    /*
-          *
-          |\
-          | \
-          *--*
-    */
-    const auto [x, y] = GetReferencePoint(block, m_width);
-
-    if (block.left && block.bottom && block.backDiagonal)
-        return TransformParameters{ 0, x, y };
-
-    /*
-        *--*
-        | /
-        |/
-        *
-    */
-    else if (block.left && block.top && block.forwardDiagonal)
-        return TransformParameters{ 270, x, y };
-
-    /*
-        *--*
-         \ |
-          \|
-           *
-    */
-    else if (block.right && block.top && block.backDiagonal)
-        return TransformParameters{ 180, x, y };
-
-    /*
-           *
-          /|
-         / |
-        *--*
-    */
-    else if (block.right && block.bottom && block.forwardDiagonal)
-        return TransformParameters{ 90, x, y };
-
-    return std::nullopt;
+    return buildVoronoiGraph(blocks, std::execution::par);
 }
 
-VoronoiImpl::Graph VoronoiImpl::WeldAsync(const std::vector<std::vector<VoronoiConfig>>& disjointVoronoi) const noexcept
+VoronoiImpl::CellBand VoronoiImpl::layoutCells(const BlockGrid& blocks, std::size_t firstRow, std::size_t lastRow) const
 {
-    // Initial value
-    VoronoiConfig voronoiConfig{ Graph{0}, WeldMap{} };
-    auto combining = [&](auto init, auto rhs)
-    {
-        return WeldGraphs(init, rhs);
-    };
-
-    auto combineRow = [&](auto row)
-    {
-        return std::reduce(std::execution::par_unseq, std::begin(row), std::end(row),
-            voronoiConfig, combining);
-    };
+    using namespace boost::geometry::strategy;
 
-    // This will combine all of the graphs into one, by reducing all the rows
-    // first, then reducing the remaining column
-    auto [graph, welds] = std::transform_reduce(std::execution::par_unseq,
-        std::begin(disjointVoronoi), std::end(disjointVoronoi), voronoiConfig, combining, combineRow);
+    const auto& cells = GetVoronoiCellTemplates();
 
-    std::set<Vertex> removedVertices;
-    for (auto vertex : boost::make_iterator_range(boost::vertices(graph)))
+    auto round = [](auto value, auto radixPoint)
     {
-        if (!boost::in_degree(vertex, graph))
-            removedVertices.insert(vertex);
-    }
+        const auto radixOffset = std::pow(10, radixPoint);
 
-    long vertexOffset = 0;
-    for (auto vertex : removedVertices)
-    {
-        boost::remove_vertex(vertex + vertexOffset, graph);
+        value *= radixOffset;
+        value = std::round(value);
+        value /= radixOffset;
 
-        // we need to decrement the vertex count since the
-        // other vertices do not get updated as removals occur
-        --vertexOffset;
-    }
+        return value;
+    };
 
-    return graph;
-}
+    // Border points sit on the half-pixel lattice
+    const std::size_t weldRowSize = 2 * (m_width - 1ull) + 1;
 
-VoronoiImpl::VoronoiConfig VoronoiImpl::WeldGraphs(const VoronoiConfig& init, const VoronoiConfig& rhs) const noexcept
-{
-    auto [initGraph, initWelds] = init;
-    auto [rhsGraph, rhsWelds] = rhs;
+    CellBand band{ memory::ArenaVector<VertexProperty>{ m_resource }, memory::ArenaVector<PlacedCell>{ m_resource } };
 
-    const auto debugWelds = [](auto graph, int width, int height)
+    // The arena never reclaims what a growing vector leaves behind, so count
+    // what the band's block codes lay out first, and allocate it exactly once
+    std::size_t numCells = 0;
+    std::size_t numPoints = 0;
+    for (std::size_t h = firstRow; h < lastRow; ++h)
     {
-        static int ID = 0;
-        std::filesystem::path dest{ "C:/Users/Brian/Desktop/graph/WeldDebug" };
-
-        auto strategy = VoronoiVisualizationStrategy<decltype(graph)>{};
-        auto visualizer = dpa::graph::internal::LaTeXGraphVisualizer<decltype(graph)>{ strategy };
-
-        dest += "/Block_";
-        dest += std::to_string(ID++);
-        dest += ".tex";
-
-        std::ofstream output{ dest };
-
-        if (output.is_open())
-            return visualizer.writeTex(graph, std::make_tuple(width, height), output);
+        for (std::size_t w = 0; w < blocks.getWidth(); ++w)
+        {
+            const auto& cell = cells[blocks.at(w, h).code];
+            numCells += cell.numPoints ? 1 : 0;
+            numPoints += cell.numPoints;
+        }
+    }
 
-        return false;
-    };
+    band.points.reserve(numPoints);
+    band.cells.reserve(numCells);
 
-    // Combined graph, which contains the merge between init and rhs
-    Graph welded{ boost::num_vertices(initGraph) + boost::num_vertices(rhsGraph) };
+    for (std::size_t h = firstRow; h < lastRow; ++h)
+    {
+        for (std::size_t w = 0; w < blocks.getWidth(); ++w)
+        {
+            const auto code = blocks.at(w, h).code;
+            const auto& cell = cells[code];
+            if (!cell.numPoints)
+                continue;
+
+            // Each cell is contained within a 1x1 box centered at the origin. I need to translate
+            // the box into the block's position in screen space (top left is 0, 0)
+            constexpr double offset = .5;
+            transform::translate_transformer<double, 2, 2> translate(w + offset, h + offset);
+
+            PlacedCell placed{ code, band.points.size(), h * m_width + w };
+            for (std::size_t i = 0; i < cell.numPoints; ++i)
+            {
+                Point2D<double> transformed;
+                boost::geometry::transform(cell.points[i], transformed, translate);
 
-    // The init graph is what everything is being accumulated into,
-    // and its vertex descriptors will already be correct. Do not
-    // offset those vertices when copying the graph
-    boost::depth_first_search(initGraph, boost::visitor(GraphCopier{ welded, 0 }));
+                band.points.push_back({ round(boost::geometry::get<0>(transformed), 2),
+                                        round(boost::geometry::get<1>(transformed), 2) });
+            }
 
-    // The rhs graph will be what we're folding into init, and will have
-    // vertex descriptors in local space. These need to be offset by the
-    // number of nodes in the init graph
-    boost::depth_first_search(rhsGraph, boost::visitor(GraphCopier{ welded, boost::num_vertices(initGraph) }));
+            for (std::size_t i = 0; i < cell.welds.size(); ++i)
+            {
+                const auto& point = band.points[placed.base + cell.welds[i]];
 
-    debugWelds(initGraph, static_cast<int>(boost::num_vertices(initGraph)), static_cast<int>(boost::num_vertices(initGraph)));
-    debugWelds(rhsGraph, static_cast<int>(boost::num_vertices(rhsGraph)), static_cast<int>(boost::num_vertices(rhsGraph)));
+                // Snap the point to the lattice, where half-pixel positions are every other step
+                const auto latticeX = std::lround(point.x * k_latticeScale) / 2;
+                const auto latticeY = std::lround(point.y * k_latticeScale) / 2;
 
-    // Perform any welds that need to happen to ensure connectivity between components
-    WeldVertices(welded, boost::num_vertices(initGraph), initWelds, rhsWelds);
-    
-    // update the RHS vertices by an offset to ensure they're
-    // correct when performing merges across rows
-    for (auto& [point, vertex] : rhsWelds)
-        vertex += boost::num_vertices(initGraph);
+                placed.weldSlots[i] = latticeY * weldRowSize + latticeX;
+            }
 
-    // Fold the weld points together
-    WeldMap weldPoints{ initWelds };
-    weldPoints.merge(rhsWelds);
+            band.cells.push_back(placed);
+        }
+    }
 
-    return { welded, weldPoints };
+    return band;
 }
 
-void VoronoiImpl::WeldVertices(Graph& dest, std::size_t vertexOffset, const WeldMap& lhsWelds, const WeldMap& rhsWelds) const noexcept
+VoronoiImpl::Graph VoronoiImpl::weldCells(const memory::ArenaVector<CellBand>& bands) const
 {
-    // Comparator to check if one weld point is smaller than the other
-    auto less = [](auto lhs, auto rhs) { return lhs.first < rhs.first; };
+    const auto& cells = GetVoronoiCellTemplates();
+
+    // Each border point is shared by at most two cells. The grid holds the first point found at each position
+    constexpr std::size_t noVertex = std::numeric_limits<std::size_t>::max();
+    const std::size_t weldRowSize = 2 * (m_width - 1ull) + 1;
+    memory::ArenaVector<std::size_t> weldGrid(weldRowSize * (2 * (m_height - 1ull) + 1), noVertex, m_resource);
+
+    // Size everything up front, since the arena can't reuse what a growing vector gives back.
+    // Every cell edge is kept, and at most one edge is added for each pair of welded points
+    std::size_t numPoints = 0;
+    std::size_t numEdges = 0;
+    std::size_t numWelds = 0;
+    for (const auto& band : bands)
+    {
+        numPoints += band.points.size();
+        for (const auto& placed : band.cells)
+        {
+            numEdges += cells[placed.code].numEdges;
+            numWelds += cells[placed.code].welds.size();
+        }
+    }
 
-    WeldMap mutualPoints;
+    memory::ArenaVector<std::tuple<std::size_t, std::size_t, EdgeProperty>> edges{ m_resource };
+    edges.reserve(numEdges + numWelds / 2);
 
-    // O(n)
-    std::set_intersection(std::cbegin(rhsWelds), std::cend(rhsWelds),
-                          std::cbegin(lhsWelds), std::cend(lhsWelds),
-                          std::inserter(mutualPoints, std::begin(mutualPoints)), less);
+    // The interior point each border point is connected to, and whether it was welded away
+    memory::ArenaVector<std::size_t> anchors(numPoints, noVertex, m_resource);
+    memory::ArenaVector<bool> welded(numPoints, false, m_resource);
 
-    for (const auto [rhsPoint, rhsVertex] : mutualPoints)
+    // The bands' points are numbered one after another, in the order the bands were laid out
+    std::size_t bandBase = 0;
+    for (const auto& band : bands)
     {
-        if (auto lhsEntry = lhsWelds.find(rhsPoint); lhsEntry != std::end(lhsWelds))
+        for (const auto& placed : band.cells)
         {
-            const auto [lhsPoint, lhsVertex] = *lhsEntry;
-            if (boost::in_degree(rhsVertex + vertexOffset, dest) != 2)
+            const auto& cell = cells[placed.code];
+            const std::size_t base = bandBase + placed.base;
+
+            // The pixels either side of each edge, which a welded edge
+            // shares with the border edges it replaces
+            std::array<EdgeProperty, VoronoiCellTemplate::kMaxEdges> properties;
+            for (std::size_t i = 0; i < cell.numEdges; ++i)
             {
-                assert(false);
-                break;
+                const auto [first, second] = cell.edgeCorners[i];
+
+                properties[i].firstPixel = placed.topLeft + (first >> 1) * m_width + (first & 1);
+                properties[i].secondPixel = placed.topLeft + (second >> 1) * m_width + (second & 1);
+                properties[i].isConnected = PixelBlock{ placed.code }.has(CornerEdge(first, second));
+
+                edges.emplace_back(base + std::get<0>(cell.edges[i]), base + std::get<1>(cell.edges[i]), properties[i]);
+            }
+
+            for (std::size_t i = 0; i < cell.welds.size(); ++i)
+            {
+                const std::size_t vertex = base + cell.welds[i];
+                anchors[vertex] = base + cell.weldAnchors[i];
+
+                auto& slot = weldGrid[placed.weldSlots[i]];
+                if (slot == noVertex)
+                {
+                    slot = vertex;
+                    continue;
+                }
+
+                // The two cells meet here, so the shared points are cut out, and
+                // the points they were connected to are joined instead
+                welded[slot] = true;
+                welded[vertex] = true;
+                edges.emplace_back(anchors[slot], anchors[vertex], properties[cell.weldEdges[i]]);
             }
+        }
 
-            auto [s1, e1] = boost::in_edges(rhsVertex + vertexOffset, dest);
-            auto t1 = boost::source(*s1, dest);
+        bandBase += band.points.size();
+    }
 
-            auto [s2, e2] = boost::in_edges(lhsVertex, dest);
-            auto t2 = boost::source(*s2, dest);
+    // Compact the remaining points, keeping the order they were laid out in
+    memory::ArenaVector<std::size_t> remap(numPoints, noVertex, m_resource);
+    std::size_t numVertices = 0;
+    for (std::size_t vertex = 0; vertex < numPoints; ++vertex)
+    {
+        if (!welded[vertex])
+            remap[vertex] = numVertices++;
+    }
 
-            boost::clear_vertex(rhsVertex + vertexOffset, dest);
-            boost::clear_vertex(lhsVertex, dest);
+    Graph graph{ numVertices };
+    std::size_t vertex = 0;
+    for (const auto& band : bands)
+    {
+        for (const auto& point : band.points)
+        {
+            if (!welded[vertex])
+                graph[remap[vertex]] = point;
 
-            boost::add_edge(t1, t2, dest);
-            boost::add_edge(t2, t1, dest);
+            ++vertex;
         }
     }
+
+    for (const auto& [source, target, property] : edges)
+    {
+        if (!welded[source] && !welded[target])
+            boost::add_edge(remap[source], remap[target], property, graph);
+    }
+
+    return graph;
 }
 }
@@ -1,6 +1,12 @@
 #pragma once
 
+#include <RunArena.h>
+#include <Voronoi.h>
+
+#include <array>
+#include <cstdint>
 #include <execution>
+#include <memory_resource>
 #include <optional>
 #include <set>
 #include <tuple>
@@ -28,7 +34,8 @@ using BlockEdge = std::tuple<std::size_t, std::size_t>;
 
 /*
     Represents the edge configuration of a 2x2 block
-    of pixels in a similarity graph
+    of pixels in a similarity graph, as a 6-bit block code.
+    The edges' endpoints are implied by where the block is
 
     o---o
     | X |
@@ -36,59 +43,116 @@ using BlockEdge = std::tuple<std::size_t, std::size_t>;
 */
 struct PixelBlock
 {
-    std::optional<BlockEdge> left;
-    std::optional<BlockEdge> right;
-    std::optional<BlockEdge> top;
-    std::optional<BlockEdge> bottom;
-    std::optional<BlockEdge> forwardDiagonal;
-    std::optional<BlockEdge> backDiagonal;
-
-    std::string serialize() const noexcept;
-};
+    // The bits of a block code, one for each edge the block can contain
+    static constexpr std::uint8_t kLeft = 1 << 0;
+    static constexpr std::uint8_t kRight = 1 << 1;
+    static constexpr std::uint8_t kTop = 1 << 2;
+    static constexpr std::uint8_t kBottom = 1 << 3;
+    static constexpr std::uint8_t kForwardDiagonal = 1 << 4;
+    static constexpr std::uint8_t kBackDiagonal = 1 << 5;
 
-struct PixelBlockLeftTag {};
-struct PixelBlockRightTag {};
-struct PixelBlockTopTag {};
-struct PixelBlockBottomTag {};
-struct PixelBlockForwardDiagonalTag {};
-struct PixelBlockBackDiagonalTag {};
+    // The number of distinct block codes
+    static constexpr std::size_t kNumCodes = 1 << 6;
 
-template<typename... Handlers>
-struct PixelBlockDispatcher : Handlers...
-{
-    using Handlers::operator()...;
+    std::uint8_t code{ 0 };
+
+    /*
+        Checks if the block contains the given edge
+
+        @param edge One of the k* edge bits
+        @returns True if the edge is in the block, false otherwise
+    */
+    constexpr bool has(std::uint8_t edge) const noexcept { return (code & edge) != 0; }
 };
 
-template<typename... Handlers>
-PixelBlockDispatcher(Handlers...)->PixelBlockDispatcher<Handlers...>;
+static_assert(sizeof(PixelBlock) == 1, "Pixel blocks are stored a byte apiece");
 
-template<typename Method, typename Visitor>
-auto VisitPixelBlockEdges(const PixelBlock& block, Method method, Visitor visitor)
+/*
+    A flat, row-major grid of the 2x2 pixel blocks in an image. There's one
+    block between every four neighbouring pixels, so the grid is a block
+    smaller than the image in each dimension
+*/
+class BlockGrid
 {
-    if (block.left)
-        return method(block.left.value(), visitor, PixelBlockLeftTag{});
+public:
 
-    if (block.right)
-        return method(block.right.value(), visitor, PixelBlockRightTag{});
-    
-    if (block.top)
-        return method(block.top.value(), visitor, PixelBlockTopTag{});
-    
-    if (block.bottom)
-        return method(block.bottom.value(), visitor, PixelBlockBottomTag{});
-    
-    if (block.forwardDiagonal)
-        return method(block.forwardDiagonal.value(), visitor, PixelBlockForwardDiagonalTag{});
-    
-    if (block.backDiagonal)
-        return method(block.backDiagonal.value(), visitor, PixelBlockBackDiagonalTag{});
+    BlockGrid() = default;
+
+    /*
+        Creates a grid of empty blocks
+
+        @param width    The number of blocks in each row
+        @param height   The number of rows
+        @param resource The memory resource to allocate the blocks from
+    */
+    BlockGrid(std::size_t width, std::size_t height,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    PixelBlock& at(std::size_t w, std::size_t h) noexcept { return m_blocks[h * m_width + w]; }
+    const PixelBlock& at(std::size_t w, std::size_t h) const noexcept { return m_blocks[h * m_width + w]; }
+
+    std::size_t getWidth() const noexcept { return m_width; }
+    std::size_t getHeight() const noexcept { return m_height; }
+
+    /*
+        Reconstructs the endpoints of an edge in a block, as 1D pixel indices
 
-    return std::invoke_result_t<Method, BlockEdge, Visitor, PixelBlockLeftTag>{};
-}
+        @param w        The column of the block
+        @param h        The row of the block
+        @param edge     One of the k* edge bits
+
+        @returns The edge's endpoints if the block contains it, an empty optional otherwise
+    */
+    std::optional<BlockEdge> getEdge(std::size_t w, std::size_t h, std::uint8_t edge) const noexcept;
+
+private:
+
+    std::size_t m_width{ 0 };
+    std::size_t m_height{ 0 };
+
+    memory::ArenaVector<PixelBlock> m_blocks{};
+
+};
 
 template<typename T>
 using Point2D = boost::geometry::model::point<T, 2, boost::geometry::cs::cartesian>;
 
+/*
+    The canonical voronoi cell for one of the 64 block codes. The points are
+    already rotated into place around the block's center, so they only need
+    to be translated to the block's position in the image
+*/
+struct VoronoiCellTemplate
+{
+    static constexpr std::size_t kMaxPoints = 7;
+    static constexpr std::size_t kMaxEdges = 6;
+    static constexpr std::size_t kNumWelds = 4;
+
+    std::size_t numPoints{ 0 };
+    std::array<Point2D<double>, kMaxPoints> points{};
+
+    std::size_t numEdges{ 0 };
+    std::array<std::tuple<std::size_t, std::size_t>, kMaxEdges> edges{};
+
+    // The two corners of the block whose pixels' cells each edge runs between.
+    // The corners are numbered 0 to 3 in row-major order, and the lower comes first
+    std::array<std::tuple<std::uint8_t, std::uint8_t>, kMaxEdges> edgeCorners{};
+
+    // The points on the block's border, where it joins its neighbours, the point
+    // inside the cell each of them is connected to, and the edge between the two
+    std::array<std::size_t, kNumWelds> welds{};
+    std::array<std::size_t, kNumWelds> weldAnchors{};
+    std::array<std::size_t, kNumWelds> weldEdges{};
+};
+
+/*
+    Gets the voronoi cell for every block code. A block code without
+    a cell has no points. The table is built the first time it's used
+
+    @returns The cell templates, indexed by block code
+*/
+const std::array<VoronoiCellTemplate, PixelBlock::kNumCodes>& GetVoronoiCellTemplates();
+
 /*
     The implementation of a voronoi diagram
 */
@@ -96,12 +160,6 @@ class VoronoiImpl
 {
 public:
 
-    /*
-        This represents a 2D grid of PixelBlocks, which are explicit edge configurations
-        of a 2x2 chunk of a similarity graph
-    */
-    using BlockGrid = std::vector<std::vector<PixelBlock>>;
-
     /*
         The property stored for each vertex in the voronoi graph. Contains
         the x and y position of the node in screen-space
@@ -122,13 +180,24 @@ public:
         double y;
     };
 
-    using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS, VertexProperty, boost::no_property, GraphProperty>;
+    /*
+        The property stored for each edge in the voronoi graph. Every edge runs
+        between the cells of two neighbouring pixels, given as 1D pixel indices
+    */
+    struct EdgeProperty
+    {
+        std::size_t firstPixel{ 0 };
+        std::size_t secondPixel{ 0 };
+
+        // Whether the pixels are connected in the similarity graph. The edge
+        // is inside a region of the image if they are, and on a contour if not
+        bool isConnected{ false };
+    };
+
+    using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS, VertexProperty, EdgeProperty, GraphProperty>;
     
     using Edge = Graph::edge_descriptor;
     using Vertex = Graph::vertex_descriptor;
-    
-    using WeldMap = std::multimap<std::tuple<double, double>, Vertex>;
-    using VoronoiConfig = std::tuple<Graph, WeldMap>;
 
 public:
 
@@ -141,6 +210,16 @@ public:
     */
     void build(const std::set<BlockEdge>& edges) noexcept;
 
+    /*
+        Builds the voronoi diagram from the neighbour masks of a fully
+        resolved similarity graph
+
+        @param neighbourMasks   The adjacency of every pixel, in row-major order.
+                                Bit n of a mask is set when the pixel is connected
+                                in the LatticeDirection with an underlying value of n
+    */
+    void build(const std::vector<std::uint8_t>& neighbourMasks) noexcept;
+
     /*
         Sets the dimensions of the voronoi diagram
 
@@ -148,6 +227,41 @@ public:
     */
     void setDimensions(const std::tuple<int, int>& graphDims) noexcept;
 
+    /*
+        Sets the execution policy the voronoi diagram is built with
+
+        @param policy   The policy to build with
+    */
+    void setExecutionPolicy(ExecutionPolicy policy) noexcept { m_policy = policy; }
+
+    /*
+        Sets the memory resource the block grid and the build's scratch
+        storage are allocated from
+
+        @param resource The memory resource to allocate from
+    */
+    void setMemoryResource(std::pmr::memory_resource* resource) noexcept { m_resource = resource; }
+
+    /*
+        Gets counts describing the last diagram that was built. The welds
+        aren't tracked while building; every weld cuts two of the points the
+        cells were laid out with, so they're worked out from the block grid
+
+        @returns The diagram's statistics
+    */
+    VoronoiStatistics getStatistics() const noexcept;
+
+    /*
+        Extracts the contours of the last diagram that was built. The edges on
+        contours are gathered into a compact adjacency list in one pass over the
+        graph, which is then walked once, so this is linear in the size of the graph
+
+        @param image    The image the diagram was built from, in YCbCr
+
+        @returns The contours, or an empty set if the image doesn't match the diagram
+    */
+    ContourSet extractContours(const dpa::image::Image<dpa::image::YCbCr, stbi_uc>& image) const;
+
     /*
         Writes a .tex file to the given ostream. This can be compiled into
         a pdf using pdflatex
@@ -172,43 +286,23 @@ public:
     */
     void printVertices(std::ostream& stream);
 
-private:
-
     /*
         Dispatcher for building the block grid with the specified execution policy
 
         @tparam ExecutionPolicy The type of the policy to build the block grid with
 
-        @param policy   The policy to build the block grid with
-        @param edges    The list of edges from a resolved similarity graph
+        @param policy           The policy to build the block grid with
+        @param neighbourMasks   The adjacency of every pixel in a resolved similarity graph
 
         @returns The fully build block grid
     */
     template<typename ExecutionPolicy>
-    auto dispatchGridBuilder(ExecutionPolicy policy, const std::set<BlockEdge>& edges)
+    auto dispatchGridBuilder(ExecutionPolicy policy, const std::vector<std::uint8_t>& neighbourMasks)
         -> std::enable_if_t<std::is_execution_policy_v<ExecutionPolicy>, BlockGrid>
     {
-        return buildBlockGrid(edges, policy);
+        return buildBlockGrid(neighbourMasks, policy);
     }
 
-    /*
-        Sequential method for building the block grid
-
-        @param edges    The list of edges from a resolved similarity graph
-
-        @returns The fully built block grid
-    */
-    BlockGrid buildBlockGrid(const std::set<BlockEdge>& edges, std::execution::sequenced_policy) const;
-
-    /*
-        Builds an individual block in the pixel block grid
-
-        @param vertices A set of 1D indices for the top, bottom, left, and right edges of the block
-        @param edges    A set of all the edges in the similarity graph
-    */
-    PixelBlock buildBlock(const std::tuple<std::size_t, std::size_t, std::size_t, std::size_t>& vertices,
-                          const std::set<BlockEdge>& edges) const noexcept;
-
     /*
         Dispatcher for building the voronoi diagram with the specified execution policy
 
@@ -226,141 +320,149 @@ private:
         return buildVoronoiGraph(blocks, policy);
     }
 
+private:
+
     /*
-        Sequential method for building the voronoi diagram
+        Sequential method for building the block grid. Every edge in a block is
+        owned by its top left, top right or bottom left pixel, so each block code
+        is gathered from three neighbour masks with bit operations
 
-        @param blocks   The 2D grid of pixel blocks
+        @param neighbourMasks   The adjacency of every pixel in a resolved similarity graph
 
-        @returns The fully built voronoi diagram
+        @returns The fully built block grid
     */
-    Graph buildVoronoiGraph(const BlockGrid& blocks, std::execution::sequenced_policy) const;
+    BlockGrid buildBlockGrid(const std::vector<std::uint8_t>& neighbourMasks, std::execution::sequenced_policy) const;
 
     /*
-        Matches the pixel block with the pre-built voronoi cell configuration and returns
-        that configuration to the user
+        Parallel method for building the block grid. Every row of blocks
+        only reads the masks of its own two rows of pixels, so the rows are
+        built concurrently
 
-        @param block    The pixel block to get the voronoi configuration for
+        @param neighbourMasks   The adjacency of every pixel in a resolved similarity graph
 
-        @returns A voronoi configuration for the given pixel block
+        @returns The fully built block grid
     */
-    VoronoiConfig getVoronoiCellConfiguration(const PixelBlock& block) const;
-
-    struct DefaultTag {};
-    struct DiagonalTag {};
-    struct TriangleTag {};
+    BlockGrid buildBlockGrid(const std::vector<std::uint8_t>& neighbourMasks, std::execution::parallel_policy) const;
 
     /*
-        Gets the default voronoi configuration. This is the case for any pixel block
-        that's not a diagonal (either forward or backwards), or a triangle
+        Parallel, vectorized method for building the block grid. Building a
+        row is nothing but bit operations, so the rows can also be vectorized
 
-        @param block    The pixel block to get a voronoi configuration for
+        @param neighbourMasks   The adjacency of every pixel in a resolved similarity graph
 
-        @returns A voronoi configuration for the given pixel block
+        @returns The fully built block grid
     */
-    VoronoiConfig getConfiguration(const PixelBlock& block, DefaultTag) const noexcept;
+    BlockGrid buildBlockGrid(const std::vector<std::uint8_t>& neighbourMasks, std::execution::parallel_unsequenced_policy) const;
 
     /*
-        Gets the voronoi configuration for a pixel block that contains a diagonal
+        Builds a single row of the block grid
 
-        @param block    The pixel block to get a voronoi configuration for
-
-        @returns A voronoi configuration for the given pixel block
+        @param neighbourMasks   The adjacency of every pixel in a resolved similarity graph
+        @param h                The row of blocks to build
+        @param blocks           The grid to write the row of blocks to
     */
-    VoronoiConfig getConfiguration(const PixelBlock& block, DiagonalTag) const noexcept;
+    void buildBlockRow(const std::vector<std::uint8_t>& neighbourMasks, std::size_t h, BlockGrid& blocks) const noexcept;
 
     /*
-        Gets the voronoi configuration for a pixel block that contains a triangle
-
-        @param block    The pixel block to get a voronoi configuration for
+        Converts a list of edges into the neighbour mask of every pixel. Edges
+        between pixels that aren't neighbours are ignored
 
-        @returns A voronoi configuration for the given pixel block
-    */
-    VoronoiConfig getConfiguration(const PixelBlock& block, TriangleTag) const noexcept;
+        @param edges    The list of edges from a resolved similarity graph
 
-    /*
-        Plain old data struct for the transformation parameters. This contains the information
-        used to rotate and translate the voronoi configurations into place after they've been created
+        @returns The neighbour masks, in row-major order
     */
-    struct TransformParameters
-    {
-        double theta;
-        double deltaX;
-        double deltaY;
-    };
+    std::vector<std::uint8_t> buildNeighbourMasks(const std::set<BlockEdge>& edges) const;
 
     /*
-        Transforms the given point with the given transform parameters
+        Sequential method for building the voronoi diagram. Each block's cell is
+        looked up by its block code and moved into place. Every point is snapped to
+        the quarter-pixel lattice the cells are laid out on, so the border points
+        two neighbouring cells share are matched through a direct-indexed grid, and
+        welded as they're found. The graph is assembled in a single linear pass
 
-        @param point        The point to transform
-        @param parameters   The parameters to transform the point by
+        @param blocks   The 2D grid of pixel blocks
 
-        @returns The transformed point
+        @returns The fully built voronoi diagram
     */
-    Point2D<double> transformPoint(const Point2D<double>& point, TransformParameters parameters) const noexcept;
+    Graph buildVoronoiGraph(const BlockGrid& blocks, std::execution::sequenced_policy) const;
 
     /*
-        Gets the default transformation parameters for a pixel block.
+        Parallel method for building the voronoi diagram. The grid is split into
+        bands of rows, whose cells are laid out concurrently. The bands are then
+        welded together in row order, so the graph is identical to the one the
+        sequential method builds
 
-        @param block    The pixel block to get the transform parameters for
+        @param blocks   The 2D grid of pixel blocks
 
-        @returns A valid optional if a valid edge was present, an empty one otherwise
+        @returns The fully built voronoi diagram
     */
-    std::optional<TransformParameters> getTransformParameters(const dpa::voronoi::internal::PixelBlock& block, DefaultTag) const noexcept;
-    
-    /*
-        Gets the transformation parameters for a pixel block that contains a forward or backwards diagonal.
-
-        @param block    The pixel block to get the transform parameters for
+    Graph buildVoronoiGraph(const BlockGrid& blocks, std::execution::parallel_policy) const;
 
-        @returns A valid optional if a valid edge was present, an empty one otherwise
-    */
-    std::optional<TransformParameters> getTransformParameters(const dpa::voronoi::internal::PixelBlock& block, DiagonalTag) const noexcept;
-    
     /*
-        Gets the transformation parameters for a pixel block that contains a triangle.
+        Laying out a band of cells allocates, which isn't safe to vectorize,
+        so this builds the voronoi diagram with the parallel method
 
-        @param block    The pixel block to get the transform parameters for
+        @param blocks   The 2D grid of pixel blocks
 
-        @returns A valid optional if a valid edge was present, an empty one otherwise
+        @returns The fully built voronoi diagram
     */
-    std::optional<TransformParameters> getTransformParameters(const dpa::voronoi::internal::PixelBlock& block, TriangleTag) const noexcept;
+    Graph buildVoronoiGraph(const BlockGrid& blocks, std::execution::parallel_unsequenced_policy) const;
 
     /*
-        Welds the list of disjoint voronoi configurations into a single graph, asynchronously
+        A cell that's been moved into place, but not welded to its neighbours yet
+    */
+    struct PlacedCell
+    {
+        // The cell's block code, and the index of its first point in the band
+        std::uint8_t code{ 0 };
+        std::size_t base{ 0 };
 
-        @param disjointVoronoi  A list of disjoint voronoi configurations, which are the distinct
-                                pieces of the voronoi diagram that have been matched with pixel blocks
+        // The 1D index of the block's top left pixel
+        std::size_t topLeft{ 0 };
+
+        // The slot in the weld grid each of the cell's border points snapped to
+        std::array<std::size_t, VoronoiCellTemplate::kNumWelds> weldSlots{};
+    };
 
-        @returns A graph that contains all the nodes and edges in the voronoi diagram
+    /*
+        The cells of a band of consecutive block rows, in row-major order
     */
-    Graph WeldAsync(const std::vector<std::vector<VoronoiConfig>>& disjointVoronoi) const noexcept;
-    
+    struct CellBand
+    {
+        memory::ArenaVector<VertexProperty> points{};
+        memory::ArenaVector<PlacedCell> cells{};
+    };
+
     /*
-        This welds two voronoi diagrams together, which produces a single voronoi diagram
+        Moves the cells of a band of block rows into place, without welding them
 
-        @param init The existing voronoi diagram that contains the accumulated graph welds
-        @param rhs  The right hand side, or the new voronoi diagram that's being welded
+        @param blocks   The 2D grid of pixel blocks
+        @param firstRow The first row of blocks in the band
+        @param lastRow  One past the last row of blocks in the band
 
-        @returns A combined voronoi diagram that's the product of welding init and rhs together
+        @returns The band's points and cells
     */
-    VoronoiConfig WeldGraphs(const VoronoiConfig& init, const VoronoiConfig& rhs) const noexcept;
-    
+    CellBand layoutCells(const BlockGrid& blocks, std::size_t firstRow, std::size_t lastRow) const;
+
     /*
-        Welds all the vertices together between two graphs, and spits the result out to lhs. The weld process
-        removes overlapping vertices and inserts an edge between the nodes attached to the overlapping vertices
+        Welds the cells of every band together, and assembles the voronoi graph
 
-        @param dest         The graph to write the results into
-        @param vertexOffset The amount to offset each of the nodes by when writing to dest
-        @param lhsWelds     The weld information for the accumulated result of previous welds
-        @param rhsWelds     The new set of weld data, which is being welded with lhsWelds
+        @param bands    The bands of cells, in row order
+
+        @returns The fully built voronoi diagram
     */
-    void WeldVertices(Graph& dest, std::size_t vertexOffset, const WeldMap& lhsWelds, const WeldMap& rhsWelds) const noexcept;
+    Graph weldCells(const memory::ArenaVector<CellBand>& bands) const;
 
 public:
 
     int m_height{ 0 };
     int m_width{ 0 };
 
+    ExecutionPolicy m_policy{ ExecutionPolicy::eSequenced };
+
+    // Where the block grid and the build's scratch storage are allocated from
+    std::pmr::memory_resource* m_resource{ std::pmr::get_default_resource() };
+
     BlockGrid m_blockGrid{};
     Graph m_voronoiGraph{ 0 };
 };
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dpa::voronoi
+{
+/*
+    The kinds of contour that run between the cells of a voronoi diagram.
+    Visible contours separate cells of significantly different colours, and
+    shading contours separate cells of colours that are only slightly different
+*/
+enum class ContourType : std::uint8_t
+{
+    eVisible, eShading
+};
+
+/*
+    The contours of a voronoi diagram, as polylines stored in flat arrays
+    rather than a container per contour. The points of contour i are
+    [offsets[i], offsets[i + 1]), and point n is at coordinates[2n], coordinates[2n + 1].
+    A closed contour repeats its first point at the end
+*/
+struct ContourSet
+{
+    std::vector<double> coordinates{};
+    std::vector<std::size_t> offsets{ 0 };
+    std::vector<ContourType> types{};
+
+    /*
+        Gets the number of contours in the set
+
+        @returns The number of contours
+    */
+    std::size_t size() const noexcept { return types.size(); }
+
+    /*
+        Gets the number of points in every contour of the set
+
+        @returns The number of points
+    */
+    std::size_t getNumPoints() const noexcept { return coordinates.size() / 2; }
+
+    /*
+        Gets the number of points in a contour
+
+        @param contour  The index of the contour
+        @returns The number of points in the contour
+    */
+    std::size_t getNumPoints(std::size_t contour) const noexcept { return offsets[contour + 1] - offsets[contour]; }
+
+    /*
+        Checks if a contour ends where it started
+
+        @param contour  The index of the contour
+        @returns True if the contour is closed, false otherwise
+    */
+    bool isClosed(std::size_t contour) const noexcept
+    {
+        const std::size_t first = 2 * offsets[contour];
+        const std::size_t last = 2 * (offsets[contour + 1] - 1);
+
+        return getNumPoints(contour) > 2 &&
+            coordinates[first] == coordinates[last] && coordinates[first + 1] == coordinates[last + 1];
+    }
+};
+}
@@ -1,12 +1,9 @@
 #include <CurvesHeuristic.h>
 
-#include <boost/uuid/uuid.hpp>
-#include <boost/uuid/uuid_generators.hpp>
-
 namespace dpa::graph::heuristics
 {
 Curves::Curves()
-    : m_uuid(boost::uuids::random_generator()())
+    : m_marks(std::make_shared<EdgeMarks>())
 {}
 
 Curves::Curves(const utility::Point2D<int>& imageDims)
@@ -25,19 +22,31 @@ Curves& Curves::operator=(const Curves& other)
     if (this == &other)
         return *this;
 
-    m_uuid = other.m_uuid;
+    m_marks = other.m_marks;
     m_imageDims = other.m_imageDims;
 
     return *this;
 }
 
-const HeuristicHelper::EdgeMap& Curves::getMarkedEdges() const noexcept
+EdgeMarks::EdgeMap Curves::getMarkedEdges() const
+{
+    return m_marks->toEdgeMap();
+}
+
+const EdgeMarks& Curves::getEdgeMarks() const noexcept
 {
-    return HeuristicHelper::instance().getMarkedEdges(m_uuid);
+    return *m_marks;
 }
 
 void Curves::clearMarkedEdges() const noexcept
 {
-    HeuristicHelper::instance().clearMarkedEdges(m_uuid);
+    m_marks->clear();
+    m_chains.reset();
+}
+
+void Curves::resetMarkedEdges(std::size_t numMarks) const
+{
+    m_marks->reset(numMarks);
+    m_chains.reset();
 }
 }
@@ -3,12 +3,9 @@
 #include <GraphUtils.h>
 #include <HeuristicHelper.h>
 
-#include <boost/graph/depth_first_search.hpp>
+#include <memory>
 
-namespace boost::uuids
-{
-    struct uuid;
-}
+#include <boost/graph/depth_first_search.hpp>
 
 namespace dpa::graph::heuristics
 {
@@ -22,7 +19,7 @@ class Curves : public boost::default_dfs_visitor, IMarkedEdgeHelper
 public:
 
     /*
-        Default constructor. Creates the uuid for this instance
+        Default constructor. Creates the mark buffer for this instance
     */
     Curves();
 
@@ -33,14 +30,14 @@ public:
     explicit Curves(const utility::Point2D<int>& imageDims);
 
     /*
-        Copy constructor, which sets this uuid to other's uuid
+        Copy constructor, which shares other's mark buffer
 
         @param other Another DissimilarPixels to create this object from
     */
     Curves(const Curves& other);
 
     /*
-        Copy assignment. This sets this uuid to the other's uuid
+        Copy assignment. This shares the other's mark buffer
 
         @param other Another DissimilarPixels to create this object from
         @returns A reference to this instance
@@ -75,67 +72,89 @@ public:
 
         const auto [xSource, xTarget] = utility::GetCrossingEdge(edgeSource, edgeTarget, imageWidth);
         if (auto [crossingEdge, found] = boost::edge(xSource, xTarget, graph); found)
-        {
-            long long lengthA = getCurveLength(edgeSource, graph);
-            long long lengthB = getCurveLength(boost::source(crossingEdge, graph), graph);
-
-            // I'm cutting edge weights in half due to the graph being
-            // undirected. There's two edges for each connection between
-            // pixels, and so the weights are doubled
-            if (lengthA > lengthB)
-            {
-                HeuristicHelper::instance().insertMarkedEdge(m_uuid,
-                    { edgeSource, edgeTarget }, (lengthA - lengthB) / 2.0);
-            }
-            else if (lengthB > lengthA)
-            {
-                HeuristicHelper::instance().insertMarkedEdge(m_uuid,
-                    { xSource , xTarget }, (lengthB - lengthA) / 2.0);
-            }
-        }
+            examine_crossing(edge, crossingEdge, graph);
     }
 
-    const HeuristicHelper::EdgeMap& getMarkedEdges() const noexcept override;
-    void clearMarkedEdges() const noexcept override;
+    /*
+        Resolves a pair of crossing edges by marking the edge the vote favours
 
-private:
+        @param edge The diagonal edge being examined
+        @param crossingEdge The diagonal edge that crosses it
+        @param graph The graph containing the edges we're looking at
+    */
+    template <class Edge, class Graph>
+    void examine_crossing(Edge edge, Edge crossingEdge, const Graph& graph)
+    {
+        if (const double weight = vote(edge, crossingEdge, graph); weight > 0)
+            m_marks->mark(edge, weight);
+        else if (weight < 0)
+            m_marks->mark(crossingEdge, -weight);
+    }
 
     /*
-        Gets the length of the curve, starting at the given vertex
+        Votes on a pair of crossing edges. The curve with the longest
+        length is awarded the difference in lengths as an additional
+        edge weight
 
-        @returns The length of the curve
+        @param edge The diagonal edge being examined
+        @param crossingEdge The diagonal edge that crosses it
+        @param graph The graph containing the edges we're looking at
+        @returns The weight awarded to the edge if it's positive, the weight
+                 awarded to the crossing edge if it's negative, or zero for a tie
     */
-    template<typename Vertex, typename Graph>
-    long long getCurveLength(Vertex vertex, Graph graph) const noexcept;
+    template <class Edge, class Graph>
+    double vote(Edge edge, Edge crossingEdge, const Graph& graph)
+    {
+        // Label every curve in the graph the first time we need a curve length
+        if (!m_chains.isBuilt())
+            m_chains.build(graph);
 
-private:
+        long long lengthA = m_chains.getCurveLength(boost::source(edge, graph));
+        long long lengthB = m_chains.getCurveLength(boost::source(crossingEdge, graph));
 
-    boost::uuids::uuid m_uuid;
-    utility::Point2D<int> m_imageDims{};
+        // I'm cutting edge weights in half due to the graph being
+        // undirected. There's two edges for each connection between
+        // pixels, and so the weights are doubled
+        return (lengthA - lengthB) / 2.0;
+    }
 
-};
+    /*
+        Votes on both diagonals of a crossing block. The curve length of each
+        corner is looked up once, and shared by every orientation it starts
 
-template<typename Vertex, typename Graph>
-long long Curves::getCurveLength(Vertex vertex, Graph graph) const noexcept
-{
-    // Build the color map to keep track of visited nodes
-    std::vector<boost::default_color_type> colorMap{ boost::num_vertices(graph) };
-    auto colorPropertyMap = boost::make_iterator_property_map(std::begin(colorMap),
-        boost::get(boost::vertex_index, graph), colorMap[0]);
+        @param topLeft The top left vertex of the crossing block
+        @param graph The graph containing the block
+        @returns The weights awarded to each orientation of the block's diagonals
+    */
+    template <class Graph>
+    BlockWeights voteOnBlock(std::size_t topLeft, const Graph& graph)
+    {
+        if (!m_chains.isBuilt())
+            m_chains.build(graph);
 
-    // Launch the depth first visit with out edge counter
+        const auto imageWidth = static_cast<std::size_t>(std::get<0>(m_imageDims));
+        const long long topLeftLength = m_chains.getCurveLength(topLeft);
+        const long long topRightLength = m_chains.getCurveLength(topLeft + 1);
+        const long long bottomLeftLength = m_chains.getCurveLength(topLeft + imageWidth);
+        const long long bottomRightLength = m_chains.getCurveLength(topLeft + imageWidth + 1);
 
-    long long edgeCount{ 0 };
-    utility::EdgeCounter counter{ edgeCount };
-    boost::depth_first_visit(graph, vertex, counter, colorPropertyMap,
-        [](Vertex vertex, const Graph& graph)
-        {
-            return boost::out_degree(vertex, graph) != 2;
-        });
-
-    // If the dfs hits the terminator function on the
-    // first vertex, then it doesn't process any edges.
-    // There is always at least 1 edge in the curve
-    return !edgeCount ? static_cast<long long>(1) : edgeCount;
-}
-}
+        // Swapping a pair of crossing orientations only negates their vote, so each pair is voted on once
+        return SplitBlockVotes((topLeftLength - bottomLeftLength) / 2.0, (bottomRightLength - topRightLength) / 2.0);
+    }
+
+    EdgeMarks::EdgeMap getMarkedEdges() const override;
+    const EdgeMarks& getEdgeMarks() const noexcept override;
+    void clearMarkedEdges() const noexcept override;
+    void resetMarkedEdges(std::size_t numMarks) const override;
+
+private:
+
+    std::shared_ptr<EdgeMarks> m_marks;
+    utility::Point2D<int> m_imageDims{};
+
+    // The curve lengths of the graph being searched. These aren't copied, and they're
+    // dropped along with the marks, so every search starts with a fresh set of chains
+    mutable utility::ValenceChains m_chains{};
+
+};
+}
\ No newline at end of file
@@ -3,7 +3,7 @@
 namespace dpa::graph::heuristics
 {
 DissimilarPixels::DissimilarPixels()
-    : m_uuid(boost::uuids::random_generator()())
+    : m_marks(std::make_shared<EdgeMarks>())
 {}
 
 DissimilarPixels::DissimilarPixels(const DissimilarPixels& other)
@@ -16,18 +16,28 @@ DissimilarPixels& DissimilarPixels::operator=(const DissimilarPixels& other)
     if (this == &other)
         return *this;
 
-    m_uuid = other.m_uuid;
+    m_marks = other.m_marks;
 
     return *this;
 }
 
-const HeuristicHelper::EdgeMap& DissimilarPixels::getMarkedEdges() const noexcept
+EdgeMarks::EdgeMap DissimilarPixels::getMarkedEdges() const
 {
-    return HeuristicHelper::instance().getMarkedEdges(m_uuid);
+    return m_marks->toEdgeMap();
+}
+
+const EdgeMarks& DissimilarPixels::getEdgeMarks() const noexcept
+{
+    return *m_marks;
 }
 
 void DissimilarPixels::clearMarkedEdges() const noexcept
 {
-    HeuristicHelper::instance().clearMarkedEdges(m_uuid);
+    m_marks->clear();
+}
+
+void DissimilarPixels::resetMarkedEdges(std::size_t numMarks) const
+{
+    m_marks->reset(numMarks);
 }
 }
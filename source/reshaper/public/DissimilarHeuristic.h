@@ -2,11 +2,10 @@
 
 #include <HeuristicHelper.h>
 
+#include <memory>
 #include <variant>
 
 #include <boost/graph/depth_first_search.hpp>
-#include <boost/uuid/uuid.hpp>
-#include <boost/uuid/uuid_generators.hpp>
 
 namespace dpa::graph::heuristics
 {
@@ -15,22 +14,29 @@ namespace dpa::graph::heuristics
 */
 class DissimilarPixels : public boost::default_dfs_visitor, IMarkedEdgeHelper
 {
+public:
+
+    // The difference in each channel that makes two pixels dissimilar
+    static constexpr float kYThreshold = 48.f / 255.f;
+    static constexpr float kCbThreshold = 7.f / 255.f;
+    static constexpr float kCrThreshold = 6.f / 255.f;
+
 public:
 
     /*
-        Default constructor. Creates the uuid for this instance
+        Default constructor. Creates the mark buffer for this instance
     */
     DissimilarPixels();
 
     /*
-        Copy constructor, which sets this uuid to other's uuid
+        Copy constructor, which shares other's mark buffer
 
         @param other Another DissimilarPixels to create this object from
     */
     DissimilarPixels(const DissimilarPixels& other);
 
     /*
-        Copy assignment. This sets this uuid to the other's uuid
+        Copy assignment. This shares the other's mark buffer
 
         @param other Another DissimilarPixels to create this object from
         @returns A reference to this instance
@@ -50,27 +56,51 @@ public:
     template <class Edge, class Graph>
     void examine_edge(Edge edge, const Graph& graph) {
 
-        auto start = boost::source(edge, graph);
-        auto end = boost::target(edge, graph);
+        if (isDissimilar(boost::source(edge, graph), boost::target(edge, graph), graph))
+            m_marks->mark(edge, true);
+    }
+
+    /*
+        Marks an edge as dissimilar without comparing its pixels. This is
+        for searches that find the dissimilar edges some other way
 
+        @param edge An edge_descriptor in the lattice graph
+    */
+    void markDissimilar(const internal::LatticeEdge& edge) const
+    {
+        m_marks->mark(edge, true);
+    }
+
+    /*
+        Compares the pixels at either end of an edge. The comparison is made
+        in the direction of the edge, so an edge is dissimilar if either of
+        its orientations are
+
+        @param start The vertex the edge starts at
+        @param end The vertex the edge ends at
+        @param graph The graph containing the vertices
+        @returns True if the pixels are dissimilar, false otherwise
+    */
+    template <class Vertex, class Graph>
+    static bool isDissimilar(Vertex start, Vertex end, const Graph& graph)
+    {
         float deltaY = static_cast<float>(graph[start].Y - graph[end].Y);
         float deltaCb = static_cast<float>(graph[start].Cb - graph[end].Cb);
         float deltaCr = static_cast<float>(graph[start].Cr - graph[end].Cr);
 
-        if ((deltaY >= (48.f / 255.f)) ||
-            (deltaCb >= (7.f / 255.f)) ||
-            (deltaCr >= (6.f / 255.f)))
-        {
-            HeuristicHelper::instance().insertMarkedEdge(m_uuid, { start, end }, true);
-        }
+        return (deltaY >= kYThreshold) ||
+               (deltaCb >= kCbThreshold) ||
+               (deltaCr >= kCrThreshold);
     }
 
-    const HeuristicHelper::EdgeMap& getMarkedEdges() const noexcept override;
+    EdgeMarks::EdgeMap getMarkedEdges() const override;
+    const EdgeMarks& getEdgeMarks() const noexcept override;
     void clearMarkedEdges() const noexcept override;
+    void resetMarkedEdges(std::size_t numMarks) const override;
 
 private:
 
-    boost::uuids::uuid m_uuid;
+    std::shared_ptr<EdgeMarks> m_marks;
 
 };
 }
@@ -17,9 +17,4 @@ FilteredEdges operator^(FilteredEdges a, FilteredEdges b)
 {
     return static_cast<FilteredEdges>(static_cast<int>(a) ^ static_cast<int>(b));
 }
-
-bool hasFilter(FilteredEdges filters, FilteredEdges target) noexcept
-{
-    return (filters & target) == target;
-}
 }
\ No newline at end of file
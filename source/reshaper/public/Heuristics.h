@@ -33,7 +33,10 @@ FilteredEdges operator^(FilteredEdges a, FilteredEdges b);
     @target A filter to determine if it resides in the filter flags
     @returns True if the target filter is packed in the filter flag
 */
-bool hasFilter(FilteredEdges filters, FilteredEdges target) noexcept;
+constexpr bool hasFilter(FilteredEdges filters, FilteredEdges target) noexcept
+{
+    return (static_cast<int>(filters) & static_cast<int>(target)) == static_cast<int>(target);
+}
 
 /*
     Visits each of the filter edges in the enum with
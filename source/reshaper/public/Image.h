@@ -7,12 +7,17 @@
 
 #include <algorithm>
 #include <array>
+#include <cstring>
 #include <filesystem>
 #include <map>
+#include <memory>
+#include <new>
 #include <numeric>
 #include <optional>
+#include <stdexcept>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <variant>
 
 #include <stdlib.h>
@@ -33,11 +38,18 @@ public:
     Image() = default;
     Image(const std::filesystem::path& filePath);
     Image(const internal::Point2D& dimensions);
+    Image(const internal::Point2D& dimensions, const BitDepth* pixelData);
 
     Image(const Image& other);
     Image& operator=(const Image& other);
 
-    ~Image();
+    Image(Image&& other) noexcept;
+    Image& operator=(Image&& other) noexcept;
+
+    ~Image() = default;
+
+    Image share() const noexcept;
+    bool isShared() const noexcept;
 
     bool save(const std::filesystem::path& destPath) const noexcept;
 
@@ -50,9 +62,22 @@ public:
     std::optional<Channels<BitDepth>> getPixelAt(const internal::Point2D&) const;
     bool setPixelAt(const internal::Point2D& position, const Channels<BitDepth>& pixel);
 
+    std::optional<internal::PixelRow<Channels, BitDepth>> row(int y) noexcept;
+    std::optional<internal::PixelRow<Channels, const BitDepth>> row(int y) const noexcept;
+
+    internal::PixelView2D<Channels, BitDepth> pixels() noexcept;
+    internal::PixelView2D<Channels, const BitDepth> pixels() const noexcept;
+
+    BitDepth* getData() noexcept;
+    const BitDepth* getData() const noexcept;
+
 private:
 
     void createImageView(const internal::Point2D& dimensions);
+    void adoptBuffer(BitDepth* pixelData, const internal::Point2D& dimensions);
+    bool detach() noexcept;
+
+    std::size_t getDataSize() const noexcept;
 
     std::optional<std::tuple<int, int>> load(const std::filesystem::path& filePath);
     BitDepth* loadImpl(const std::filesystem::path& filePath, int& width, int& height, int& channels);
@@ -72,7 +97,7 @@ private:
 
     bool m_loaded{ false };
 
-    BitDepth* m_pData{ nullptr };
+    std::shared_ptr<BitDepth> m_pData{};
     internal::ImageView<Channels, BitDepth> m_view;
 };
 
@@ -88,10 +113,7 @@ template<template<typename> class Channels, typename BitDepth>
 Image<Channels, BitDepth>::Image(const std::filesystem::path& filePath)
 {
     if (auto imageAttributes = load(filePath); imageAttributes)
-    {
         m_loaded = true;
-        m_view = internal::ImageView<Channels, BitDepth>{ m_pData, imageAttributes.value() };
-    }
 }
 
 /*
@@ -106,44 +128,129 @@ Image<Channels, BitDepth>::Image(const internal::Point2D& dimensions)
     createImageView(dimensions);
 }
 
+/*
+    Constructs a new image from pixels that were decoded or generated in
+    memory. The pixels are copied, and the image counts as loaded, just
+    like one read from a file
+
+    @param dimensions The width and height of the new image
+    @param pixelData  The image's pixels, in row-major order
+*/
+template<template<typename> class Channels, typename BitDepth>
+Image<Channels, BitDepth>::Image(const internal::Point2D& dimensions, const BitDepth* pixelData)
+{
+    createImageView(dimensions);
+
+    if (!m_pData || !pixelData)
+        return;
+
+    std::memcpy(m_pData.get(), pixelData, getDataSize() * sizeof(BitDepth));
+    m_loaded = true;
+}
+
+/*
+    Deep copies the other image. The pixel buffer is copied in one go, so this
+    costs a single allocation and memcpy
+
+    @param other The image to copy
+*/
 template<template<typename> class Channels, typename BitDepth>
 Image<Channels, BitDepth>::Image(const Image& other)
-    : Image(std::make_tuple(other.getWidth(), other.getHeight()))
 {
     *this = other;
 }
 
+/*
+    Deep copies the other image into this one, releasing this image's buffer
+
+    @param other The image to copy
+    @returns A reference to this image
+*/
 template<template<typename> class Channels, typename BitDepth>
 Image<Channels, BitDepth>& Image<Channels, BitDepth>::operator=(const Image& other)
 {
     if (this == &other)
         return *this;
 
+    m_pData.reset();
+    m_view = {};
     m_loaded = other.isLoaded();
-    createImageView(std::make_tuple(other.getWidth(), other.getHeight()));
 
-    for (auto h = 0; h < other.getHeight(); ++h)
-    {
-        for (auto w = 0; w < other.getWidth(); ++w)
-        {
-            if (auto pixel = other.getPixelAt({ w, h }); pixel)
-            {
-                if (!setPixelAt({ w, h }, pixel.value()))
-                    throw std::runtime_error("Could not set the source image's pixels.");
-            }
-        }
-    }
+    if (!other.m_pData)
+        return *this;
+
+    const auto dataSize = other.getDataSize() * sizeof(BitDepth);
+
+    auto pixelData = reinterpret_cast<BitDepth*>(malloc(dataSize));
+    if (!pixelData)
+        throw std::bad_alloc();
+
+    std::memcpy(pixelData, other.m_pData.get(), dataSize);
+    adoptBuffer(pixelData, { other.getWidth(), other.getHeight() });
+
+    return *this;
+}
+
+/*
+    Takes ownership of the other image's pixel buffer. The other image is left empty
+
+    @param other The image to move from
+*/
+template<template<typename> class Channels, typename BitDepth>
+Image<Channels, BitDepth>::Image(Image&& other) noexcept
+    : m_loaded(std::exchange(other.m_loaded, false)),
+      m_pData(std::move(other.m_pData)),
+      m_view(std::exchange(other.m_view, {}))
+{}
+
+/*
+    Takes ownership of the other image's pixel buffer, releasing this image's
+    buffer. The other image is left empty
+
+    @param other The image to move from
+    @returns A reference to this image
+*/
+template<template<typename> class Channels, typename BitDepth>
+Image<Channels, BitDepth>& Image<Channels, BitDepth>::operator=(Image&& other) noexcept
+{
+    if (this == &other)
+        return *this;
+
+    m_loaded = std::exchange(other.m_loaded, false);
+    m_pData = std::move(other.m_pData);
+    m_view = std::exchange(other.m_view, {});
 
     return *this;
 }
 
 /*
-    Destructor
+    Creates a copy-on-write copy of this image. The copy shares this image's
+    pixel buffer until either image is written to, at which point the writer
+    makes its own copy of the buffer. This isn't thread safe; don't write to
+    images that share a buffer from multiple threads
+
+    @returns An image that shares this image's pixels
+*/
+template<template<typename> class Channels, typename BitDepth>
+Image<Channels, BitDepth> Image<Channels, BitDepth>::share() const noexcept
+{
+    Image shared;
+    shared.m_loaded = m_loaded;
+    shared.m_pData = m_pData;
+    shared.m_view = m_view;
+
+    return shared;
+}
+
+/*
+    Determines if this image shares its pixel buffer with another image
+
+    @returns True if the buffer is shared, false otherwise
 */
 template<template<typename> class Channels, typename BitDepth>
-Image<Channels, BitDepth>::~Image()
+bool Image<Channels, BitDepth>::isShared() const noexcept
 {
-    stbi_image_free(m_pData);
+    return m_pData.use_count() > 1;
 }
 
 /*
@@ -192,12 +299,12 @@ std::optional<std::tuple<int, int>> Image<Channels, BitDepth>::load(const std::f
     int height = 0;
     int channels = 0;
 
-    m_pData = loadImpl(filePath, width, height, channels);
-
-    if (m_pData != nullptr)
-        return {{ width, height }};
-    else
+    auto pixelData = loadImpl(filePath, width, height, channels);
+    if (pixelData == nullptr)
         return {};
+
+    adoptBuffer(pixelData, { width, height });
+    return {{ width, height }};
 }
 
 /*
@@ -267,17 +374,153 @@ std::optional<Channels<BitDepth>> Image<Channels, BitDepth>::getPixelAt(const in
 template<template<typename> class Channels, typename BitDepth>
 bool Image<Channels, BitDepth>::setPixelAt(const internal::Point2D& position, const Channels<BitDepth>& pixel)
 {
+    if (!detach())
+        return false;
+
     return m_view.setPixelAt(position, pixel);
 }
 
+/*
+    Gets a contiguous row of pixels that can be read and written without
+    any per-pixel bounds checking
+
+    @param y The row to get
+    @returns A valid optional containing the row, if it was within the
+             bounds of the image. An empty optional otherwise
+*/
+template<template<typename> class Channels, typename BitDepth>
+std::optional<internal::PixelRow<Channels, BitDepth>> Image<Channels, BitDepth>::row(int y) noexcept
+{
+    if (!detach())
+        return {};
+
+    return m_view.row(y);
+}
+
+/*
+    Gets a read only row of pixels
+
+    @param y The row to get
+    @returns A valid optional containing the row, if it was within the
+             bounds of the image. An empty optional otherwise
+*/
+template<template<typename> class Channels, typename BitDepth>
+std::optional<internal::PixelRow<Channels, const BitDepth>> Image<Channels, BitDepth>::row(int y) const noexcept
+{
+    if (auto pixelRow = m_view.row(y); pixelRow)
+        return internal::PixelRow<Channels, const BitDepth>{ pixelRow->data(), pixelRow->size() };
+
+    return {};
+}
+
+/*
+    Gets a 2D view over every pixel in the image
+
+    @returns A view whose rows are tightly packed
+*/
+template<template<typename> class Channels, typename BitDepth>
+internal::PixelView2D<Channels, BitDepth> Image<Channels, BitDepth>::pixels() noexcept
+{
+    if (!detach())
+        return {};
+
+    return m_view.pixels();
+}
+
+/*
+    Gets a read only 2D view over every pixel in the image
+
+    @returns A view whose rows are tightly packed
+*/
+template<template<typename> class Channels, typename BitDepth>
+internal::PixelView2D<Channels, const BitDepth> Image<Channels, BitDepth>::pixels() const noexcept
+{
+    const auto view = m_view.pixels();
+    return { view.data(), { view.getWidth(), view.getHeight() }, view.getStride() };
+}
+
+/*
+    Gets the raw, interleaved pixel data of the image
+
+    @returns A pointer to the first channel of the top left pixel, or
+             nullptr if the image is empty
+*/
+template<template<typename> class Channels, typename BitDepth>
+BitDepth* Image<Channels, BitDepth>::getData() noexcept
+{
+    if (!detach())
+        return nullptr;
+
+    return m_pData.get();
+}
+
+/*
+    Gets the raw, interleaved pixel data of the image
+
+    @returns A pointer to the first channel of the top left pixel, or
+             nullptr if the image is empty
+*/
+template<template<typename> class Channels, typename BitDepth>
+const BitDepth* Image<Channels, BitDepth>::getData() const noexcept
+{
+    return m_pData.get();
+}
+
 template<template<typename> class Channels, typename BitDepth>
 void Image<Channels, BitDepth>::createImageView(const internal::Point2D& dimensions)
 {
     const auto [width, height] = dimensions;
     const auto dataSize = width * height * channel_count_v<Channels>;
 
-    m_pData = reinterpret_cast<BitDepth*>(calloc(dataSize, sizeof(BitDepth)));
-    m_view = internal::ImageView<Channels, BitDepth>{ m_pData, dimensions };
+    adoptBuffer(reinterpret_cast<BitDepth*>(calloc(dataSize, sizeof(BitDepth))), dimensions);
+}
+
+/*
+    Takes ownership of a buffer allocated by stb or the C allocator, and views it
+
+    @param pixelData The buffer to take ownership of
+    @param dimensions The width and height of the image in the buffer
+*/
+template<template<typename> class Channels, typename BitDepth>
+void Image<Channels, BitDepth>::adoptBuffer(BitDepth* pixelData, const internal::Point2D& dimensions)
+{
+    m_pData = std::shared_ptr<BitDepth>(pixelData, [](BitDepth* data) { stbi_image_free(data); });
+    m_view = internal::ImageView<Channels, BitDepth>{ m_pData.get(), dimensions };
+}
+
+/*
+    Gives this image its own copy of the pixel buffer if it's sharing it with
+    another image, so it can be written to without affecting the other
+
+    @returns True if this image owns its buffer, false if the copy failed
+*/
+template<template<typename> class Channels, typename BitDepth>
+bool Image<Channels, BitDepth>::detach() noexcept
+{
+    if (!isShared())
+        return true;
+
+    const auto dataSize = getDataSize() * sizeof(BitDepth);
+
+    auto pixelData = reinterpret_cast<BitDepth*>(malloc(dataSize));
+    if (!pixelData)
+        return false;
+
+    std::memcpy(pixelData, m_pData.get(), dataSize);
+    adoptBuffer(pixelData, { getWidth(), getHeight() });
+
+    return true;
+}
+
+/*
+    Gets the number of channel values in the pixel buffer
+
+    @returns width * height * channels
+*/
+template<template<typename> class Channels, typename BitDepth>
+std::size_t Image<Channels, BitDepth>::getDataSize() const noexcept
+{
+    return static_cast<std::size_t>(getWidth()) * getHeight() * getChannels();
 }
 
 /*
@@ -299,29 +542,29 @@ bool Image<Channels, BitDepth>::saveImpl(const std::filesystem::path& destPath,
             if constexpr (std::is_same_v<TagType, png_write_tag>)
             {
                 return stbi_write_png(destPath.string().c_str(), getWidth(),
-                    getHeight(), getChannels(), m_pData, 0);
+                    getHeight(), getChannels(), m_pData.get(), 0);
             }
             else if constexpr (std::is_same_v<TagType, bmp_write_tag>)
             {
                 return stbi_write_bmp(destPath.string().c_str(), getWidth(),
-                    getHeight(), getChannels(), m_pData);
+                    getHeight(), getChannels(), m_pData.get());
             }
             else if constexpr (std::is_same_v<TagType, tga_write_tag>)
             {
                 return stbi_write_tga(destPath.string().c_str(), getWidth(),
-                    getHeight(), getChannels(), m_pData);
+                    getHeight(), getChannels(), m_pData.get());
             }
             else if constexpr (std::is_same_v<TagType, jpg_write_tag>)
             {
                 return stbi_write_jpg(destPath.string().c_str(), getWidth(),
-                    getHeight(), getChannels(), m_pData, 100);
+                    getHeight(), getChannels(), m_pData.get(), 100);
             }
             else if constexpr (std::is_same_v<TagType, hdr_write_tag>)
             {
-                if (std::is_same_v<decltype(m_pData), float*>)
+                if (std::is_same_v<BitDepth, float>)
                 {
                     return stbi_write_hdr(destPath.string().c_str(), getWidth(),
-                        getHeight(), getChannels(), reinterpret_cast<const float*>(m_pData));
+                        getHeight(), getChannels(), reinterpret_cast<const float*>(m_pData.get()));
                 }
 
                 return 0;
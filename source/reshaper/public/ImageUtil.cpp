@@ -1,8 +1,89 @@
 #include <ImageUtil.h>
 
+#include <ColorConversion.h>
 #include <Pixel.h>
 
+#include <array>
+#include <cstdint>
 #include <optional>
+#include <utility>
+#include <vector>
+
+namespace
+{
+using namespace dpa::image;
+
+/*
+    Palettizes an image with three byte channels. Colours are looked up in a
+    small open addressing table keyed by the packed pixel, and runs of the same
+    colour skip the lookup entirely, so each pixel is only read once
+
+    @param image The image to palettize
+    @returns The palettized image, or an empty optional if the image is empty
+             or uses more colours than a palette can hold
+*/
+template<template<typename> class Channels>
+std::optional<IndexedImage<Channels, stbi_uc>> PalettizeImpl(const Image<Channels, stbi_uc>& image)
+{
+    static_assert(channel_count_v<Channels> == 3, "Only three channel images can be palettized");
+
+    using Indexed = IndexedImage<Channels, stbi_uc>;
+
+    if (!image.getHeight() || !image.getWidth())
+        return {};
+
+    // Twice as many slots as colours keeps the probe sequences short
+    constexpr std::size_t kNumSlots = Indexed::kMaxColors * 2;
+    constexpr std::uint32_t kEmpty = 0;
+
+    // Keys are the packed colour plus one, so a zero key marks an empty slot
+    std::array<std::uint32_t, kNumSlots> keys{};
+    std::array<stbi_uc, kNumSlots> slots{};
+
+    std::vector<stbi_uc> indices(static_cast<std::size_t>(image.getWidth()) * image.getHeight());
+    std::vector<typename Indexed::Pixel> palette;
+    palette.reserve(Indexed::kMaxColors);
+
+    std::uint32_t lastKey = kEmpty;
+    stbi_uc lastIndex = 0;
+
+    const auto pixels = image.pixels();
+    auto out = indices.data();
+
+    for (auto h = 0; h < pixels.getHeight(); ++h)
+    {
+        const stbi_uc* data = pixels.row(h).data();
+        for (auto w = 0; w < pixels.getWidth(); ++w, data += 3)
+        {
+            const std::uint32_t key = ((std::uint32_t{ data[0] } << 16) | (std::uint32_t{ data[1] } << 8) | data[2]) + 1;
+            if (key != lastKey)
+            {
+                // Fibonacci hashing spreads neighbouring colours across the table
+                auto slot = static_cast<std::size_t>((key * 2654435769u) >> 23) % kNumSlots;
+                while (keys[slot] != kEmpty && keys[slot] != key)
+                    slot = (slot + 1) % kNumSlots;
+
+                if (keys[slot] == kEmpty)
+                {
+                    if (palette.size() == Indexed::kMaxColors)
+                        return {};
+
+                    keys[slot] = key;
+                    slots[slot] = static_cast<stbi_uc>(palette.size());
+                    palette.emplace_back(data[0], data[1], data[2]);
+                }
+
+                lastKey = key;
+                lastIndex = slots[slot];
+            }
+
+            *out++ = lastIndex;
+        }
+    }
+
+    return Indexed{ { image.getWidth(), image.getHeight() }, std::move(indices), std::move(palette) };
+}
+}
 
 namespace dpa::image::utility
 {
@@ -14,22 +95,15 @@ std::optional<Image<YCbCr, stbi_uc>> RGB_To_YCbCr(const Image<RGB, stbi_uc>& ima
 
     Image<YCbCr, stbi_uc> ret{ std::make_tuple(image.getWidth(), image.getHeight()) };
 
-    // Transform each pixel of the source image and copy it into the ret value
-    auto setResult = foreach_pixel(image, [&](internal::Point2D pos, std::optional<RGB<stbi_uc>> pixel)
-        {
-            const auto [R, G, B] = pixel.value();
-    
-            auto Y = static_cast<stbi_uc>(  0.299000 * R + 0.587000 * G + 0.114000 * B);
-            auto Cb = static_cast<stbi_uc>(-0.168736 * R - 0.331264 * G + 0.500000 * B + 128);
-            auto Cr = static_cast<stbi_uc>( 0.500000 * R - 0.418688 * G - 0.081312 * B + 128);
-            
-            return ret.setPixelAt(pos, make_pixel<YCbCr>(Y, Cb, Cr));
-        });
-    
-    if (setResult)
-        return std::make_optional(ret);
-
-    return {};
+    const auto source = image.pixels();
+    const auto dest = ret.pixels();
+
+    // Convert a whole row at a time with the fastest kernel this machine supports
+    const auto convertRow = internal::GetColorKernels().rgbToYCbCr;
+    for (auto h = 0; h < source.getHeight(); ++h)
+        convertRow(source.row(h).data(), dest.row(h).data(), source.getWidth());
+
+    return std::make_optional(std::move(ret));
 }
 
 template<>
@@ -40,21 +114,26 @@ std::optional<Image<RGB, stbi_uc>> YCbCr_To_RGB(const Image<YCbCr, stbi_uc>& ima
 
     Image<RGB, stbi_uc> ret{ std::make_tuple(image.getWidth(), image.getHeight()) };
 
-    // Transform each pixel of the source image and copy it into the ret value
-    auto setResult = foreach_pixel(image, [&](internal::Point2D pos, std::optional<YCbCr<stbi_uc>> pixel)
-        {
-            const auto [Y, Cb, Cr] = pixel.value();
-    
-            auto R = static_cast<stbi_uc>(Y + 1.402000 * (Cr - 128));
-            auto G = static_cast<stbi_uc>(Y - 0.344136 * (Cb - 128) - 0.714136 * (Cr - 128));
-            auto B = static_cast<stbi_uc>(Y + 1.772000 * (Cb - 128));
-    
-            return ret.setPixelAt(pos, make_pixel<RGB>(R, G, B));
-        });
-
-    if (setResult)
-        return std::make_optional(ret);
-
-    return {};
+    const auto source = image.pixels();
+    const auto dest = ret.pixels();
+
+    // Convert a whole row at a time with the fastest kernel this machine supports
+    const auto convertRow = internal::GetColorKernels().yCbCrToRGB;
+    for (auto h = 0; h < source.getHeight(); ++h)
+        convertRow(source.row(h).data(), dest.row(h).data(), source.getWidth());
+
+    return std::make_optional(std::move(ret));
+}
+
+template<>
+std::optional<IndexedImage<RGB, stbi_uc>> Palettize(const Image<RGB, stbi_uc>& image)
+{
+    return PalettizeImpl(image);
+}
+
+template<>
+std::optional<IndexedImage<YCbCr, stbi_uc>> Palettize(const Image<YCbCr, stbi_uc>& image)
+{
+    return PalettizeImpl(image);
 }
 }
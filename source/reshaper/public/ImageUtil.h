@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Image.h>
+#include <IndexedImage.h>
 
 #include <optional>
 #include <type_traits>
@@ -19,23 +20,14 @@ namespace dpa::image::utility
 template<template<typename> class Channels, typename BitDepth, typename Predicate>
 bool foreach_pixel_mutable(dpa::image::Image<Channels, BitDepth>& image, Predicate pred)
 {
-    for (auto h = 0; h < image.getHeight(); ++h)
+    const auto pixels = image.pixels();
+    for (auto h = 0; h < pixels.getHeight(); ++h)
     {
-        for (auto w = 0; w < image.getWidth(); ++w)
-        {
-            // Retrieve the pixel
-            if (auto sourcePixel = image.getPixelAt({ w, h }); sourcePixel)
-            {
-                // If we were able to get it, transform it using the predicate,
-                // then set the transformation back into the image
-                if (!image.setPixelAt({ w, h }, pred(sourcePixel.value())))
-                    return false;
-            }
-            else
-            {
-                return false;
-            }
-        }
+        // Transform each pixel using the predicate, then set the
+        // transformation back into the image
+        const auto row = pixels.row(h);
+        for (auto w = 0; w < row.size(); ++w)
+            row.set(w, pred(row[w]));
     }
 
     return true;
@@ -53,20 +45,14 @@ bool foreach_pixel_mutable(dpa::image::Image<Channels, BitDepth>& image, Predica
 template<template<typename> class Channels, typename BitDepth, typename Predicate>
 bool foreach_pixel(const dpa::image::Image<Channels, BitDepth>& image, Predicate pred)
 {
-    for (auto h = 0; h < image.getHeight(); ++h)
+    const auto pixels = image.pixels();
+    for (auto h = 0; h < pixels.getHeight(); ++h)
     {
-        for (auto w = 0; w < image.getWidth(); ++w)
+        const auto row = pixels.row(h);
+        for (auto w = 0; w < row.size(); ++w)
         {
-            // Retrieve the pixel
-            if (auto sourcePixel = image.getPixelAt({ w, h }); sourcePixel)
-            {
-                if (!pred({ w, h }, sourcePixel.value()))
-                    return false;
-            }
-            else
-            {
+            if (!pred(internal::Point2D{ w, h }, row[w]))
                 return false;
-            }
         }
     }
 
@@ -90,4 +76,16 @@ std::optional<Image<YCbCr, BitDepth>> RGB_To_YCbCr(const Image<Channels, BitDept
 */
 template<template<typename> class Channels, typename BitDepth>
 std::optional<Image<RGB, BitDepth>> YCbCr_To_RGB(const Image<Channels, BitDepth>& image);
+
+/*
+    Palettizes an image, replacing each pixel with an index into a table of
+    the distinct colours it uses. Most pixel art fits in a byte per pixel,
+    so images with more colours than a palette can hold aren't palettized
+
+    @param image The image to palettize
+    @returns The palettized image, or an empty optional if the image is empty
+             or uses more colours than a palette can hold
+*/
+template<template<typename> class Channels, typename BitDepth>
+std::optional<IndexedImage<Channels, BitDepth>> Palettize(const Image<Channels, BitDepth>& image);
 }
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <ImageView.h>
+#include <Pixel.h>
+
+#include <cstddef>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace dpa::image
+{
+/*
+    Represents a palettized image. Each pixel is a single byte indexing into
+    a palette of at most 256 colours, which is all most pixel art uses
+*/
+template<template<typename> class Channels, typename BitDepth>
+class IndexedImage final
+{
+public:
+
+    using Pixel = Channels<BitDepth>;
+
+    // The most colours a palette can hold, so every index fits in a byte
+    static constexpr std::size_t kMaxColors = 256;
+
+public:
+
+    IndexedImage() = default;
+    IndexedImage(const internal::Point2D& dimensions, std::vector<stbi_uc> indices, std::vector<Pixel> palette);
+
+    int getWidth() const noexcept { return m_width; }
+    int getHeight() const noexcept { return m_height; }
+
+    const std::vector<stbi_uc>& getIndices() const noexcept { return m_indices; }
+    const std::vector<Pixel>& getPalette() const noexcept { return m_palette; }
+
+    std::optional<stbi_uc> getIndexAt(const internal::Point2D& position) const noexcept;
+    std::optional<Pixel> getPixelAt(const internal::Point2D& position) const;
+
+private:
+
+    int m_width{ 0 };
+    int m_height{ 0 };
+
+    std::vector<stbi_uc> m_indices{};
+    std::vector<Pixel> m_palette{};
+};
+
+/*
+    Constructs an indexed image from its pixel indices and palette
+
+    @param dimensions The width and height of the image
+    @param indices The palette index of each pixel, in row-major order
+    @param palette The colours the indices refer to
+*/
+template<template<typename> class Channels, typename BitDepth>
+IndexedImage<Channels, BitDepth>::IndexedImage(const internal::Point2D& dimensions,
+    std::vector<stbi_uc> indices, std::vector<Pixel> palette)
+    : m_indices(std::move(indices)), m_palette(std::move(palette))
+{
+    std::tie(m_width, m_height) = dimensions;
+}
+
+/*
+    Gets the palette index of the pixel at the given position
+
+    @param position The x and y position of the pixel
+    @returns The pixel's palette index, or an empty optional if the position is out of bounds
+*/
+template<template<typename> class Channels, typename BitDepth>
+std::optional<stbi_uc> IndexedImage<Channels, BitDepth>::getIndexAt(const internal::Point2D& position) const noexcept
+{
+    const auto [x, y] = position;
+    if (x < 0 || y < 0 || x >= m_width || y >= m_height)
+        return std::nullopt;
+
+    return m_indices[static_cast<std::size_t>(y) * m_width + x];
+}
+
+/*
+    Gets the colour of the pixel at the given position
+
+    @param position The x and y position of the pixel
+    @returns The pixel's colour, or an empty optional if the position is out of bounds
+*/
+template<template<typename> class Channels, typename BitDepth>
+std::optional<typename IndexedImage<Channels, BitDepth>::Pixel>
+    IndexedImage<Channels, BitDepth>::getPixelAt(const internal::Point2D& position) const
+{
+    if (const auto index = getIndexAt(position); index)
+        return m_palette[index.value()];
+
+    return std::nullopt;
+}
+}
@@ -1,12 +1,9 @@
 #include <IslandsHeuristic.h>
 
-#include <boost/uuid/uuid.hpp>
-#include <boost/uuid/uuid_generators.hpp>
-
 namespace dpa::graph::heuristics
 {
 Islands::Islands()
-    : m_uuid(boost::uuids::random_generator()())
+    : m_marks(std::make_shared<EdgeMarks>())
 {}
 
 Islands::Islands(const utility::Point2D<int>& imageDims)
@@ -25,19 +22,29 @@ Islands& Islands::operator=(const Islands& other)
     if (this == &other)
         return *this;
 
-    m_uuid = other.m_uuid;
+    m_marks = other.m_marks;
     m_imageDims = other.m_imageDims;
 
     return *this;
 }
 
-const HeuristicHelper::EdgeMap& Islands::getMarkedEdges() const noexcept
+EdgeMarks::EdgeMap Islands::getMarkedEdges() const
+{
+    return m_marks->toEdgeMap();
+}
+
+const EdgeMarks& Islands::getEdgeMarks() const noexcept
 {
-    return HeuristicHelper::instance().getMarkedEdges(m_uuid);
+    return *m_marks;
 }
 
 void Islands::clearMarkedEdges() const noexcept
 {
-    HeuristicHelper::instance().clearMarkedEdges(m_uuid);
+    m_marks->clear();
+}
+
+void Islands::resetMarkedEdges(std::size_t numMarks) const
+{
+    m_marks->reset(numMarks);
+}
 }
-}
\ No newline at end of file
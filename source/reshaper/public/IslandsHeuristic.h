@@ -3,12 +3,9 @@
 #include <GraphUtils.h>
 #include <HeuristicHelper.h>
 
-#include <boost/graph/depth_first_search.hpp>
+#include <memory>
 
-namespace boost::uuids
-{
-    struct uuid;
-}
+#include <boost/graph/depth_first_search.hpp>
 
 namespace dpa::graph::heuristics
 {
@@ -17,7 +14,7 @@ class Islands : public boost::default_dfs_visitor, IMarkedEdgeHelper
 public:
 
     /*
-        Default constructor. Creates the uuid for this instance
+        Default constructor. Creates the mark buffer for this instance
     */
     Islands();
 
@@ -28,14 +25,14 @@ public:
     explicit Islands(const utility::Point2D<int>& imageDims);
 
     /*
-        Copy constructor, which sets this uuid to other's uuid
+        Copy constructor, which shares other's mark buffer
 
         @param other Another islands heuristic to create this object from
     */
     Islands(const Islands& other);
 
     /*
-        Copy assignment. This sets this uuid to the other's uuid
+        Copy assignment. This shares the other's mark buffer
 
         @param other Another islands heuristic to create this object from
         @returns A reference to this instance
@@ -67,30 +64,95 @@ public:
             return;
         }
 
-        auto hasValance1Node = [&](Vertex source, Vertex target)
+        const auto [xSource, xTarget] = utility::GetCrossingEdge(edgeSource, edgeTarget, imageWidth);
+        if (auto [crossingEdge, found] = boost::edge(xSource, xTarget, graph); found)
+            examine_crossing(edge, crossingEdge, graph);
+    }
+
+    /*
+        Resolves a pair of crossing edges by marking the edge the vote favours
+
+        @param edge The diagonal edge being examined
+        @param crossingEdge The diagonal edge that crosses it
+        @param graph The graph containing the edges we're looking at
+    */
+    template <class Edge, class Graph>
+    void examine_crossing(Edge edge, Edge crossingEdge, const Graph& graph)
+    {
+        if (const double weight = vote(edge, crossingEdge, graph); weight > 0)
+            m_marks->mark(edge, weight);
+        else if (weight < 0)
+            m_marks->mark(crossingEdge, -weight);
+    }
+
+    /*
+        Votes on a pair of crossing edges, favouring the edge that
+        would leave an island behind if it were cut
+
+        @param edge The diagonal edge being examined
+        @param crossingEdge The diagonal edge that crosses it
+        @param graph The graph containing the edges we're looking at
+        @returns The weight awarded to the edge if it's positive, the weight
+                 awarded to the crossing edge if it's negative, or zero for a tie
+    */
+    template <class Edge, class Graph>
+    double vote(Edge edge, Edge crossingEdge, const Graph& graph) const
+    {
+        auto hasValance1Node = [&](const Edge& candidate)
         {
-            return boost::out_degree(source, graph) == 1 || boost::out_degree(target, graph) == 1;
+            return boost::out_degree(boost::source(candidate, graph), graph) == 1 ||
+                   boost::out_degree(boost::target(candidate, graph), graph) == 1;
         };
 
-        const auto [xSource, xTarget] = utility::GetCrossingEdge(edgeSource, edgeTarget, imageWidth);
-        if (auto [crossingEdge, found] = boost::edge(xSource, xTarget, graph); found)
+        bool edgeHasIsland = hasValance1Node(edge);
+        bool crossingHasIsland = hasValance1Node(crossingEdge);
+
+        if (edgeHasIsland && !crossingHasIsland)
+            return 2.5;
+        else if (!edgeHasIsland && crossingHasIsland)
+            return -2.5;
+
+        return 0;
+    }
+
+    /*
+        Votes on both diagonals of a crossing block, checking each
+        corner's valence once
+
+        @param topLeft The top left vertex of the crossing block
+        @param graph The graph containing the block
+        @returns The weights awarded to each orientation of the block's diagonals
+    */
+    template <class Graph>
+    BlockWeights voteOnBlock(std::size_t topLeft, const Graph& graph) const
+    {
+        const auto imageWidth = static_cast<std::size_t>(std::get<0>(m_imageDims));
+        auto isIsland = [&](std::size_t vertex)
         {
-            bool edgeHasIsland = hasValance1Node(edgeSource, edgeTarget);
-            bool crossingHasIsland = hasValance1Node(xSource, xTarget);
+            return boost::out_degree(vertex, graph) == 1;
+        };
 
-            if (edgeHasIsland && !crossingHasIsland)
-                HeuristicHelper::instance().insertMarkedEdge(m_uuid, { edgeSource, edgeTarget }, 2.5);
-            else if (!edgeHasIsland && crossingHasIsland)
-                HeuristicHelper::instance().insertMarkedEdge(m_uuid, { xSource, xTarget }, 2.5);
-        }
+        const bool backwardHasIsland = isIsland(topLeft) || isIsland(topLeft + imageWidth + 1);
+        const bool forwardHasIsland = isIsland(topLeft + 1) || isIsland(topLeft + imageWidth);
+
+        double vote = 0;
+        if (backwardHasIsland && !forwardHasIsland)
+            vote = 2.5;
+        else if (!backwardHasIsland && forwardHasIsland)
+            vote = -2.5;
+
+        // Both orientations of a diagonal have the same end points, so they get the same vote
+        return SplitBlockVotes(vote, vote);
     }
 
-    const HeuristicHelper::EdgeMap& getMarkedEdges() const noexcept override;
+    EdgeMarks::EdgeMap getMarkedEdges() const override;
+    const EdgeMarks& getEdgeMarks() const noexcept override;
     void clearMarkedEdges() const noexcept override;
+    void resetMarkedEdges(std::size_t numMarks) const override;
 
 private:
 
-    boost::uuids::uuid m_uuid;
+    std::shared_ptr<EdgeMarks> m_marks;
     utility::Point2D<int> m_imageDims{};
 
 };
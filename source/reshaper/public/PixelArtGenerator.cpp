@@ -0,0 +1,138 @@
+#include <PixelArtGenerator.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+/*
+    Draws numbers from std::mt19937, whose sequence is the same everywhere,
+    without the standard distributions, whose results aren't
+*/
+class Random final
+{
+public:
+
+    explicit Random(std::uint32_t seed)
+        : m_engine(seed)
+    {}
+
+    /*
+        Draws a number that's less than the given bound
+
+        @param bound One past the largest number to draw
+
+        @returns The number drawn
+    */
+    std::size_t below(std::size_t bound) noexcept
+    {
+        return static_cast<std::size_t>(m_engine() % bound);
+    }
+
+    /*
+        Draws whether something with the given chance happens
+
+        @param chance The chance of it happening, from 0 to 1
+
+        @returns True if it happens, false otherwise
+    */
+    bool happens(double chance) noexcept
+    {
+        return m_engine() < chance * 4294967296.0;
+    }
+
+private:
+
+    std::mt19937 m_engine;
+};
+
+using Pixel = std::array<stbi_uc, 3>;
+}
+
+namespace dpa::image::utility
+{
+Image<RGB, stbi_uc> GeneratePixelArt(const PixelArtSettings& settings)
+{
+    const auto width = settings.width;
+    const auto height = settings.height;
+    if (width <= 0 || height <= 0)
+        return {};
+
+    Random random{ settings.seed };
+
+    // Colours are redrawn until they're distinct, so the palette really has as many as asked for
+    const auto paletteSize = std::clamp<std::size_t>(settings.paletteSize, 2, 256);
+    std::vector<Pixel> palette;
+    while (palette.size() < paletteSize)
+    {
+        const Pixel color = { static_cast<stbi_uc>(random.below(256)),
+                              static_cast<stbi_uc>(random.below(256)),
+                              static_cast<stbi_uc>(random.below(256)) };
+
+        if (std::find(std::cbegin(palette), std::cend(palette), color) == std::cend(palette))
+            palette.push_back(color);
+    }
+
+    const auto otherColor = [&](std::size_t color)
+    {
+        return (color + 1 + random.below(paletteSize - 1)) % paletteSize;
+    };
+
+    std::vector<std::size_t> colors(static_cast<std::size_t>(width) * height);
+    const auto at = [&](int x, int y) -> std::size_t& { return colors[static_cast<std::size_t>(y) * width + x]; };
+
+    // Lay down the regions, dithering the ones that aren't flat in a checkerboard
+    const auto regionSize = std::max(settings.regionSize, 1);
+    for (int top = 0; top < height; top += regionSize)
+    {
+        for (int left = 0; left < width; left += regionSize)
+        {
+            const auto base = random.below(paletteSize);
+            const auto dither = otherColor(base);
+            const bool isFlat = random.happens(settings.flatFraction);
+
+            for (int y = top; y < std::min(top + regionSize, height); ++y)
+            {
+                for (int x = left; x < std::min(left + regionSize, width); ++x)
+                {
+                    const bool isDithered = !isFlat && (x + y) % 2 == 0 && random.happens(settings.ditherDensity);
+                    at(x, y) = isDithered ? dither : base;
+                }
+            }
+        }
+    }
+
+    // Draw the diagonal strokes, which run down to the left or the right
+    const auto numStrokes = static_cast<std::size_t>(settings.diagonalDensity * (width + height));
+    for (std::size_t stroke = 0; stroke < numStrokes; ++stroke)
+    {
+        auto x = static_cast<int>(random.below(width));
+        auto y = static_cast<int>(random.below(height));
+
+        const int step = random.happens(0.5) ? 1 : -1;
+        const auto length = regionSize + random.below(3 * static_cast<std::size_t>(regionSize));
+        const auto color = random.below(paletteSize);
+
+        for (std::size_t i = 0; i < length && x >= 0 && x < width && y < height; ++i, x += step, ++y)
+            at(x, y) = color;
+    }
+
+    // Scatter the islands last, so the strokes don't paint over them
+    for (auto& color : colors)
+    {
+        if (random.happens(settings.islandFrequency))
+            color = otherColor(color);
+    }
+
+    std::vector<stbi_uc> pixelData;
+    pixelData.reserve(colors.size() * 3);
+    for (const auto color : colors)
+        pixelData.insert(std::end(pixelData), std::cbegin(palette[color]), std::cend(palette[color]));
+
+    return Image<RGB, stbi_uc>{ std::make_tuple(width, height), pixelData.data() };
+}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Image.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dpa::image::utility
+{
+/*
+    The properties of a piece of synthetic pixel art. Each one drives the cost
+    of a different part of the pipeline: dithering and islands are what the
+    sparse pixels and islands heuristics weigh, diagonal strokes are what the
+    curves heuristic follows, and flat regions are where cells weld together
+*/
+struct PixelArtSettings
+{
+    // The same seed and settings always generate the same image
+    std::uint32_t seed{ 0 };
+
+    int width{ 64 };
+    int height{ 64 };
+
+    // The number of colours the image is drawn with, from 2 to 256
+    std::size_t paletteSize{ 8 };
+
+    // The side of the square regions each colour is laid down in
+    int regionSize{ 8 };
+
+    // The fraction of regions that are a single flat colour. The rest are
+    // dithered between two colours
+    double flatFraction{ 0.75 };
+
+    // The fraction of a dithered region's checkerboard cells drawn in its second colour
+    double ditherDensity{ 0.5 };
+
+    // The number of one pixel wide diagonal strokes, per pixel along the image's edges
+    double diagonalDensity{ 0.05 };
+
+    // The chance of any one pixel being a lone island of another colour
+    double islandFrequency{ 0.005 };
+};
+
+/*
+    Generates a piece of pixel art with the given properties. The generator
+    only uses the raw output of std::mt19937, so an image is the same on
+    every platform
+
+    @param settings The properties of the image to generate
+
+    @returns The generated image, which counts as loaded, or an empty image
+             if the dimensions aren't positive
+*/
+Image<RGB, stbi_uc> GeneratePixelArt(const PixelArtSettings& settings);
+}
@@ -0,0 +1,53 @@
+#include <RunArena.h>
+
+namespace dpa::memory
+{
+RunArena::RunArena(std::size_t initialSize, std::pmr::memory_resource* upstream)
+    : m_monotonic(initialSize, upstream), m_synchronized(&m_monotonic)
+{}
+
+void RunArena::release() noexcept
+{
+    m_monotonic.release();
+    m_synchronized.resetBytesAllocated();
+}
+
+std::size_t RunArena::getBytesAllocated() const noexcept
+{
+    return m_synchronized.getBytesAllocated();
+}
+
+std::size_t RunArena::SynchronizedResource::getBytesAllocated() const noexcept
+{
+    std::lock_guard lock{ m_mutex };
+    return m_bytesAllocated;
+}
+
+void RunArena::SynchronizedResource::resetBytesAllocated() noexcept
+{
+    std::lock_guard lock{ m_mutex };
+    m_bytesAllocated = 0;
+}
+
+void* RunArena::SynchronizedResource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    std::lock_guard lock{ m_mutex };
+
+    void* pointer = m_upstream->allocate(bytes, alignment);
+    m_bytesAllocated += bytes;
+
+    return pointer;
+}
+
+void RunArena::SynchronizedResource::do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment)
+{
+    // Monotonic memory is only reclaimed once the whole arena is released
+    std::lock_guard lock{ m_mutex };
+    m_upstream->deallocate(pointer, bytes, alignment);
+}
+
+bool RunArena::SynchronizedResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace dpa::memory
+{
+/*
+    A region of memory that the allocations made while depixelizing a single
+    image are carved from. Allocating only bumps a pointer, and nothing is
+    freed individually; the whole region is handed back at once when the arena
+    is released or destroyed. Allocating is thread safe, so the parallel builds
+    can share an arena. Nothing allocated from an arena may outlive it
+*/
+class RunArena final
+{
+public:
+
+    // The size of the first block the arena requests, before it starts growing
+    static constexpr std::size_t kDefaultInitialSize = 1 << 20;
+
+public:
+
+    /*
+        Creates an empty arena. No memory is requested until the first allocation
+
+        @param initialSize The size of the first block to request from upstream
+        @param upstream The resource the arena's blocks are requested from
+    */
+    explicit RunArena(std::size_t initialSize = kDefaultInitialSize,
+        std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+    RunArena(const RunArena&) = delete;
+    RunArena& operator=(const RunArena&) = delete;
+
+    /*
+        Gets the memory resource that allocates from the arena
+
+        @returns The arena's memory resource
+    */
+    std::pmr::memory_resource* resource() noexcept { return &m_synchronized; }
+
+    /*
+        Releases everything allocated from the arena at once. Every container
+        using the arena has to be destroyed, or reset, before this is called
+    */
+    void release() noexcept;
+
+    /*
+        Gets the number of bytes allocated from the arena since it was
+        created, or last released
+
+        @returns The number of bytes allocated
+    */
+    std::size_t getBytesAllocated() const noexcept;
+
+private:
+
+    /*
+        Serializes access to a memory resource that isn't thread safe
+    */
+    class SynchronizedResource final : public std::pmr::memory_resource
+    {
+    public:
+
+        explicit SynchronizedResource(std::pmr::memory_resource* upstream) noexcept
+            : m_upstream(upstream)
+        {}
+
+        std::size_t getBytesAllocated() const noexcept;
+        void resetBytesAllocated() noexcept;
+
+    private:
+
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    private:
+
+        std::pmr::memory_resource* m_upstream{ nullptr };
+        std::size_t m_bytesAllocated{ 0 };
+
+        mutable std::mutex m_mutex{};
+    };
+
+private:
+
+    std::pmr::monotonic_buffer_resource m_monotonic;
+    SynchronizedResource m_synchronized;
+
+};
+
+/*
+    An allocator that draws from a memory resource, like the one in a run
+    arena. Unlike std::pmr::polymorphic_allocator, it travels with its
+    container when the container is assigned or swapped, so a container built
+    in an arena can be moved into a member that was default constructed
+*/
+template<typename T>
+class ArenaAllocator
+{
+public:
+
+    using value_type = T;
+
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+public:
+
+    ArenaAllocator() noexcept = default;
+
+    ArenaAllocator(std::pmr::memory_resource* resource) noexcept
+        : m_resource(resource)
+    {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+        : m_resource(other.resource())
+    {}
+
+    T* allocate(std::size_t count)
+    {
+        return static_cast<T*>(m_resource->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* pointer, std::size_t count) noexcept
+    {
+        m_resource->deallocate(pointer, count * sizeof(T), alignof(T));
+    }
+
+    std::pmr::memory_resource* resource() const noexcept { return m_resource; }
+
+private:
+
+    std::pmr::memory_resource* m_resource{ std::pmr::get_default_resource() };
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept
+{
+    return *lhs.resource() == *rhs.resource();
+}
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+}
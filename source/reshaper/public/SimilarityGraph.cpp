@@ -1,6 +1,7 @@
 #include <SimilarityGraph.h>
 
 #include <SimilarityGraphImpl.h>
+#include <Trace.h>
 
 #include <stdexcept>
 
@@ -33,45 +34,96 @@ bool SimilarityGraph::build(const di::Image<di::RGB, stbi_uc>& image)
     return impl()->build(image);
 }
 
+void SimilarityGraph::setMemoryResource(std::pmr::memory_resource* resource) noexcept
+{
+    impl()->setMemoryResource(resource);
+}
+
 void SimilarityGraph::applyHeuristic(heuristics::Heuristic heuristic)
 {
+    using dpa::trace::TraceSpan;
+
     std::visit(HeuristicDispatcher
         {
             [&](const heuristics::Curves& visitor)
                 {
-                    impl()->applyHeuristic(visitor, heuristics::FilteredEdges::eDissimilar);
+                    TraceSpan span{ "Curves", "heuristic" };
+                    {
+                        TraceSpan search{ "search", "heuristic" };
+                        impl()->applyCrossingHeuristic(visitor);
+                    }
+
+                    TraceSpan apply{ "setEdgeProperties", "heuristic" };
                     impl()->setEdgeProperties(visitor, [&](auto&& edge, auto value)
                         {
-                            impl()->m_graph[edge].curvesWeight += std::get<double>(value);
+                            impl()->m_graph[edge].curvesWeight += static_cast<float>(std::get<double>(value));
                         });
+                    impl()->invalidateNeighbourMasks(heuristics::FilteredEdges::eCurves);
                 },
             [&](const heuristics::DissimilarPixels& visitor)
-                {   
-                    impl()->applyHeuristic(visitor);
-                    impl()->setEdgeProperties(visitor, [&](auto edge, auto value)
-                        {
-                            impl()->m_graph[edge].dissimilar = std::get<bool>(value);
-                        });
+                {
+                    TraceSpan span{ "DissimilarPixels", "heuristic" };
+                    {
+                        // The test is local to each edge, so the whole image is compared at once
+                        TraceSpan search{ "search", "heuristic" };
+                        impl()->applyDissimilarHeuristic(visitor);
+                    }
+                    {
+                        TraceSpan apply{ "setEdgeProperties", "heuristic" };
+                        impl()->setEdgeProperties(visitor, [&](auto edge, auto value)
+                            {
+                                impl()->setDissimilar(edge, std::get<bool>(value));
+                            });
+                        impl()->invalidateNeighbourMasks(heuristics::FilteredEdges::eDissimilar);
+                    }
+
+                    // Only the blocks that are still ambiguous need resolving
+                    TraceSpan index{ "indexCrossings", "heuristic" };
+                    impl()->indexCrossings();
                 },
             [&](const heuristics::Islands& visitor)
                 {
-                    impl()->applyHeuristic(visitor, heuristics::FilteredEdges::eDissimilar);
+                    TraceSpan span{ "Islands", "heuristic" };
+                    {
+                        TraceSpan search{ "search", "heuristic" };
+                        impl()->applyCrossingHeuristic(visitor);
+                    }
+
+                    TraceSpan apply{ "setEdgeProperties", "heuristic" };
                     impl()->setEdgeProperties(visitor, [&](auto&& edge, auto value)
                         {
-                            impl()->m_graph[edge].islandsWeight += std::get<double>(value);
+                            impl()->m_graph[edge].islandsWeight += static_cast<float>(std::get<double>(value));
                         });
+                    impl()->invalidateNeighbourMasks(heuristics::FilteredEdges::eIslands);
                 },
             [&](const heuristics::SparsePixels& visitor)
                 {
-                    impl()->applyHeuristic(visitor, heuristics::FilteredEdges::eDissimilar);
+                    TraceSpan span{ "SparsePixels", "heuristic" };
+                    {
+                        TraceSpan search{ "search", "heuristic" };
+                        impl()->applyCrossingHeuristic(visitor);
+                    }
+
+                    TraceSpan apply{ "setEdgeProperties", "heuristic" };
                     impl()->setEdgeProperties(visitor, [&](auto&& edge, auto value)
                         {
-                            impl()->m_graph[edge].sparsePixelsWeight += std::get<double>(value);
+                            impl()->m_graph[edge].sparsePixelsWeight += static_cast<float>(std::get<double>(value));
                         });
+                    impl()->invalidateNeighbourMasks(heuristics::FilteredEdges::eSparsePixels);
                 },
         }, heuristic);
 }
 
+void SimilarityGraph::resolveCrossings()
+{
+    impl()->resolveCrossings();
+}
+
+SimilarityGraphStatistics SimilarityGraph::getStatistics()
+{
+    return impl()->getStatistics();
+}
+
 void SimilarityGraph::printGraph(std::ostream& stream)
 {
     impl()->printGraph(stream);
@@ -87,6 +139,11 @@ std::set<std::tuple<std::size_t, std::size_t>> SimilarityGraph::getEdges(heurist
     return impl()->getEdges(filteredEdges);
 }
 
+const std::vector<std::uint8_t>& SimilarityGraph::getNeighbourMasks(heuristics::FilteredEdges filteredEdges)
+{
+    return impl()->getNeighbourMasks(filteredEdges);
+}
+
 std::shared_ptr<internal::SimilarityGraphImpl> SimilarityGraph::impl()
 {
     return dpa::internal::any_pointer_cast<internal::SimilarityGraphImpl>(Implementation::impl());
@@ -4,10 +4,13 @@
 #include <Image.h>
 #include <Implementation.h>
 
+#include <cstdint>
 #include <memory>
+#include <memory_resource>
 #include <ostream>
 #include <set>
 #include <variant>
+#include <vector>
 
 namespace dpa::graph
 {
@@ -16,6 +19,34 @@ namespace internal
 class SimilarityGraphImpl;
 }
 
+/*
+    Counts describing how a similarity graph was built and resolved
+*/
+struct SimilarityGraphStatistics
+{
+    // One vertex per pixel, and the edges of the 8-connected lattice they start out in
+    std::size_t numVertices{ 0 };
+    std::size_t numEdges{ 0 };
+
+    // The edges that connected dissimilar pixels
+    std::size_t numDissimilarEdges{ 0 };
+
+    // The 2x2 blocks whose diagonals both survived the dissimilar edges
+    std::size_t numCrossings{ 0 };
+
+    // The diagonals cut while resolving the crossings. A cut is credited to every
+    // heuristic whose vote favoured the diagonal that was kept, and a tie, which
+    // cuts both diagonals, isn't credited to any of them
+    std::size_t numCutDiagonals{ 0 };
+    std::size_t numCutByCurves{ 0 };
+    std::size_t numCutByIslands{ 0 };
+    std::size_t numCutBySparsePixels{ 0 };
+    std::size_t numTies{ 0 };
+
+    // The edges left in the graph
+    std::size_t numResolvedEdges{ 0 };
+};
+
 /*
     A graph representation of an image, where each node represents
     a pixel, and connected edges indicate pixels that are similar
@@ -44,6 +75,15 @@ public:
         @returns True if the graph was built, false otherwise
     */
     bool build(const dpa::image::Image<dpa::image::RGB, stbi_uc>& image);
+
+    /*
+        Sets the memory resource the graph's per-image storage is allocated
+        from, like a run arena. This only applies to graphs built afterwards,
+        and the resource has to outlive the graph
+
+        @param resource The memory resource to allocate from
+    */
+    void setMemoryResource(std::pmr::memory_resource* resource) noexcept;
     
     /*
         Applies the given heuristic to the similarity graph,
@@ -53,6 +93,23 @@ public:
     */
     void applyHeuristic(heuristics::Heuristic heuristic);
 
+    /*
+        Resolves the graph in a single pass, which is what applying the
+        dissimilar pixels, curves, islands and sparse pixels heuristics and
+        filtering every edge would do. Dissimilar edges and the losing
+        diagonals of each crossing are removed from the graph, so the
+        resolved edges can be read back without any filters
+    */
+    void resolveCrossings();
+
+    /*
+        Gets counts describing how the graph was built and resolved. The
+        crossings and cuts are only counted by resolveCrossings
+
+        @returns The graph's statistics
+    */
+    SimilarityGraphStatistics getStatistics();
+
     /*
         Prints a non-graphical representation of the graph
 
@@ -79,6 +136,21 @@ public:
     std::set<std::tuple<std::size_t, std::size_t>> getEdges(
         heuristics::FilteredEdges filteredEdges = heuristics::FilteredEdges::eAll) noexcept;
 
+    /*
+        Gets the adjacency of every pixel as a bitmask, in row-major order. Bit n
+        of a mask is set when the pixel is connected to its neighbour in the n-th
+        direction of west, east, north, south, north east, south west, north west
+        and south east. The masks of each combination of filtered edges are cached
+        until a heuristic changes the edges they depend on, so repeated queries
+        don't evaluate the filters again
+
+        @param filteredEdges The edges to filter from the graph. Once the crossings
+                             are resolved, the unfiltered masks are the resolved graph
+        @returns A constant reference to the neighbour masks
+    */
+    const std::vector<std::uint8_t>& getNeighbourMasks(
+        heuristics::FilteredEdges filteredEdges = heuristics::FilteredEdges::eNone);
+
 private:
 
     /*
@@ -1,12 +1,9 @@
 #include <SparsePixelsHeuristic.h>
 
-#include <boost/uuid/uuid.hpp>
-#include <boost/uuid/uuid_generators.hpp>
-
 namespace dpa::graph::heuristics
 {
 SparsePixels::SparsePixels()
-    : m_uuid(boost::uuids::random_generator()())
+    : m_marks(std::make_shared<EdgeMarks>())
 {}
 
 SparsePixels::SparsePixels(const utility::Point2D<int>& imageDims)
@@ -25,19 +22,29 @@ SparsePixels& SparsePixels::operator=(const SparsePixels& other)
     if (this == &other)
         return *this;
 
-    m_uuid = other.m_uuid;
+    m_marks = other.m_marks;
     m_imageDims = other.m_imageDims;
 
     return *this;
 }
 
-const HeuristicHelper::EdgeMap& SparsePixels::getMarkedEdges() const noexcept
+EdgeMarks::EdgeMap SparsePixels::getMarkedEdges() const
+{
+    return m_marks->toEdgeMap();
+}
+
+const EdgeMarks& SparsePixels::getEdgeMarks() const noexcept
 {
-    return HeuristicHelper::instance().getMarkedEdges(m_uuid);
+    return *m_marks;
 }
 
 void SparsePixels::clearMarkedEdges() const noexcept
 {
-    HeuristicHelper::instance().clearMarkedEdges(m_uuid);
+    m_marks->clear();
+}
+
+void SparsePixels::resetMarkedEdges(std::size_t numMarks) const
+{
+    m_marks->reset(numMarks);
+}
 }
-}
\ No newline at end of file
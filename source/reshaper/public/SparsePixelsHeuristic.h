@@ -3,12 +3,9 @@
 #include <GraphUtils.h>
 #include <HeuristicHelper.h>
 
-#include <boost/graph/depth_first_search.hpp>
+#include <memory>
 
-namespace boost::uuids
-{
-    struct uuid;
-}
+#include <boost/graph/depth_first_search.hpp>
 
 namespace dpa::graph::heuristics
 {
@@ -17,7 +14,7 @@ class SparsePixels : public boost::default_dfs_visitor, IMarkedEdgeHelper
 public:
 
     /*
-        Default constructor. Creates the uuid for this instance
+        Default constructor. Creates the mark buffer for this instance
     */
     SparsePixels();
 
@@ -28,14 +25,14 @@ public:
     explicit SparsePixels(const utility::Point2D<int>& imageDims);
 
     /*
-        Copy constructor, which sets this uuid to other's uuid
+        Copy constructor, which shares other's mark buffer
 
         @param other Another sparse pixels heuristic to create this object from
     */
     SparsePixels(const SparsePixels& other);
 
     /*
-        Copy assignment. This sets this uuid to the other's uuid
+        Copy assignment. This shares the other's mark buffer
 
         @param other Another sparse pixels heuristic to create this object from
         @returns A reference to this instance
@@ -61,37 +58,86 @@ public:
 
         const auto [xSource, xTarget] = utility::GetCrossingEdge(edgeSource, edgeTarget, imageWidth);
         if (auto [crossingEdge, found] = boost::edge(xSource, xTarget, graph); found)
-        {
-            auto extents = getSearchExtents(edge, crossingEdge, graph);
-
-            long long lengthA = getComponentSize(edgeSource, graph, extents);
-            long long lengthB = getComponentSize(boost::source(crossingEdge, graph), graph, extents);
-        
-            // I'm cutting edge weights in half due to the graph being
-            // undirected. There's two edges for each connection between
-            // pixels, and so the weights are doubled
-            if (lengthA < lengthB)
-            {
-                HeuristicHelper::instance().insertMarkedEdge(m_uuid,
-                    { edgeSource, edgeTarget }, (lengthB - lengthA) / 2.0);
-            }
-            else if (lengthB < lengthA)
-            {
-                HeuristicHelper::instance().insertMarkedEdge(m_uuid,
-                    { xSource , xTarget }, (lengthA - lengthB) / 2.0);
-            }
-        }
+            examine_crossing(edge, crossingEdge, graph);
+    }
+
+    /*
+        Resolves a pair of crossing edges by marking the edge the vote favours
+
+        @param edge The diagonal edge being examined
+        @param crossingEdge The diagonal edge that crosses it
+        @param graph The graph containing the edges we're looking at
+    */
+    template <class Edge, class Graph>
+    void examine_crossing(Edge edge, Edge crossingEdge, const Graph& graph)
+    {
+        if (const double weight = vote(edge, crossingEdge, graph); weight > 0)
+            m_marks->mark(edge, weight);
+        else if (weight < 0)
+            m_marks->mark(crossingEdge, -weight);
+    }
+
+    /*
+        Votes on a pair of crossing edges by comparing the sizes of the
+        components each edge belongs to, within a window around them.
+        The smaller component is awarded the difference in sizes as an
+        additional edge weight
+
+        @param edge The diagonal edge being examined
+        @param crossingEdge The diagonal edge that crosses it
+        @param graph The graph containing the edges we're looking at
+        @returns The weight awarded to the edge if it's positive, the weight
+                 awarded to the crossing edge if it's negative, or zero for a tie
+    */
+    template <class Edge, class Graph>
+    double vote(Edge edge, Edge crossingEdge, const Graph& graph) const
+    {
+        auto extents = getSearchExtents(edge, crossingEdge, graph);
+
+        long long lengthA = getComponentSize(boost::source(edge, graph), graph, extents);
+        long long lengthB = getComponentSize(boost::source(crossingEdge, graph), graph, extents);
+
+        // I'm cutting edge weights in half due to the graph being
+        // undirected. There's two edges for each connection between
+        // pixels, and so the weights are doubled
+        return (lengthB - lengthA) / 2.0;
     }
 
-    const HeuristicHelper::EdgeMap& getMarkedEdges() const noexcept override;
+    /*
+        Votes on both diagonals of a crossing block. Each diagonal joins its end
+        points into one component, so the block only has two component sizes,
+        and they're shared by every orientation
+
+        @param topLeft The top left vertex of the crossing block
+        @param graph The graph containing the block
+        @returns The weights awarded to each orientation of the block's diagonals
+    */
+    template <class Graph>
+    BlockWeights voteOnBlock(std::size_t topLeft, const Graph& graph) const
+    {
+        const auto imageWidth = std::get<0>(m_imageDims);
+        const auto [x, y] = utility::ExpandIndex<long long>(topLeft, imageWidth);
+        const Extents extents{ x - kSearchRadius, y - kSearchRadius, x + 1 + kSearchRadius, y + 1 + kSearchRadius };
+
+        const long long backwardSize = getComponentSize(topLeft, graph, extents);
+        const long long forwardSize = getComponentSize(topLeft + 1, graph, extents);
+
+        const double vote = (forwardSize - backwardSize) / 2.0;
+        return SplitBlockVotes(vote, vote);
+    }
+
+    EdgeMarks::EdgeMap getMarkedEdges() const override;
+    const EdgeMarks& getEdgeMarks() const noexcept override;
     void clearMarkedEdges() const noexcept override;
+    void resetMarkedEdges(std::size_t numMarks) const override;
 
 private:
 
     using Extents = std::tuple<long long, long long, long long, long long>;
 
-    template<typename Vertex>
-    bool withinExtents(Vertex vertex, const Extents& extents) const noexcept;
+    // How far the search window reaches past the crossing's 2x2 block of pixels
+    static constexpr long long kSearchRadius = 3;
+    static constexpr std::size_t kWindowSize = 2 + 2 * kSearchRadius;
 
     template<typename Edge, typename Graph>
     Extents getSearchExtents(const Edge& first, const Edge& second, const Graph& graph) const noexcept;
@@ -101,20 +147,11 @@ private:
 
 private:
 
-    boost::uuids::uuid m_uuid;
+    std::shared_ptr<EdgeMarks> m_marks;
     utility::Point2D<int> m_imageDims{};
 
 };
 
-template<typename Vertex>
-bool SparsePixels::withinExtents(Vertex vertex, const Extents& extents) const noexcept
-{
-    const auto [x, y] = utility::ExpandIndex<long long>(vertex, std::get<0>(m_imageDims));
-    const auto [left, top, right, bottom] = extents;
-
-    return (left <= x && right >= x) && (bottom >= y && top <= y);
-}
-
 template<typename Edge, typename Graph>
 SparsePixels::Extents SparsePixels::getSearchExtents(const Edge& first,
     const Edge& second, const Graph& graph) const noexcept
@@ -132,10 +169,10 @@ SparsePixels::Extents SparsePixels::getSearchExtents(const Edge& first,
     // clockwise winding order
     return
     {
-        std::min({ x1, x2, x3, x4 }) - 3,
-        std::min({ y1, y2, y3, y4 }) - 3,
-        std::max({ x1, x2, x3, x4 }) + 3,
-        std::max({ y1, y2, y3, y4 }) + 3,
+        std::min({ x1, x2, x3, x4 }) - kSearchRadius,
+        std::min({ y1, y2, y3, y4 }) - kSearchRadius,
+        std::max({ x1, x2, x3, x4 }) + kSearchRadius,
+        std::max({ y1, y2, y3, y4 }) + kSearchRadius,
     };
 }
 
@@ -143,22 +180,11 @@ template<typename Vertex, typename Graph>
 long long SparsePixels::getComponentSize(Vertex vertex, const Graph& graph,
     const Extents& extents) const noexcept
 {
-    // Build the color map to keep track of visited nodes
-    std::vector<boost::default_color_type> colorMap{ boost::num_vertices(graph) };
-    auto colorPropertyMap = boost::make_iterator_property_map(std::begin(colorMap),
-        boost::get(boost::vertex_index, graph), colorMap[0]);
- 
-    long long edgeCount{ 0 };
-    utility::EdgeCounter counter{ edgeCount };
-    boost::depth_first_visit(graph, vertex, counter, colorPropertyMap,
-        [&](Vertex vertex, const Graph& graph)
-        {
-            return !withinExtents(vertex, extents);
-        });
+    // The extents always span a crossing's 2x2 block plus the search radius on each side,
+    // so only the top left corner is needed to place the window
+    const auto origin = utility::Point2D<long long>{ std::get<0>(extents), std::get<1>(extents) };
 
-    // If the dfs hits the terminator function on the
-    // first vertex, then it doesn't process any edges.
-    // There is always at least 1 edge in the curve
-    return edgeCount;
+    return utility::WindowFloodFill<kWindowSize>::CountEdges(graph, vertex,
+        static_cast<std::size_t>(std::get<0>(m_imageDims)), origin);
 }
 }
@@ -1,6 +1,8 @@
 #include <Voronoi.h>
 #include <VoronoiImpl.h>
 
+#include <ImageUtil.h>
+
 #include <any>
 #include <memory>
 #include <tuple>
@@ -18,6 +20,35 @@ void dpa::voronoi::VoronoiDiagram::build(const std::set<BlockEdge>& edges) noexc
     impl()->build(edges);
 }
 
+void VoronoiDiagram::build(const NeighbourMasks& neighbourMasks) noexcept
+{
+    impl()->build(neighbourMasks);
+}
+
+void VoronoiDiagram::setExecutionPolicy(ExecutionPolicy policy) noexcept
+{
+    impl()->setExecutionPolicy(policy);
+}
+
+void VoronoiDiagram::setMemoryResource(std::pmr::memory_resource* resource) noexcept
+{
+    impl()->setMemoryResource(resource);
+}
+
+VoronoiStatistics VoronoiDiagram::getStatistics()
+{
+    return impl()->getStatistics();
+}
+
+ContourSet VoronoiDiagram::extractContours(const dpa::image::Image<dpa::image::RGB, stbi_uc>& image)
+{
+    const auto converted = dpa::image::utility::RGB_To_YCbCr(image);
+    if (!converted)
+        return ContourSet{};
+
+    return impl()->extractContours(*converted);
+}
+
 bool VoronoiDiagram::writeTex(std::ostream& output)
 {
     return impl()->writeTex(output);
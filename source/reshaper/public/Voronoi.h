@@ -1,12 +1,17 @@
 #pragma once
 
+#include <Contours.h>
+#include <Image.h>
 #include <Implementation.h>
 
 #include <any>
+#include <cstdint>
 #include <fstream>
 #include <memory>
+#include <memory_resource>
 #include <tuple>
 #include <set>
+#include <vector>
 
 namespace dpa::voronoi
 {
@@ -15,6 +20,30 @@ namespace internal
 class VoronoiImpl;
 }
 
+/*
+    The execution policies a voronoi diagram can be built with
+*/
+enum class ExecutionPolicy
+{
+    eSequenced, eParallel, eParallelUnsequenced
+};
+
+/*
+    Counts describing the last voronoi diagram that was built
+*/
+struct VoronoiStatistics
+{
+    // The blocks whose cell has any points
+    std::size_t numCells{ 0 };
+
+    std::size_t numVertices{ 0 };
+    std::size_t numEdges{ 0 };
+
+    // The border points shared by two neighbouring cells, which were cut
+    // out and replaced by an edge between the points they were connected to
+    std::size_t numWelds{ 0 };
+};
+
 /*
     Represents a voronoi diagram, built from a resolved similarity graph.
     This graph is the reshaped pixel cells of the original pixel art
@@ -24,6 +53,7 @@ class VoronoiDiagram : private dpa::internal::Implementation
 public:
 
     using BlockEdge = std::tuple<std::size_t, std::size_t>;
+    using NeighbourMasks = std::vector<std::uint8_t>;
 
     /*
         Constructs a new voronoi diagram with the given dimensions
@@ -39,6 +69,52 @@ public:
     */
     void build(const std::set<BlockEdge>& edges) noexcept;
 
+    /*
+        Builds the voronoi diagram from the neighbour masks of a fully
+        resolved similarity graph. This avoids building and searching
+        a set of edges
+
+        @param neighbourMasks   The adjacency of every pixel, in row-major order,
+                                as exported by SimilarityGraph::getNeighbourMasks
+    */
+    void build(const NeighbourMasks& neighbourMasks) noexcept;
+
+    /*
+        Sets the execution policy used by subsequent builds. The diagram
+        built is the same no matter which policy is used
+
+        @param policy   The policy to build the voronoi diagram with
+    */
+    void setExecutionPolicy(ExecutionPolicy policy) noexcept;
+
+    /*
+        Sets the memory resource the per-image storage of subsequent builds is
+        allocated from, like a run arena. The resource has to outlive the diagram
+
+        @param resource The memory resource to allocate from
+    */
+    void setMemoryResource(std::pmr::memory_resource* resource) noexcept;
+
+    /*
+        Gets counts describing the last diagram that was built
+
+        @returns The diagram's statistics
+    */
+    VoronoiStatistics getStatistics();
+
+    /*
+        Extracts the contours of the last diagram that was built. Every edge
+        between the cells of two pixels that aren't connected is part of a
+        contour, which is visible or shading depending on how different the
+        pixels' colours are. Contours end where three or more of them meet,
+        and where a visible contour turns into a shading one
+
+        @param image    The image the diagram was built from
+
+        @returns The contours, or an empty set if the image doesn't match the diagram
+    */
+    ContourSet extractContours(const dpa::image::Image<dpa::image::RGB, stbi_uc>& image);
+
     /*
         Writes a .tex file to the given ostream. This can be compiled into
         a pdf using pdflatex
@@ -2,6 +2,8 @@
 
 #include <Image.h>
 
+#include <utility>
+
 TEST_F(ImageTests, WriteNewImage)
 {
     auto pixelConfig = NewImagePixelConfiguration();
@@ -84,3 +86,70 @@ TEST_F(ImageTests, Save_InvalidPath_NonSupportedExtension)
     ASSERT_TRUE(image.isLoaded());
     EXPECT_FALSE(image.save("../../images/newImage.tiff"));
 }
+
+TEST_F(ImageTests, ConstructFromMemory)
+{
+    const stbi_uc pixelData[] = { 1, 2, 3, 4, 5, 6 };
+
+    // Pixels that came from memory count as loaded, like pixels read from a file
+    Image<RGB, stbi_uc> image{ std::make_tuple(2, 1), pixelData };
+
+    ASSERT_TRUE(image.isLoaded());
+    ASSERT_NE(pixelData, image.getData());
+    EXPECT_EQ(make_pixel<RGB>(4_uc, 5_uc, 6_uc), image.getPixelAt({ 1, 0 }).value());
+
+    Image<RGB, stbi_uc> empty{ std::make_tuple(2, 1), nullptr };
+    EXPECT_FALSE(empty.isLoaded());
+}
+
+TEST_F(ImageTests, CopyIsDeep)
+{
+    Image<RGB, stbi_uc> original{ std::make_tuple(3, 4) };
+    original.setPixelAt({ 1, 2 }, make_pixel<RGB>(1_uc, 2_uc, 3_uc));
+
+    Image<RGB, stbi_uc> copy{ original };
+    ASSERT_NE(original.getData(), copy.getData());
+    EXPECT_EQ(make_pixel<RGB>(1_uc, 2_uc, 3_uc), copy.getPixelAt({ 1, 2 }).value());
+
+    copy.setPixelAt({ 1, 2 }, make_pixel<RGB>(4_uc, 5_uc, 6_uc));
+    EXPECT_EQ(make_pixel<RGB>(1_uc, 2_uc, 3_uc), original.getPixelAt({ 1, 2 }).value());
+}
+
+TEST_F(ImageTests, MoveStealsBuffer)
+{
+    Image<RGB, stbi_uc> original{ std::make_tuple(3, 4) };
+    original.setPixelAt({ 1, 2 }, make_pixel<RGB>(1_uc, 2_uc, 3_uc));
+
+    const auto data = std::as_const(original).getData();
+
+    Image<RGB, stbi_uc> moved{ std::move(original) };
+    EXPECT_EQ(data, std::as_const(moved).getData());
+    EXPECT_EQ(3, moved.getWidth());
+    EXPECT_EQ(4, moved.getHeight());
+    EXPECT_EQ(make_pixel<RGB>(1_uc, 2_uc, 3_uc), moved.getPixelAt({ 1, 2 }).value());
+
+    EXPECT_EQ(nullptr, std::as_const(original).getData());
+    EXPECT_EQ(0, original.getWidth());
+
+    Image<RGB, stbi_uc> assigned;
+    assigned = std::move(moved);
+    EXPECT_EQ(data, std::as_const(assigned).getData());
+}
+
+TEST_F(ImageTests, ShareCopiesOnWrite)
+{
+    Image<RGB, stbi_uc> original{ std::make_tuple(3, 4) };
+    original.setPixelAt({ 1, 2 }, make_pixel<RGB>(1_uc, 2_uc, 3_uc));
+
+    auto shared = original.share();
+    EXPECT_TRUE(shared.isShared());
+    EXPECT_EQ(std::as_const(original).getData(), std::as_const(shared).getData());
+
+    // Writing to the shared image gives it its own buffer
+    shared.setPixelAt({ 1, 2 }, make_pixel<RGB>(4_uc, 5_uc, 6_uc));
+    EXPECT_FALSE(shared.isShared());
+    EXPECT_FALSE(original.isShared());
+
+    EXPECT_EQ(make_pixel<RGB>(1_uc, 2_uc, 3_uc), original.getPixelAt({ 1, 2 }).value());
+    EXPECT_EQ(make_pixel<RGB>(4_uc, 5_uc, 6_uc), shared.getPixelAt({ 1, 2 }).value());
+}
@@ -1,7 +1,14 @@
 #include <ImageUtilTests.h>
 
+#include <ColorConversion.h>
 #include <Image.h>
 #include <ImageUtil.h>
+#include <PixelArtGenerator.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <vector>
 
 using namespace dpa::image::utility;
 
@@ -73,3 +80,161 @@ TEST_F(ImageUtilTests, YCbCr_To_RGB_RoundTrip)
     if (std::filesystem::exists(YCbCrPath))
         std::filesystem::remove(YCbCrPath);
 }
+
+TEST_F(ImageUtilTests, ColorKernelsMatchScalar)
+{
+    using namespace dpa::image::internal;
+
+    const auto scalar = GetColorKernels(ColorKernelIsa::eScalar);
+    const auto detected = static_cast<int>(DetectColorKernelIsa());
+
+    std::mt19937 generator{ 42 };
+    std::uniform_int_distribution<int> channel{ 0, 255 };
+
+    // Odd widths exercise the scalar tails of the vectorized kernels
+    for (auto width : { 1, 7, 8, 9, 10, 17, 33, 64, 67 })
+    {
+        std::vector<stbi_uc> row(width * 3);
+        for (auto& value : row)
+            value = static_cast<stbi_uc>(channel(generator));
+
+        std::vector<stbi_uc> expected(row.size());
+        std::vector<stbi_uc> expectedInverse(row.size());
+        scalar.rgbToYCbCr(row.data(), expected.data(), width);
+        scalar.yCbCrToRGB(row.data(), expectedInverse.data(), width);
+
+        for (auto isa = 0; isa <= detected; ++isa)
+        {
+            const auto kernels = GetColorKernels(static_cast<ColorKernelIsa>(isa));
+
+            std::vector<stbi_uc> actual(row.size());
+            kernels.rgbToYCbCr(row.data(), actual.data(), width);
+            EXPECT_EQ(expected, actual);
+
+            kernels.yCbCrToRGB(row.data(), actual.data(), width);
+            EXPECT_EQ(expectedInverse, actual);
+        }
+    }
+}
+
+TEST_F(ImageUtilTests, RGB_To_YCbCr_MatchesFloatingPoint)
+{
+    Image<RGB, stbi_uc> baseImage{ m_imagePath };
+    ASSERT_TRUE(baseImage.isLoaded());
+
+    auto converted = RGB_To_YCbCr(baseImage);
+    ASSERT_TRUE(converted);
+
+    for (auto h = 0; h < baseImage.getHeight(); ++h)
+    {
+        for (auto w = 0; w < baseImage.getWidth(); ++w)
+        {
+            const auto [R, G, B] = baseImage.getPixelAt({ w, h }).value();
+            const auto [Y, Cb, Cr] = converted.value().getPixelAt({ w, h }).value();
+
+            EXPECT_LE(std::abs(Y - static_cast<int>(0.299000 * R + 0.587000 * G + 0.114000 * B)), 1);
+            EXPECT_LE(std::abs(Cb - static_cast<int>(-0.168736 * R - 0.331264 * G + 0.500000 * B + 128)), 1);
+            EXPECT_LE(std::abs(Cr - static_cast<int>(0.500000 * R - 0.418688 * G - 0.081312 * B + 128)), 1);
+        }
+    }
+}
+
+TEST_F(ImageUtilTests, Palettize)
+{
+    Image<RGB, stbi_uc> baseImage{ m_imagePath };
+    ASSERT_TRUE(baseImage.isLoaded());
+
+    auto indexed = Palettize(baseImage);
+    ASSERT_TRUE(indexed);
+    EXPECT_EQ(baseImage.getWidth(), indexed.value().getWidth());
+    EXPECT_EQ(baseImage.getHeight(), indexed.value().getHeight());
+    EXPECT_LE(indexed.value().getPalette().size(), (IndexedImage<RGB, stbi_uc>::kMaxColors));
+
+    // Every pixel's palette entry has to be the colour it replaced
+    for (auto h = 0; h < baseImage.getHeight(); ++h)
+    {
+        for (auto w = 0; w < baseImage.getWidth(); ++w)
+            EXPECT_EQ(baseImage.getPixelAt({ w, h }), indexed.value().getPixelAt({ w, h }));
+    }
+
+    // Every colour in the palette is distinct
+    auto palette = indexed.value().getPalette();
+    std::sort(std::begin(palette), std::end(palette));
+    EXPECT_EQ(std::end(palette), std::adjacent_find(std::begin(palette), std::end(palette)));
+}
+
+TEST_F(ImageUtilTests, PalettizeTooManyColors)
+{
+    // One more colour than a palette can hold
+    Image<RGB, stbi_uc> image{ std::make_tuple(257, 1) };
+
+    const auto row = image.pixels().row(0);
+    for (auto w = 0; w < row.size(); ++w)
+        row.set(w, { static_cast<stbi_uc>(w % 256), static_cast<stbi_uc>(w / 256), 0 });
+
+    EXPECT_FALSE(Palettize(image));
+
+    // Repeating a colour brings it back within the palette
+    row.set(256, { 0, 0, 0 });
+
+    auto indexed = Palettize(image);
+    ASSERT_TRUE(indexed);
+    EXPECT_EQ((IndexedImage<RGB, stbi_uc>::kMaxColors), indexed.value().getPalette().size());
+}
+
+TEST_F(ImageUtilTests, GeneratePixelArt)
+{
+    PixelArtSettings settings;
+    settings.seed = 7;
+    settings.width = 96;
+    settings.height = 80;
+    settings.paletteSize = 12;
+
+    const auto image = GeneratePixelArt(settings);
+
+    // Generated images go straight into the pipeline, without a trip to disk
+    ASSERT_TRUE(image.isLoaded());
+    EXPECT_EQ(settings.width, image.getWidth());
+    EXPECT_EQ(settings.height, image.getHeight());
+    EXPECT_TRUE(RGB_To_YCbCr(image));
+
+    const auto indexed = Palettize(image);
+    ASSERT_TRUE(indexed);
+    EXPECT_LE(indexed.value().getPalette().size(), settings.paletteSize);
+
+    // The same seed always generates the same image, and another seed doesn't
+    const auto dataSize = static_cast<std::size_t>(image.getWidth()) * image.getHeight() * image.getChannels();
+    const auto regenerated = GeneratePixelArt(settings);
+    EXPECT_TRUE(std::equal(image.getData(), image.getData() + dataSize, regenerated.getData()));
+
+    settings.seed = 8;
+    const auto reseeded = GeneratePixelArt(settings);
+    EXPECT_FALSE(std::equal(image.getData(), image.getData() + dataSize, reseeded.getData()));
+
+    settings.width = 0;
+    EXPECT_FALSE(GeneratePixelArt(settings).isLoaded());
+}
+
+TEST_F(ImageUtilTests, GenerateFlatPixelArt)
+{
+    PixelArtSettings settings;
+    settings.width = 30;
+    settings.height = 20;
+    settings.regionSize = 10;
+    settings.flatFraction = 1;
+    settings.diagonalDensity = 0;
+    settings.islandFrequency = 0;
+
+    const auto image = GeneratePixelArt(settings);
+    ASSERT_TRUE(image.isLoaded());
+
+    // Without strokes, islands or dithering, every region is a single colour
+    for (auto h = 0; h < image.getHeight(); ++h)
+    {
+        for (auto w = 0; w < image.getWidth(); ++w)
+        {
+            const auto regionOrigin = std::make_tuple(w - w % settings.regionSize, h - h % settings.regionSize);
+            EXPECT_EQ(image.getPixelAt(regionOrigin), image.getPixelAt({ w, h }));
+        }
+    }
+}
@@ -124,4 +124,56 @@ TEST_F(ImageViewTests, SetPixelInvalidPositionOutOfBoundsXY)
 
     auto testPixel = std::make_tuple<stbi_uc, stbi_uc, stbi_uc>(1, 2, 3);
     EXPECT_FALSE(view.setPixelAt({ m_width + 1, m_height + 1 }, testPixel));
-}
\ No newline at end of file
+}
+
+TEST_F(ImageViewTests, RowMatchesGetPixel)
+{
+    RGB8View view{ m_8bitData[2], { m_width, m_height } };
+
+    for (auto h = 0; h < m_height; ++h)
+    {
+        auto row = view.row(h);
+        ASSERT_TRUE(row);
+        ASSERT_EQ(m_width, row->size());
+
+        for (auto w = 0; w < m_width; ++w)
+            EXPECT_EQ(view.getPixelAt({ w, h }).value(), (*row)[w]);
+    }
+}
+
+TEST_F(ImageViewTests, RowInvalidPosition)
+{
+    RGB8View view{ m_8bitData[2], { m_width, m_height } };
+
+    EXPECT_FALSE(view.row(-1));
+    EXPECT_FALSE(view.row(m_height));
+}
+
+TEST_F(ImageViewTests, RowSetPixel)
+{
+    RGB8View view{ m_8bitData[2], { m_width, m_height } };
+
+    auto testPixel = std::make_tuple<stbi_uc, stbi_uc, stbi_uc>(1, 2, 3);
+    view.row(1)->set(2, testPixel);
+
+    EXPECT_EQ(testPixel, view.getPixelAt({ 2, 1 }).value());
+}
+
+TEST_F(ImageViewTests, Subview)
+{
+    RGB8View view{ m_8bitData[2], { m_width, m_height } };
+
+    auto subview = view.pixels().subview({ 1, 2 }, { 3, 4 });
+    ASSERT_TRUE(subview);
+    EXPECT_EQ(3, subview->getWidth());
+    EXPECT_EQ(4, subview->getHeight());
+    EXPECT_EQ(m_width * 3, subview->getStride());
+
+    for (auto h = 0; h < subview->getHeight(); ++h)
+    {
+        for (auto w = 0; w < subview->getWidth(); ++w)
+            EXPECT_EQ(view.getPixelAt({ w + 1, h + 2 }).value(), subview->row(h)[w]);
+    }
+
+    EXPECT_FALSE(view.pixels().subview({ 1, 2 }, { m_width, 1 }));
+}
@@ -0,0 +1,152 @@
+#include <LatticeGraphTests.h>
+
+#include <CurvesHeuristic.h>
+#include <GraphUtils.h>
+#include <SimilarityGraphImpl.h>
+
+#include <iterator>
+
+TEST_F(LatticeGraphTests, ConnectedLattice)
+{
+    const auto graph = makeConnectedLattice(3, 3);
+
+    // 6 horizontal, 6 vertical and 8 diagonal edges
+    EXPECT_EQ(9u, boost::num_vertices(graph));
+    EXPECT_EQ(20u, boost::num_edges(graph));
+
+    const auto [first, last] = boost::edges(graph);
+    EXPECT_EQ(20, std::distance(first, last));
+
+    EXPECT_EQ(3u, boost::out_degree(0, graph));
+    EXPECT_EQ(5u, boost::out_degree(1, graph));
+    EXPECT_EQ(8u, boost::out_degree(4, graph));
+
+    const auto [edge, found] = boost::edge(8, 4, graph);
+    ASSERT_TRUE(found);
+    EXPECT_EQ(LatticeDirection::eNorthWest, edge.direction);
+    EXPECT_FALSE(boost::edge(0, 2, graph).second);
+}
+
+TEST_F(LatticeGraphTests, EdgeIndexSharedByOrientations)
+{
+    auto graph = makeConnectedLattice(3, 3);
+
+    const LatticeEdge forward{ 4, 2, LatticeDirection::eNorthEast };
+    const LatticeEdge reversed{ 2, 4, LatticeDirection::eSouthWest };
+    EXPECT_EQ(forward.index(), reversed.index());
+
+    graph[forward] = 1.5f;
+    EXPECT_EQ(1.5f, graph[reversed]);
+}
+
+TEST_F(LatticeGraphTests, EdgeFlags)
+{
+    auto graph = makeConnectedLattice(3, 3);
+    const auto masks = graph.getNeighbourMasks();
+
+    graph.setEdgeFlag(4, LatticeDirection::eNorthEast, true);
+
+    // Both endpoints see the flag, and nothing else is flagged
+    EXPECT_TRUE(graph.hasEdgeFlag(4, LatticeDirection::eNorthEast));
+    EXPECT_TRUE(graph.hasEdgeFlag(2, LatticeDirection::eSouthWest));
+    EXPECT_TRUE(graph.hasEdgeFlag(LatticeEdge{ 2, 4, LatticeDirection::eSouthWest }));
+    EXPECT_FALSE(graph.hasEdgeFlag(4, LatticeDirection::eSouthWest));
+    EXPECT_FALSE(graph.hasEdgeFlag(2, LatticeDirection::eWest));
+
+    // Flags don't change the connectivity
+    EXPECT_EQ(masks, graph.getNeighbourMasks());
+
+    // And outlive the edge
+    graph.setEdge(2, LatticeDirection::eSouthWest, false);
+    EXPECT_FALSE(graph.hasEdge(4, LatticeDirection::eNorthEast));
+    EXPECT_TRUE(graph.hasEdgeFlag(4, LatticeDirection::eNorthEast));
+
+    graph.setEdgeFlag(2, LatticeDirection::eSouthWest, false);
+    EXPECT_FALSE(graph.hasEdgeFlag(4, LatticeDirection::eNorthEast));
+    EXPECT_FALSE(graph.hasEdgeFlag(2, LatticeDirection::eSouthWest));
+}
+
+TEST_F(LatticeGraphTests, SimilarityGraphEdgeProperty)
+{
+    // The dissimilar flags live in the lattice, so an edge only stores its three weights
+    EXPECT_EQ(3 * sizeof(float), sizeof(dpa::graph::internal::EdgeProperty));
+}
+
+TEST_F(LatticeGraphTests, ValenceChainsMatchCurveSearch)
+{
+    const auto graph = makeCurveLattice();
+
+    dpa::graph::utility::ValenceChains chains;
+    chains.build(graph);
+
+    // The open curve, the junction's branches, the closed loop and the curve that ends where it starts
+    EXPECT_EQ(4, chains.getCurveLength(1));
+    EXPECT_EQ(2, chains.getCurveLength(16));
+    EXPECT_EQ(2, chains.getCurveLength(21));
+    EXPECT_EQ(3, chains.getCurveLength(12));
+    EXPECT_EQ(2, chains.getCurveLength(10));
+
+    // Every vertex gets the curve length a search from it would have found
+    for (std::size_t vertex = 0; vertex < boost::num_vertices(graph); ++vertex)
+    {
+        const auto searched = CountVisitedEdges(graph, vertex, [](std::size_t v, const Graph& g)
+        {
+            return boost::out_degree(v, g) != 2;
+        });
+
+        EXPECT_EQ(searched ? searched : 1, chains.getCurveLength(vertex)) << "vertex " << vertex;
+    }
+}
+
+TEST_F(LatticeGraphTests, CurvesForgetChainsOnReset)
+{
+    const auto curveLattice = makeCurveLattice();
+    const auto connectedLattice = makeConnectedLattice(6, 5);
+
+    dpa::graph::heuristics::Curves curves{ { 6, 5 } };
+
+    // The top right of the first block is on a curve of length 4
+    const dpa::graph::heuristics::BlockWeights curveWeights{ 0.0, 0.0, 1.5, 0.0 };
+    EXPECT_EQ(curveWeights, curves.voteOnBlock(0, curveLattice));
+
+    // A reused heuristic sees the new graph's curves, which are all a single pixel long
+    curves.resetMarkedEdges(0);
+    EXPECT_EQ(dpa::graph::heuristics::BlockWeights{}, curves.voteOnBlock(0, connectedLattice));
+
+    curves.clearMarkedEdges();
+    EXPECT_EQ(curveWeights, curves.voteOnBlock(0, curveLattice));
+}
+
+TEST_F(LatticeGraphTests, WindowFloodFillMatchesWindowSearch)
+{
+    constexpr long long windowSize = 3;
+    constexpr std::size_t width = 6;
+
+    for (const auto& graph : { makeCurveLattice(), makeConnectedLattice(width, 5) })
+    {
+        const auto height = static_cast<long long>(boost::num_vertices(graph) / width);
+
+        // Windows that hang off every side of the image are included
+        for (long long top = -windowSize; top <= height; ++top)
+        {
+            for (long long left = -windowSize; left <= static_cast<long long>(width); ++left)
+            {
+                for (std::size_t vertex = 0; vertex < boost::num_vertices(graph); ++vertex)
+                {
+                    const auto searched = CountVisitedEdges(graph, vertex, [&](std::size_t v, const Graph&)
+                    {
+                        const auto x = static_cast<long long>(v % width);
+                        const auto y = static_cast<long long>(v / width);
+                        return x < left || x >= left + windowSize || y < top || y >= top + windowSize;
+                    });
+
+                    const auto filled = dpa::graph::utility::WindowFloodFill<windowSize>::CountEdges(
+                        graph, vertex, width, { left, top });
+
+                    EXPECT_EQ(searched, filled) << "vertex " << vertex << " in the window at ("
+                                                << left << ", " << top << ")";
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <LatticeGraph.h>
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include <boost/graph/depth_first_search.hpp>
+
+#include <gtest/gtest.h>
+
+using dpa::graph::internal::LatticeDirection;
+using dpa::graph::internal::LatticeEdge;
+
+class LatticeGraphTests : public ::testing::Test
+{
+protected:
+
+    using Graph = dpa::graph::internal::LatticeGraph<int, float>;
+
+    /*
+        Builds a lattice with every pixel connected to all of its neighbours
+
+        @param width The width of the lattice
+        @param height The height of the lattice
+        @returns The connected lattice
+    */
+    Graph makeConnectedLattice(std::size_t width, std::size_t height) const
+    {
+        Graph graph{ width, height };
+
+        constexpr LatticeDirection ownedDirections[] =
+        {
+            LatticeDirection::eEast, LatticeDirection::eSouth,
+            LatticeDirection::eSouthWest, LatticeDirection::eSouthEast
+        };
+
+        for (std::size_t h = 0; h < height; ++h)
+        {
+            for (std::size_t w = 0; w < width; ++w)
+            {
+                for (const auto direction : ownedDirections)
+                {
+                    const auto [dx, dy] = dpa::graph::internal::DirectionOffset(direction);
+                    const auto x = static_cast<long long>(w) + dx;
+                    const auto y = static_cast<long long>(h) + dy;
+
+                    if (x >= 0 && y >= 0 && x < static_cast<long long>(width) && y < static_cast<long long>(height))
+                        graph.setEdge(h * width + w, direction, true);
+                }
+            }
+        }
+
+        return graph;
+    }
+
+    /*
+        Builds a 6x5 lattice out of a handful of curves. There's an open curve that ends on a
+        junction, a closed loop, a curve whose ends land on the same vertex, and some isolated pixels
+
+        @returns The lattice
+    */
+    Graph makeCurveLattice() const
+    {
+        constexpr std::size_t width = 6;
+        Graph graph{ width, 5 };
+
+        const std::initializer_list<std::tuple<std::size_t, std::size_t, LatticeDirection>> edges =
+        {
+            // (0, 0) to the junction at (3, 2), and the junction's two branches
+            { 0, 0, LatticeDirection::eEast }, { 1, 0, LatticeDirection::eEast },
+            { 2, 0, LatticeDirection::eSouthEast }, { 3, 1, LatticeDirection::eSouth },
+            { 3, 2, LatticeDirection::eEast }, { 4, 2, LatticeDirection::eEast },
+            { 3, 2, LatticeDirection::eSouth }, { 3, 3, LatticeDirection::eSouth },
+
+            // A closed loop around (0, 2) to (1, 3)
+            { 0, 2, LatticeDirection::eEast }, { 1, 2, LatticeDirection::eSouth },
+            { 1, 3, LatticeDirection::eWest }, { 0, 3, LatticeDirection::eNorth },
+
+            // Both ends of (4, 0) to (4, 1) land on (5, 0), which also has a dangling (5, 1)
+            { 5, 0, LatticeDirection::eWest }, { 4, 0, LatticeDirection::eSouth },
+            { 4, 1, LatticeDirection::eNorthEast }, { 5, 0, LatticeDirection::eSouth }
+        };
+
+        for (const auto& [x, y, direction] : edges)
+            graph.setEdge(y * width + x, direction, true);
+
+        return graph;
+    }
+
+    /*
+        Counts the edges a boost depth first visit from the given vertex traverses. The
+        vertices the terminator accepts are visited, but their edges aren't followed
+
+        @param graph The graph to search
+        @param start The vertex to start at
+        @param terminator Decides if the search stops at a vertex
+        @returns The number of edges traversed
+    */
+    template<typename Terminator>
+    static long long CountVisitedEdges(const Graph& graph, std::size_t start, Terminator terminator)
+    {
+        std::vector<boost::default_color_type> colorMap(boost::num_vertices(graph));
+        auto colorPropertyMap = boost::make_iterator_property_map(std::begin(colorMap),
+            boost::get(boost::vertex_index, graph), colorMap[0]);
+
+        EdgeCounter counter{};
+        boost::depth_first_visit(graph, start, counter, colorPropertyMap,
+            [&](std::size_t vertex, const Graph& graph)
+            {
+                return terminator(vertex, graph);
+            });
+
+        return *counter.count;
+    }
+
+private:
+
+    /*
+        A dfs visitor that counts the tree edges of a search
+    */
+    struct EdgeCounter : boost::default_dfs_visitor
+    {
+        template<typename Edge, typename G>
+        void tree_edge(Edge, const G&)
+        {
+            ++*count;
+        }
+
+        // Visitors are copied by value, so the count is shared
+        std::shared_ptr<long long> count = std::make_shared<long long>(0);
+    };
+};
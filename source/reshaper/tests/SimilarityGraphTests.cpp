@@ -3,11 +3,15 @@
 #include <Heuristics.h>
 #include <Image.h>
 #include <ImageUtil.h>
+#include <DissimilarityKernels.h>
+#include <SimilarityGraphImpl.h>
 
 #include <algorithm>
+#include <bitset>
 #include <fstream>
 #include <iostream>
 #include <iterator>
+#include <random>
 #include <vector>
 
 using namespace dpa::image;
@@ -137,3 +141,405 @@ TEST_F(SimilarityGraphTests, SparsePixels)
 
     sparsePixels.clearMarkedEdges();
 }
+
+TEST_F(SimilarityGraphTests, MarkedEdgesArePerInstance)
+{
+    Image<RGB, stbi_uc> testImage{ m_skull };
+    m_graph.build(testImage);
+
+    auto first = DissimilarPixels{};
+    auto second = DissimilarPixels{};
+    m_graph.applyHeuristic(first);
+
+    // Copies share their marks, while separate instances don't
+    auto copy = first;
+    EXPECT_FALSE(first.getMarkedEdges().empty());
+    EXPECT_EQ(first.getMarkedEdges(), copy.getMarkedEdges());
+    EXPECT_TRUE(second.getMarkedEdges().empty());
+
+    m_graph.applyHeuristic(second);
+    EXPECT_EQ(first.getMarkedEdges(), second.getMarkedEdges());
+
+    first.clearMarkedEdges();
+    EXPECT_TRUE(copy.getMarkedEdges().empty());
+    EXPECT_FALSE(second.getMarkedEdges().empty());
+
+    second.clearMarkedEdges();
+}
+
+TEST_F(SimilarityGraphTests, EdgeMarksGrow)
+{
+    using dpa::graph::internal::LatticeDirection;
+    using dpa::graph::internal::LatticeEdge;
+
+    // Room for one mark, and many more made than that
+    EdgeMarks marks;
+    marks.reset(1);
+
+    constexpr std::size_t kWidth = 16;
+    for (std::size_t vertex = 0; vertex < 200; ++vertex)
+    {
+        marks.mark(LatticeEdge{ vertex, vertex + kWidth + 1, LatticeDirection::eSouthEast }, 1.0);
+        marks.mark(LatticeEdge{ vertex + kWidth + 1, vertex, LatticeDirection::eNorthWest }, 2.0);
+    }
+
+    // Marking an orientation again overwrites it in place
+    marks.mark(LatticeEdge{ 7, 7 + kWidth + 1, LatticeDirection::eSouthEast }, 3.0);
+
+    const auto& marked = marks.getMarked();
+    ASSERT_EQ(400u, marked.size());
+
+    for (std::size_t vertex = 0; vertex < 200; ++vertex)
+    {
+        EXPECT_EQ(vertex, marked[2 * vertex].first.source);
+        EXPECT_EQ(LatticeDirection::eSouthEast, marked[2 * vertex].first.direction);
+        EXPECT_EQ(vertex == 7 ? 3.0 : 1.0, std::get<double>(marked[2 * vertex].second));
+
+        EXPECT_EQ(vertex, marked[2 * vertex + 1].first.target);
+        EXPECT_EQ(LatticeDirection::eNorthWest, marked[2 * vertex + 1].first.direction);
+        EXPECT_EQ(2.0, std::get<double>(marked[2 * vertex + 1].second));
+    }
+
+    marks.clear();
+    EXPECT_TRUE(marks.getMarked().empty());
+
+    marks.mark(LatticeEdge{ 7, 7 + kWidth + 1, LatticeDirection::eSouthEast }, 4.0);
+    ASSERT_EQ(1u, marks.getMarked().size());
+    EXPECT_EQ(4.0, std::get<double>(marks.getMarked().front().second));
+}
+
+TEST_F(SimilarityGraphTests, CrossingIndex)
+{
+    // The left 2x2 block is a checkerboard, so both of its diagonals survive the
+    // dissimilar pixels heuristic. The right block only has one similar diagonal
+    Image<RGB, stbi_uc> pattern{ std::make_tuple(3, 2) };
+    pattern.setPixelAt({ 0, 0 }, make_pixel<RGB>(0_uc, 0_uc, 0_uc));
+    pattern.setPixelAt({ 1, 0 }, make_pixel<RGB>(255_uc, 255_uc, 255_uc));
+    pattern.setPixelAt({ 2, 0 }, make_pixel<RGB>(255_uc, 255_uc, 255_uc));
+    pattern.setPixelAt({ 0, 1 }, make_pixel<RGB>(255_uc, 255_uc, 255_uc));
+    pattern.setPixelAt({ 1, 1 }, make_pixel<RGB>(0_uc, 0_uc, 0_uc));
+    pattern.setPixelAt({ 2, 1 }, make_pixel<RGB>(255_uc, 255_uc, 255_uc));
+
+    // The graph is only built from loaded images
+    const auto imagePath = std::filesystem::temp_directory_path() / "crossing_index.png";
+    ASSERT_TRUE(pattern.save(imagePath));
+
+    Image<RGB, stbi_uc> testImage{ imagePath };
+    std::filesystem::remove(imagePath);
+
+    dpa::graph::internal::SimilarityGraphImpl graph;
+    ASSERT_TRUE(graph.build(testImage));
+    EXPECT_EQ((std::vector<std::size_t>{ 0, 1 }), graph.getCrossings());
+
+    auto dissimilar = DissimilarPixels{};
+    graph.applyHeuristic(dissimilar);
+    graph.setEdgeProperties(dissimilar, [&](auto edge, auto value)
+        {
+            graph.setDissimilar(edge, std::get<bool>(value));
+        });
+
+    graph.indexCrossings();
+    EXPECT_EQ((std::vector<std::size_t>{ 0 }), graph.getCrossings());
+
+    dissimilar.clearMarkedEdges();
+}
+
+TEST_F(SimilarityGraphTests, CrossingHeuristicsMatchSearch)
+{
+    using dpa::graph::internal::SimilarityGraphImpl;
+
+    for (std::uint32_t seed = 0; seed < 30; ++seed)
+    {
+        const auto testImage = makeNoisyImage(seed, 48, 48);
+        const auto imageDims = std::make_tuple(testImage.getWidth(), testImage.getHeight());
+
+        SimilarityGraphImpl graph;
+        ASSERT_TRUE(graph.build(testImage));
+
+        auto dissimilar = DissimilarPixels{};
+        graph.applyHeuristic(dissimilar);
+        graph.setEdgeProperties(dissimilar, [&](auto edge, auto value)
+            {
+                graph.setDissimilar(edge, std::get<bool>(value));
+            });
+        graph.indexCrossings();
+        dissimilar.clearMarkedEdges();
+
+        ASSERT_FALSE(graph.getCrossings().empty());
+
+        // The crossing index has to mark exactly what a depth first search does
+        const auto expectMatch = [&](const auto& searched, const auto& indexed)
+        {
+            graph.applyHeuristic(searched, FilteredEdges::eDissimilar);
+            graph.applyCrossingHeuristic(indexed);
+
+            EXPECT_EQ(searched.getMarkedEdges(), indexed.getMarkedEdges()) << "seed " << seed;
+
+            searched.clearMarkedEdges();
+            indexed.clearMarkedEdges();
+        };
+
+        expectMatch(Curves{ imageDims }, Curves{ imageDims });
+        expectMatch(Islands{ imageDims }, Islands{ imageDims });
+        expectMatch(SparsePixels{ imageDims }, SparsePixels{ imageDims });
+    }
+}
+
+TEST_F(SimilarityGraphTests, ResolveCrossingsMatchesHeuristics)
+{
+    using dpa::graph::internal::SimilarityGraphImpl;
+
+    // Resolves the graph the way it was before the crossing index, with a depth
+    // first search for every heuristic, and gets the edges that are left
+    const auto searchHeuristics = [](const Image<RGB, stbi_uc>& testImage)
+    {
+        const auto imageDims = std::make_tuple(testImage.getWidth(), testImage.getHeight());
+
+        SimilarityGraphImpl graph;
+        graph.build(testImage);
+
+        const auto dissimilar = DissimilarPixels{};
+        graph.applyHeuristic(dissimilar);
+        graph.setEdgeProperties(dissimilar, [&](auto edge, auto value)
+            {
+                graph.setDissimilar(edge, std::get<bool>(value));
+            });
+
+        const auto curves = Curves{ imageDims };
+        graph.applyHeuristic(curves, FilteredEdges::eDissimilar);
+        graph.setEdgeProperties(curves, [&](auto edge, auto value)
+            {
+                graph.m_graph[edge].curvesWeight += std::get<double>(value);
+            });
+
+        const auto islands = Islands{ imageDims };
+        graph.applyHeuristic(islands, FilteredEdges::eDissimilar);
+        graph.setEdgeProperties(islands, [&](auto edge, auto value)
+            {
+                graph.m_graph[edge].islandsWeight += std::get<double>(value);
+            });
+
+        const auto sparsePixels = SparsePixels{ imageDims };
+        graph.applyHeuristic(sparsePixels, FilteredEdges::eDissimilar);
+        graph.setEdgeProperties(sparsePixels, [&](auto edge, auto value)
+            {
+                graph.m_graph[edge].sparsePixelsWeight += std::get<double>(value);
+            });
+
+        const auto edges = graph.getEdges(FilteredEdges::eAll);
+
+        dissimilar.clearMarkedEdges();
+        curves.clearMarkedEdges();
+        islands.clearMarkedEdges();
+        sparsePixels.clearMarkedEdges();
+
+        return edges;
+    };
+
+    std::vector<Image<RGB, stbi_uc>> testImages;
+    for (const auto& imagePath : { m_skull, m_torch, m_curve, m_islands, m_sparsePixels })
+        testImages.emplace_back(imagePath);
+
+    for (std::uint32_t seed = 0; seed < 30; ++seed)
+        testImages.push_back(makeNoisyImage(seed, 48, 48));
+
+    for (std::size_t i = 0; i < testImages.size(); ++i)
+    {
+        const auto expected = searchHeuristics(testImages[i]);
+
+        SimilarityGraph resolved{ testImages[i] };
+        resolved.resolveCrossings();
+
+        EXPECT_EQ(expected, resolved.getEdges(FilteredEdges::eNone)) << "image " << i;
+        EXPECT_EQ(expected, resolved.getEdges(FilteredEdges::eAll)) << "image " << i;
+    }
+}
+
+TEST_F(SimilarityGraphTests, Statistics)
+{
+    Image<RGB, stbi_uc> testImage{ m_skull };
+
+    SimilarityGraph graph{ testImage };
+    const auto built = graph.getStatistics();
+
+    EXPECT_EQ(static_cast<std::size_t>(testImage.getWidth()) * testImage.getHeight(), built.numVertices);
+    EXPECT_EQ(graph.getEdges(FilteredEdges::eNone).size(), built.numEdges);
+    EXPECT_EQ(built.numEdges, built.numResolvedEdges);
+
+    graph.resolveCrossings();
+    const auto resolved = graph.getStatistics();
+
+    EXPECT_GT(resolved.numDissimilarEdges, 0u);
+    EXPECT_GT(resolved.numCrossings, 0u);
+    EXPECT_EQ(graph.getEdges(FilteredEdges::eNone).size(), resolved.numResolvedEdges);
+
+    // Every edge that was removed is either dissimilar or a losing diagonal,
+    // and a tie loses both of its diagonals
+    EXPECT_EQ(resolved.numEdges - resolved.numDissimilarEdges - resolved.numCutDiagonals, resolved.numResolvedEdges);
+    EXPECT_EQ(resolved.numCrossings + resolved.numTies, resolved.numCutDiagonals);
+
+    for (const auto credited : { resolved.numCutByCurves, resolved.numCutByIslands, resolved.numCutBySparsePixels })
+        EXPECT_LE(credited, resolved.numCrossings - resolved.numTies);
+}
+
+TEST_F(SimilarityGraphTests, CachedNeighbourMasks)
+{
+    Image<RGB, stbi_uc> testImage{ m_curve };
+    m_graph.build(testImage);
+
+    // Nothing has been flagged dissimilar yet, so the filter keeps every edge
+    EXPECT_EQ(m_graph.getNeighbourMasks(), m_graph.getNeighbourMasks(FilteredEdges::eDissimilar));
+    const auto unfiltered = m_graph.getEdges(FilteredEdges::eNone);
+    EXPECT_EQ(unfiltered, m_graph.getEdges(FilteredEdges::eDissimilar));
+
+    const auto imageDims = std::make_tuple(testImage.getWidth(), testImage.getHeight());
+    m_graph.applyHeuristic(DissimilarPixels{});
+
+    // Applying a heuristic drops the stale masks
+    const auto similar = m_graph.getEdges(FilteredEdges::eDissimilar);
+    EXPECT_LT(similar.size(), unfiltered.size());
+    EXPECT_NE(m_graph.getNeighbourMasks(), m_graph.getNeighbourMasks(FilteredEdges::eDissimilar));
+
+    m_graph.applyHeuristic(Curves{ imageDims });
+    m_graph.applyHeuristic(Islands{ imageDims });
+    m_graph.applyHeuristic(SparsePixels{ imageDims });
+
+    // Repeated queries are served from the cache, and agree with each other
+    const auto& masks = m_graph.getNeighbourMasks(FilteredEdges::eAll);
+    EXPECT_EQ(&masks, &m_graph.getNeighbourMasks(FilteredEdges::eAll));
+    EXPECT_EQ(m_graph.getEdges(FilteredEdges::eAll), m_graph.getEdges(FilteredEdges::eAll));
+
+    std::size_t maskedEdges = 0;
+    for (const auto mask : masks)
+        maskedEdges += std::bitset<8>(mask).count();
+
+    EXPECT_EQ(m_graph.getEdges(FilteredEdges::eAll).size() * 2, maskedEdges);
+    EXPECT_EQ(similar, m_graph.getEdges(FilteredEdges::eDissimilar));
+}
+
+TEST_F(SimilarityGraphTests, DissimilarityKernelsMatchScalar)
+{
+    using namespace dpa::graph::internal;
+
+    const auto scalar = GetDissimilarityKernels(ColorKernelIsa::eScalar);
+    const auto detected = static_cast<int>(dpa::image::internal::DetectColorKernelIsa());
+
+    // Small channel values make similar and dissimilar pixels equally likely
+    std::mt19937 generator{ 42 };
+    std::uniform_int_distribution<int> channel{ 0, 2 };
+
+    const DissimilarityThresholds thresholds{ 2, 1, 1 };
+
+    // Odd widths exercise the scalar head and tails of the vectorized kernels
+    for (auto width : { 1, 2, 16, 17, 18, 33, 34, 35, 64, 67 })
+    {
+        std::vector<stbi_uc> planes(width * 6);
+        for (auto& value : planes)
+            value = static_cast<stbi_uc>(channel(generator));
+
+        const PlanarRow row{ planes.data(), planes.data() + width, planes.data() + width * 2 };
+        const PlanarRow next{ row.Y + width * 3, row.Cb + width * 3, row.Cr + width * 3 };
+
+        for (const auto& below : { next, PlanarRow{} })
+        {
+            std::vector<std::uint8_t> expected(width);
+            scalar.findDissimilarEdges(row, below, thresholds, expected.data(), width);
+
+            for (auto isa = 0; isa <= detected; ++isa)
+            {
+                const auto kernels = GetDissimilarityKernels(static_cast<ColorKernelIsa>(isa));
+
+                std::vector<std::uint8_t> actual(width);
+                kernels.findDissimilarEdges(row, below, thresholds, actual.data(), width);
+                EXPECT_EQ(expected, actual);
+            }
+        }
+    }
+}
+
+TEST_F(SimilarityGraphTests, FlagDissimilarEdgesMatchesHeuristic)
+{
+    for (const auto& imagePath : { m_skull, m_torch, m_curve })
+    {
+        Image<RGB, stbi_uc> testImage{ imagePath };
+
+        dpa::graph::internal::SimilarityGraphImpl searched;
+        ASSERT_TRUE(searched.build(testImage));
+
+        auto dissimilar = DissimilarPixels{};
+        searched.applyHeuristic(dissimilar);
+        searched.setEdgeProperties(dissimilar, [&](auto edge, auto value)
+            {
+                searched.setDissimilar(edge, std::get<bool>(value));
+            });
+        searched.invalidateNeighbourMasks(FilteredEdges::eDissimilar);
+
+        dpa::graph::internal::SimilarityGraphImpl flagged;
+        ASSERT_TRUE(flagged.build(testImage));
+        EXPECT_TRUE(flagged.isPalettized());
+        flagged.flagDissimilarEdges(false);
+
+        EXPECT_EQ(searched.getEdges(FilteredEdges::eDissimilar), flagged.getEdges(FilteredEdges::eDissimilar));
+        EXPECT_EQ(searched.getEdges(FilteredEdges::eNone), flagged.getEdges(FilteredEdges::eNone));
+
+        auto compared = DissimilarPixels{};
+        flagged.applyDissimilarHeuristic(compared);
+        EXPECT_EQ(dissimilar.getMarkedEdges(), compared.getMarkedEdges());
+
+        dissimilar.clearMarkedEdges();
+        compared.clearMarkedEdges();
+    }
+}
+
+TEST_F(SimilarityGraphTests, FlagDissimilarEdgesWithoutPalette)
+{
+    // Too many colours to palettize, so the channels are compared instead
+    Image<RGB, stbi_uc> noise{ std::make_tuple(48, 48) };
+
+    std::mt19937 generator{ 42 };
+    std::uniform_int_distribution<int> distribution{ 0, 255 };
+
+    const auto pixels = noise.pixels();
+    for (auto h = 0; h < pixels.getHeight(); ++h)
+    {
+        const auto row = pixels.row(h);
+        for (auto w = 0; w < row.size(); ++w)
+        {
+            row.set(w, { static_cast<stbi_uc>(distribution(generator)),
+                         static_cast<stbi_uc>(distribution(generator)),
+                         static_cast<stbi_uc>(distribution(generator)) });
+        }
+    }
+
+    // The graph is only built from loaded images
+    const auto imagePath = std::filesystem::temp_directory_path() / "palette_overflow.png";
+    ASSERT_TRUE(noise.save(imagePath));
+
+    Image<RGB, stbi_uc> testImage{ imagePath };
+    std::filesystem::remove(imagePath);
+
+    dpa::graph::internal::SimilarityGraphImpl searched;
+    ASSERT_TRUE(searched.build(testImage));
+    EXPECT_FALSE(searched.isPalettized());
+
+    auto dissimilar = DissimilarPixels{};
+    searched.applyHeuristic(dissimilar);
+    searched.setEdgeProperties(dissimilar, [&](auto edge, auto value)
+        {
+            searched.setDissimilar(edge, std::get<bool>(value));
+        });
+    searched.invalidateNeighbourMasks(FilteredEdges::eDissimilar);
+
+    dpa::graph::internal::SimilarityGraphImpl flagged;
+    ASSERT_TRUE(flagged.build(testImage));
+    flagged.flagDissimilarEdges(false);
+
+    EXPECT_EQ(searched.getEdges(FilteredEdges::eDissimilar), flagged.getEdges(FilteredEdges::eDissimilar));
+
+    auto compared = DissimilarPixels{};
+    flagged.applyDissimilarHeuristic(compared);
+    EXPECT_EQ(dissimilar.getMarkedEdges(), compared.getMarkedEdges());
+
+    dissimilar.clearMarkedEdges();
+    compared.clearMarkedEdges();
+}
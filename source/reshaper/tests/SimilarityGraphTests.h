@@ -4,7 +4,9 @@
 #include <TestUtility.h>
 
 #include <algorithm>
+#include <array>
 #include <filesystem>
+#include <random>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -84,6 +86,49 @@ protected:
         return out.str();
     }
 
+    /*
+        Creates a noisy image from a small palette, where pixels often copy the one
+        above or to the left, so there are plenty of crossings, curves and islands.
+        The graph is only built from loaded images, so it's written out and read back
+    */
+    dpa::image::Image<dpa::image::RGB, stbi_uc> makeNoisyImage(std::uint32_t seed, int width, int height) const
+    {
+        using namespace dpa::image;
+
+        const std::array<RGB<stbi_uc>, 3> palette
+        {
+            make_pixel<RGB>(stbi_uc{ 0 }, stbi_uc{ 0 }, stbi_uc{ 0 }),
+            make_pixel<RGB>(stbi_uc{ 255 }, stbi_uc{ 255 }, stbi_uc{ 255 }),
+            make_pixel<RGB>(stbi_uc{ 200 }, stbi_uc{ 40 }, stbi_uc{ 40 })
+        };
+
+        std::mt19937 random{ seed };
+        std::uniform_int_distribution<int> pick{ 0, 3 };
+
+        Image<RGB, stbi_uc> noise{ std::make_tuple(width, height) };
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                const int choice = pick(random);
+                if (choice == 3 && x > 0)
+                    noise.setPixelAt({ x, y }, noise.getPixelAt({ x - 1, y }).value());
+                else if (choice == 3 && y > 0)
+                    noise.setPixelAt({ x, y }, noise.getPixelAt({ x, y - 1 }).value());
+                else
+                    noise.setPixelAt({ x, y }, palette[choice % palette.size()]);
+            }
+        }
+
+        const auto imagePath = std::filesystem::temp_directory_path() / ("noise_" + std::to_string(seed) + ".png");
+        noise.save(imagePath);
+
+        Image<RGB, stbi_uc> loaded{ imagePath };
+        std::filesystem::remove(imagePath);
+
+        return loaded;
+    }
+
 protected:
 
     // Test image paths
@@ -2,6 +2,9 @@
 
 #include <SimilarityGraph.h>
 #include <Heuristics.h>
+#include <ImageUtil.h>
+#include <RunArena.h>
+#include <VoronoiImpl.h>
 
 #pragma warning(push)
 #pragma warning(disable: 4996)
@@ -10,6 +13,7 @@
 
 #pragma warning(pop)
 
+#include <algorithm>
 #include <set>
 
 TEST_F(VoronoiTests, Build_TriangleConfiguration_1)
@@ -292,3 +296,323 @@ TEST_F(VoronoiTests, Weld)
 
     EXPECT_EQ(solution, output.str());
 }
+
+TEST_F(VoronoiTests, CellTemplatesByCode)
+{
+    using dpa::voronoi::internal::PixelBlock;
+
+    const auto& cells = dpa::voronoi::internal::GetVoronoiCellTemplates();
+
+    // Empty and unresolved blocks don't have a cell
+    EXPECT_EQ(0, cells[0].numPoints);
+    EXPECT_EQ(0, cells[PixelBlock::kForwardDiagonal | PixelBlock::kBackDiagonal].numPoints);
+
+    EXPECT_EQ(7, cells[PixelBlock::kForwardDiagonal].numPoints);
+    EXPECT_EQ(7, cells[PixelBlock::kBackDiagonal].numPoints);
+
+    EXPECT_EQ(6, cells[PixelBlock::kLeft | PixelBlock::kBottom | PixelBlock::kBackDiagonal].numPoints);
+    EXPECT_EQ(6, cells[PixelBlock::kLeft | PixelBlock::kTop | PixelBlock::kForwardDiagonal].numPoints);
+    EXPECT_EQ(6, cells[PixelBlock::kRight | PixelBlock::kTop | PixelBlock::kBackDiagonal].numPoints);
+    EXPECT_EQ(6, cells[PixelBlock::kRight | PixelBlock::kBottom | PixelBlock::kForwardDiagonal].numPoints);
+
+    // Everything else with a border edge is the default cell
+    EXPECT_EQ(5, cells[PixelBlock::kLeft].numPoints);
+    EXPECT_EQ(5, cells[PixelBlock::kLeft | PixelBlock::kRight | PixelBlock::kTop | PixelBlock::kBottom].numPoints);
+    EXPECT_EQ(5, cells[PixelBlock::kTop | PixelBlock::kForwardDiagonal | PixelBlock::kBackDiagonal].numPoints);
+}
+
+TEST_F(VoronoiTests, BlockGridEdges)
+{
+    using dpa::voronoi::internal::PixelBlock;
+
+    /*
+        0   1   2
+          \
+        3   4 - 5
+    */
+    dpa::voronoi::internal::BlockGrid grid{ 2, 1 };
+    grid.at(0, 0).code = PixelBlock::kBackDiagonal;
+    grid.at(1, 0).code = PixelBlock::kBottom;
+
+    EXPECT_EQ(1, sizeof(PixelBlock));
+
+    EXPECT_EQ(std::make_optional(std::make_tuple<std::size_t, std::size_t>(0, 4)),
+        grid.getEdge(0, 0, PixelBlock::kBackDiagonal));
+    EXPECT_EQ(std::make_optional(std::make_tuple<std::size_t, std::size_t>(4, 5)),
+        grid.getEdge(1, 0, PixelBlock::kBottom));
+
+    EXPECT_FALSE(grid.getEdge(0, 0, PixelBlock::kForwardDiagonal).has_value());
+    EXPECT_FALSE(grid.getEdge(1, 0, PixelBlock::kTop).has_value());
+}
+
+TEST_F(VoronoiTests, WeldGridSharesBorderPoints)
+{
+    // Every block of a flat image gets the default cell, a center joined to the middle of each side
+    const auto image = makeGreyImage(4, 3, {
+        0, 0, 0, 0,
+        0, 0, 0, 0,
+        0, 0, 0, 0 });
+
+    const auto impl = buildVoronoiImpl(image);
+
+    const auto& graph = impl.m_voronoiGraph;
+
+    std::set<std::tuple<double, double>> points;
+    for (const auto vertex : boost::make_iterator_range(boost::vertices(graph)))
+        points.emplace(graph[vertex].x, graph[vertex].y);
+
+    // The 3x2 cells' centers, and only the side points on the image border. The 7
+    // points neighbouring cells share are welded away, so none of them are duplicated
+    const std::set<std::tuple<double, double>> expected
+    {
+        { .5, .5 }, { 1.5, .5 }, { 2.5, .5 }, { .5, 1.5 }, { 1.5, 1.5 }, { 2.5, 1.5 },
+        { .5, 0 }, { 1.5, 0 }, { 2.5, 0 }, { .5, 2 }, { 1.5, 2 }, { 2.5, 2 },
+        { 0, .5 }, { 0, 1.5 }, { 3, .5 }, { 3, 1.5 }
+    };
+
+    EXPECT_EQ(expected.size(), boost::num_vertices(graph));
+    EXPECT_EQ(expected, points);
+
+    // Each center keeps its border points, and is joined straight to the centers it was welded to
+    std::set<std::tuple<double, double, double, double>> edges;
+    for (const auto edge : boost::make_iterator_range(boost::edges(graph)))
+    {
+        auto first = graph[boost::source(edge, graph)];
+        auto second = graph[boost::target(edge, graph)];
+        if (std::tie(second.x, second.y) < std::tie(first.x, first.y))
+            std::swap(first, second);
+
+        edges.emplace(first.x, first.y, second.x, second.y);
+    }
+
+    EXPECT_EQ(10u + 7u, boost::num_edges(graph));
+    EXPECT_EQ(boost::num_edges(graph), edges.size());
+
+    EXPECT_EQ(1u, edges.count({ .5, .5, 1.5, .5 }));
+    EXPECT_EQ(1u, edges.count({ 1.5, .5, 2.5, .5 }));
+    EXPECT_EQ(1u, edges.count({ .5, .5, .5, 1.5 }));
+    EXPECT_EQ(1u, edges.count({ 2.5, .5, 2.5, 1.5 }));
+    EXPECT_EQ(1u, edges.count({ 1.5, 1.5, 2.5, 1.5 }));
+
+    // The points on the image border stay joined to their own cell
+    EXPECT_EQ(1u, edges.count({ 0, .5, .5, .5 }));
+    EXPECT_EQ(1u, edges.count({ .5, 1.5, .5, 2 }));
+    EXPECT_EQ(1u, edges.count({ 2.5, 1.5, 3, 1.5 }));
+    EXPECT_EQ(1u, edges.count({ 2.5, 0, 2.5, .5 }));
+}
+
+TEST_F(VoronoiTests, BuildFromNeighbourMasks)
+{
+    using namespace dpa::image;
+    using namespace dpa::graph;
+
+    Image<RGB, stbi_uc> image{ m_curve };
+
+    SimilarityGraph simGraph;
+    simGraph.build(image);
+    simGraph.resolveCrossings();
+
+    auto imageDims = std::make_tuple(image.getWidth(), image.getHeight());
+
+    VoronoiDiagram fromMasks{ imageDims };
+    fromMasks.build(simGraph.getNeighbourMasks());
+
+    VoronoiDiagram fromEdges{ imageDims };
+    fromEdges.build(simGraph.getEdges(heuristics::FilteredEdges::eNone));
+
+    std::ostringstream maskOutput;
+    fromMasks.printVertices(std::ref(maskOutput));
+
+    std::ostringstream edgeOutput;
+    fromEdges.printVertices(std::ref(edgeOutput));
+
+    std::ifstream input{ m_curves_weld_solution };
+    std::string solution{ std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>() };
+
+    EXPECT_EQ(solution, maskOutput.str());
+    EXPECT_EQ(edgeOutput.str(), maskOutput.str());
+}
+
+TEST_F(VoronoiTests, Statistics)
+{
+    using namespace dpa::image;
+
+    Image<RGB, stbi_uc> image{ m_curve };
+    auto imageDims = std::make_tuple(image.getWidth(), image.getHeight());
+
+    VoronoiDiagram unbuilt{ imageDims };
+    EXPECT_EQ(0u, unbuilt.getStatistics().numVertices);
+    EXPECT_EQ(0u, unbuilt.getStatistics().numWelds);
+
+    auto voronoi = buildVoronoi(image);
+    const auto impl = buildVoronoiImpl(image);
+
+    const auto statistics = voronoi.getStatistics();
+
+    EXPECT_EQ(boost::num_vertices(impl.m_voronoiGraph), statistics.numVertices);
+    EXPECT_EQ(boost::num_edges(impl.m_voronoiGraph), statistics.numEdges);
+    EXPECT_GT(statistics.numWelds, 0u);
+    EXPECT_GT(statistics.numCells, 0u);
+    EXPECT_LE(statistics.numCells, (image.getWidth() - 1u) * (image.getHeight() - 1u));
+}
+
+TEST_F(VoronoiTests, ExecutionPoliciesMatch)
+{
+    using namespace dpa::image;
+
+    Image<RGB, stbi_uc> image{ m_skull };
+
+    const auto neighbourMasks = resolveNeighbourMasks(image);
+    auto imageDims = std::make_tuple(image.getWidth(), image.getHeight());
+
+    const auto buildWith = [&](ExecutionPolicy policy)
+    {
+        VoronoiDiagram voronoi{ imageDims };
+        voronoi.setExecutionPolicy(policy);
+        voronoi.build(neighbourMasks);
+
+        std::ostringstream output;
+        voronoi.printVertices(std::ref(output));
+        voronoi.printGraph(std::ref(output));
+
+        return output.str();
+    };
+
+    const auto sequenced = buildWith(ExecutionPolicy::eSequenced);
+
+    EXPECT_FALSE(sequenced.empty());
+    EXPECT_EQ(sequenced, buildWith(ExecutionPolicy::eParallel));
+    EXPECT_EQ(sequenced, buildWith(ExecutionPolicy::eParallelUnsequenced));
+}
+
+TEST_F(VoronoiTests, BuildInRunArena)
+{
+    using namespace dpa::image;
+    using namespace dpa::graph;
+
+    Image<RGB, stbi_uc> image{ m_skull };
+    auto imageDims = std::make_tuple(image.getWidth(), image.getHeight());
+
+    // Everything allocated from the arena has to be gone before it's released
+    dpa::memory::RunArena arena;
+
+    const auto buildWith = [&](std::pmr::memory_resource* resource, ExecutionPolicy policy)
+    {
+        SimilarityGraph simGraph;
+        simGraph.setMemoryResource(resource);
+        simGraph.build(image);
+        simGraph.resolveCrossings();
+
+        VoronoiDiagram voronoi{ imageDims };
+        voronoi.setMemoryResource(resource);
+        voronoi.setExecutionPolicy(policy);
+        voronoi.build(simGraph.getNeighbourMasks());
+
+        std::ostringstream output;
+        voronoi.printVertices(std::ref(output));
+        voronoi.printGraph(std::ref(output));
+
+        return output.str();
+    };
+
+    const auto expected = buildWith(std::pmr::get_default_resource(), ExecutionPolicy::eSequenced);
+
+    EXPECT_EQ(expected, buildWith(arena.resource(), ExecutionPolicy::eSequenced));
+    EXPECT_GT(arena.getBytesAllocated(), 0u);
+
+    arena.release();
+    EXPECT_EQ(0u, arena.getBytesAllocated());
+
+    // The parallel builds share the arena between threads
+    EXPECT_EQ(expected, buildWith(arena.resource(), ExecutionPolicy::eParallel));
+}
+
+TEST_F(VoronoiTests, ExtractContours_Split)
+{
+    // A black half and a white half, split by a single vertical contour
+    const auto image = makeGreyImage(4, 4, {
+        0, 0, 255, 255,
+        0, 0, 255, 255,
+        0, 0, 255, 255,
+        0, 0, 255, 255 });
+
+    auto voronoi = buildVoronoi(image);
+
+    const auto contours = voronoi.extractContours(image);
+
+    ASSERT_EQ(1u, contours.size());
+    ASSERT_EQ(2u, contours.offsets.size());
+    EXPECT_EQ(ContourType::eVisible, contours.types[0]);
+    EXPECT_FALSE(contours.isClosed(0));
+
+    const std::vector<double> expected{ 1.5, 0, 1.5, .5, 1.5, 1.5, 1.5, 2.5, 1.5, 3 };
+    EXPECT_EQ(expected, contours.coordinates);
+}
+
+TEST_F(VoronoiTests, ExtractContours_Shading)
+{
+    // The halves are dissimilar, but not different enough to be visible
+    const auto image = makeGreyImage(3, 2, {
+        100, 160, 160,
+        100, 160, 160 });
+
+    auto voronoi = buildVoronoi(image);
+
+    const auto contours = voronoi.extractContours(image);
+
+    ASSERT_EQ(1u, contours.size());
+    EXPECT_EQ(ContourType::eShading, contours.types[0]);
+    EXPECT_EQ(3u, contours.getNumPoints(0));
+}
+
+TEST_F(VoronoiTests, ExtractContours_Island)
+{
+    // A single white pixel is cut off by a closed contour
+    const auto image = makeGreyImage(5, 5, {
+        0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0,
+        0, 0, 255, 0, 0,
+        0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0 });
+
+    auto voronoi = buildVoronoi(image);
+
+    const auto contours = voronoi.extractContours(image);
+
+    ASSERT_EQ(1u, contours.size());
+    EXPECT_EQ(ContourType::eVisible, contours.types[0]);
+    EXPECT_TRUE(contours.isClosed(0));
+
+    // An image that doesn't match the diagram has no contours
+    EXPECT_EQ(0u, voronoi.extractContours(makeGreyImage(2, 2, { 0, 0, 0, 0 })).size());
+}
+
+TEST_F(VoronoiTests, ExtractContours_CoverEveryEdgeOnce)
+{
+    using namespace dpa::image;
+
+    Image<RGB, stbi_uc> image{ m_skull };
+    auto impl = buildVoronoiImpl(image);
+
+    const auto contours = impl.extractContours(dpa::image::utility::RGB_To_YCbCr(image).value());
+
+    std::size_t numContourEdges = 0;
+    for (const auto edge : boost::make_iterator_range(boost::edges(impl.m_voronoiGraph)))
+        numContourEdges += !impl.m_voronoiGraph[edge].isConnected;
+
+    ASSERT_GT(contours.size(), 0u);
+    ASSERT_EQ(contours.size() + 1, contours.offsets.size());
+    EXPECT_EQ(contours.getNumPoints(), contours.offsets.back());
+
+    // Every contour edge joins two consecutive points of exactly one contour
+    std::size_t numWalkedEdges = 0;
+    for (std::size_t i = 0; i < contours.size(); ++i)
+    {
+        ASSERT_GE(contours.getNumPoints(i), 2u);
+        numWalkedEdges += contours.getNumPoints(i) - 1;
+    }
+
+    EXPECT_EQ(numContourEdges, numWalkedEdges);
+    EXPECT_TRUE(std::any_of(std::cbegin(contours.types), std::cend(contours.types),
+        [](ContourType type) { return type == ContourType::eShading; }));
+}
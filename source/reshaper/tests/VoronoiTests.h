@@ -1,7 +1,9 @@
 #pragma once
 
+#include <SimilarityGraph.h>
 #include <TestUtility.h>
 #include <Voronoi.h>
+#include <VoronoiImpl.h>
 
 #include <algorithm>
 #include <filesystem>
@@ -129,6 +131,54 @@ protected:
         return out.str();
     }
 
+    /*
+        Creates a grey image, with one value per pixel in row-major order
+    */
+    dpa::image::Image<dpa::image::RGB, stbi_uc> makeGreyImage(int width, int height, const std::vector<stbi_uc>& greys) const
+    {
+        std::vector<stbi_uc> pixelData;
+        for (const auto grey : greys)
+            pixelData.insert(std::end(pixelData), { grey, grey, grey });
+
+        return { std::make_tuple(width, height), pixelData.data() };
+    }
+
+    /*
+        Builds an image's similarity graph, and gets its neighbour masks once its crossings are resolved
+    */
+    VoronoiDiagram::NeighbourMasks resolveNeighbourMasks(const dpa::image::Image<dpa::image::RGB, stbi_uc>& image) const
+    {
+        dpa::graph::SimilarityGraph simGraph{ image };
+        simGraph.resolveCrossings();
+
+        return simGraph.getNeighbourMasks();
+    }
+
+    /*
+        Builds the voronoi diagram of an image's resolved similarity graph
+    */
+    VoronoiDiagram buildVoronoi(const dpa::image::Image<dpa::image::RGB, stbi_uc>& image) const
+    {
+        auto imageDims = std::make_tuple(image.getWidth(), image.getHeight());
+
+        VoronoiDiagram voronoi{ imageDims };
+        voronoi.build(resolveNeighbourMasks(image));
+
+        return voronoi;
+    }
+
+    /*
+        Builds the voronoi diagram of an image's resolved similarity graph, without hiding the implementation
+    */
+    internal::VoronoiImpl buildVoronoiImpl(const dpa::image::Image<dpa::image::RGB, stbi_uc>& image) const
+    {
+        internal::VoronoiImpl impl;
+        impl.setDimensions(std::make_tuple(image.getWidth(), image.getHeight()));
+        impl.build(resolveNeighbourMasks(image));
+
+        return impl;
+    }
+
 protected:
 
     // Test image paths
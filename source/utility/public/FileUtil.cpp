@@ -1,8 +1,12 @@
 #include "FileUtil.h"
 
+#include <algorithm>
 #include <array>
 #include <filesystem>
+#include <fstream>
 #include <string>
+#include <system_error>
+#include <vector>
 
 namespace dpa::fileutil
 {
@@ -35,5 +39,102 @@ bool fileExists(const std::filesystem::path& file)
 
     return false;
 }
+
+bool matchesWildcard(const std::string& fileName, const std::string& pattern)
+{
+    std::size_t name = 0;
+    std::size_t glob = 0;
+
+    // Where the last '*' was, and how much of the name it has swallowed
+    std::size_t starGlob = std::string::npos;
+    std::size_t starName = 0;
+
+    while (name < fileName.size())
+    {
+        if (glob < pattern.size() && (pattern[glob] == '?' || pattern[glob] == fileName[name]))
+        {
+            ++name;
+            ++glob;
+        }
+        else if (glob < pattern.size() && pattern[glob] == '*')
+        {
+            starGlob = glob++;
+            starName = name;
+        }
+        else if (starGlob != std::string::npos)
+        {
+            // Let the last '*' swallow one more character, and try again
+            glob = starGlob + 1;
+            name = ++starName;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while (glob < pattern.size() && pattern[glob] == '*')
+        ++glob;
+
+    return glob == pattern.size();
+}
+
+std::vector<std::filesystem::path> collectImages(const std::filesystem::path& source)
+{
+    namespace fs = std::filesystem;
+
+    std::vector<fs::path> images;
+    std::error_code error;
+
+    const auto pattern = source.filename().string();
+    if (pattern.find_first_of("*?") != std::string::npos)
+    {
+        const auto directory = source.has_parent_path() ? source.parent_path() : fs::path{ "." };
+
+        // Stepping the iterators reports errors through the error code too, rather than throwing
+        for (fs::directory_iterator entry{ directory, error }, end; !error && entry != end; entry.increment(error))
+        {
+            if (matchesWildcard(entry->path().filename().string(), pattern) && isValidImage(entry->path()))
+                images.push_back(entry->path());
+        }
+    }
+    else if (isValidDirectory(source))
+    {
+        const auto options = fs::directory_options::skip_permission_denied;
+        for (fs::recursive_directory_iterator entry{ source, options, error }, end; !error && entry != end; entry.increment(error))
+        {
+            if (isValidImage(entry->path()))
+                images.push_back(entry->path());
+        }
+    }
+    else if (isValidImage(source))
+    {
+        images.push_back(source);
+    }
+    else if (fileExists(source))
+    {
+        // Anything else is read as a list of images, one per line
+        std::ifstream list{ source };
+        for (std::string line; std::getline(list, line);)
+        {
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if (line.empty())
+                continue;
+
+            fs::path image{ line };
+            if (image.is_relative())
+                image = source.parent_path() / image;
+
+            if (isValidImage(image))
+                images.push_back(image);
+        }
+    }
+
+    // A list file can name the same image more than once
+    std::sort(std::begin(images), std::end(images));
+    images.erase(std::unique(std::begin(images), std::end(images)), std::end(images));
+
+    return images;
+}
 } // end dpa::fileutil namespace
 
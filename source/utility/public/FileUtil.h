@@ -5,6 +5,7 @@
 #include <functional>
 #include <numeric>
 #include <string>
+#include <vector>
 
 namespace dpa::fileutil
 {
@@ -66,4 +67,27 @@ bool isValidImageExtension(const std::filesystem::path& filePath, const std::arr
     @returns True if the file exists, false otherwise
 */
 bool fileExists(const std::filesystem::path& file);
+
+/*
+    Determines if a file name matches a wildcard pattern, where '*' matches
+    any run of characters and '?' matches any single character
+
+    @param fileName The file name to match
+    @param pattern  The wildcard pattern to match against
+
+    @returns True if the whole file name matches the pattern, false otherwise
+*/
+bool matchesWildcard(const std::string& fileName, const std::string& pattern);
+
+/*
+    Gathers the images a source refers to. The source may be a single image,
+    a directory, whose images are gathered recursively, a list file with one
+    image path per line, or a wildcard pattern in its file name. Relative paths
+    in a list file are relative to the list file itself
+
+    @param source   The image, directory, list file, or pattern to gather from
+
+    @returns The valid images the source refers to, sorted by path, each listed once
+*/
+std::vector<std::filesystem::path> collectImages(const std::filesystem::path& source);
 }// end  dpa::fileutil namespace
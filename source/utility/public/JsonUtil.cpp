@@ -0,0 +1,44 @@
+#include "JsonUtil.h"
+
+#include <cstdio>
+
+namespace dpa::jsonutil
+{
+void writeString(std::ostream& output, std::string_view value)
+{
+    output << '"';
+    for (const char letter : value)
+    {
+        switch (letter)
+        {
+        case '"':
+            output << "\\\"";
+            break;
+        case '\\':
+            output << "\\\\";
+            break;
+        case '\n':
+            output << "\\n";
+            break;
+        case '\r':
+            output << "\\r";
+            break;
+        case '\t':
+            output << "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(letter) < 0x20)
+            {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(letter));
+                output << escaped;
+            }
+            else
+            {
+                output << letter;
+            }
+        }
+    }
+    output << '"';
+}
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <ostream>
+#include <string_view>
+
+namespace dpa::jsonutil
+{
+/*
+    Writes a string as a JSON string literal, escaping the characters JSON
+    doesn't allow in one
+
+    @param output   The stream to write to
+    @param value    The string to write
+*/
+void writeString(std::ostream& output, std::string_view value);
+}
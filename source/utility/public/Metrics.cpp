@@ -0,0 +1,100 @@
+#include "Metrics.h"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+namespace
+{
+#if defined(_WIN32)
+/*
+    Adds up the kernel and user times Windows reports, which are in 100ns ticks
+
+    @param kernelTime   The time spent in the kernel
+    @param userTime     The time spent in user mode
+
+    @returns The total CPU time
+*/
+std::chrono::nanoseconds ToNanoseconds(const FILETIME& kernelTime, const FILETIME& userTime) noexcept
+{
+    const auto ticks = [](const FILETIME& time)
+    {
+        return (static_cast<unsigned long long>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+
+    return std::chrono::nanoseconds{ static_cast<long long>((ticks(kernelTime) + ticks(userTime)) * 100) };
+}
+#else
+/*
+    Reads one of the CPU time clocks
+
+    @param clock    The clock to read
+
+    @returns The clock's time, or zero if it can't be read
+*/
+std::chrono::nanoseconds ReadClock(clockid_t clock) noexcept
+{
+    timespec time{};
+    if (clock_gettime(clock, &time) != 0)
+        return std::chrono::nanoseconds{ 0 };
+
+    return std::chrono::seconds{ time.tv_sec } + std::chrono::nanoseconds{ time.tv_nsec };
+}
+#endif
+}
+
+namespace dpa::metrics
+{
+std::chrono::nanoseconds processCpuTime() noexcept
+{
+#if defined(_WIN32)
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+        return std::chrono::nanoseconds{ 0 };
+
+    return ToNanoseconds(kernelTime, userTime);
+#else
+    return ReadClock(CLOCK_PROCESS_CPUTIME_ID);
+#endif
+}
+
+std::chrono::nanoseconds threadCpuTime() noexcept
+{
+#if defined(_WIN32)
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime))
+        return std::chrono::nanoseconds{ 0 };
+
+    return ToNanoseconds(kernelTime, userTime);
+#else
+    return ReadClock(CLOCK_THREAD_CPUTIME_ID);
+#endif
+}
+
+std::size_t peakResidentSetSize() noexcept
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+
+    // Linux reports the peak in kilobytes, and macOS in bytes
+#if defined(__APPLE__)
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+}
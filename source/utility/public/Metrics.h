@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+
+namespace dpa::metrics
+{
+/*
+    The time and CPU time spent in one stage of depixelizing an image
+*/
+struct StageMetrics
+{
+    // The name of the stage, which is a string literal
+    const char* name{ "" };
+
+    std::chrono::nanoseconds wallTime{ 0 };
+
+    // The CPU time of the whole process while the stage ran, so work the stage hands to
+    // other threads, like a parallel execution policy does, is included. That's only the
+    // stage's own when nothing else is running, so it's left empty when it can't be measured
+    std::optional<std::chrono::nanoseconds> cpuTime{};
+
+    // The peak resident set size of the whole process once the stage finished
+    std::size_t peakResidentSetSize{ 0 };
+};
+
+/*
+    Gets the CPU time every thread of the process has used so far
+
+    @returns The process' CPU time, or zero if it can't be measured
+*/
+std::chrono::nanoseconds processCpuTime() noexcept;
+
+/*
+    Gets the CPU time the calling thread has used so far
+
+    @returns The thread's CPU time, or zero if it can't be measured
+*/
+std::chrono::nanoseconds threadCpuTime() noexcept;
+
+/*
+    Gets the most physical memory the process has held at once
+
+    @returns The peak resident set size in bytes, or zero if it can't be measured
+*/
+std::size_t peakResidentSetSize() noexcept;
+}
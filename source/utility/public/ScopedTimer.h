@@ -1,12 +1,21 @@
 #pragma once
 
+#include <Trace.h>
+
 #include <chrono>
 #include <functional>
+#include <iomanip>
 #include <iostream>
+#include <optional>
+#include <sstream>
 #include <string>
+#include <type_traits>
 
 /*
-    A helper class that times the execution of functions
+    A helper class that times the execution of functions. The time is measured
+    in nanoseconds, and reported as a std::chrono::nanoseconds if the report
+    callback accepts one, or in whole milliseconds otherwise. When given a span
+    name, the function is also recorded as a trace span
 
     @tparam TargetCallback      The target function that will be timed
     @tparam TimeReportCallback  A callback to pass the elapsed time out through
@@ -24,15 +33,19 @@ public:
         @param endMessage   The verbose message to print at the end of execution
         @param callable     The method to time the execution of
         @param report       The method used to report the elapsed execution time 
+        @param spanName     The name of the trace span to record, or null to not record one
     */
     ScopedTimer(bool isVerbose, const std::string& startMessage, const std::string& endMessage,
-                TargetCallback callable, TimeReportCallback report)
+                TargetCallback callable, TimeReportCallback report, const char* spanName = nullptr)
         : m_endMessage(endMessage), m_bIsVerbose(isVerbose), m_reportCallback(report)
     {
         if (m_bIsVerbose)
             std::cout << startMessage;
 
-        m_start = std::chrono::high_resolution_clock::now();
+        if (spanName)
+            m_span.emplace(spanName);
+
+        m_start = std::chrono::steady_clock::now();
 
         callable();
     }
@@ -42,21 +55,32 @@ public:
     */
     ~ScopedTimer() noexcept
     {
-        auto end = std::chrono::high_resolution_clock::now();
-        long long delta = std::chrono::duration_cast<std::chrono::milliseconds>(end - m_start).count();
+        const auto delta = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start);
+        m_span.reset();
 
+        // Most stages finish well within a millisecond, so the fraction is kept
         if (m_bIsVerbose)
-            std::cout << m_endMessage << delta << "ms\n\n";
+        {
+            std::ostringstream message;
+            message << m_endMessage << std::fixed << std::setprecision(3);
+            message << std::chrono::duration<double, std::milli>(delta).count() << "ms\n\n";
+
+            std::cout << message.str();
+        }
 
-        m_reportCallback(delta);
+        if constexpr (std::is_invocable_v<TimeReportCallback, std::chrono::nanoseconds>)
+            m_reportCallback(delta);
+        else
+            m_reportCallback(std::chrono::duration_cast<std::chrono::milliseconds>(delta).count());
     }
 
 private:
 
     std::string m_endMessage;
     bool m_bIsVerbose = false;
-    std::function<void(long long)> m_reportCallback;
+    TimeReportCallback m_reportCallback;
 
-    std::chrono::time_point<std::chrono::high_resolution_clock> m_start;
+    std::optional<dpa::trace::TraceSpan> m_span;
+    std::chrono::steady_clock::time_point m_start;
 
 };
\ No newline at end of file
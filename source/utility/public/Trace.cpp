@@ -0,0 +1,161 @@
+#include "Trace.h"
+#include "JsonUtil.h"
+
+#include <cstdio>
+#include <utility>
+
+namespace
+{
+/*
+    Writes nanoseconds as microseconds, which is the unit of Chrome trace timestamps
+
+    @param output       The stream to write to
+    @param nanoseconds  The time to write
+*/
+void WriteMicroseconds(std::ostream& output, std::int64_t nanoseconds)
+{
+    char formatted[32];
+    std::snprintf(formatted, sizeof(formatted), "%lld.%03lld",
+        static_cast<long long>(nanoseconds / 1000), static_cast<long long>(nanoseconds % 1000));
+
+    output << formatted;
+}
+}
+
+namespace dpa::trace
+{
+Tracer& Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Tracer()
+    : m_epoch(Clock::now())
+{}
+
+std::int64_t Tracer::now() const noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_epoch).count();
+}
+
+Tracer::ThreadBuffer& Tracer::buffer()
+{
+    thread_local std::shared_ptr<ThreadBuffer> local = [this]()
+    {
+        auto created = std::make_shared<ThreadBuffer>();
+
+        std::lock_guard lock{ m_mutex };
+        created->threadId = static_cast<std::uint32_t>(m_buffers.size() + 1);
+        m_buffers.push_back(created);
+
+        return created;
+    }();
+
+    return *local;
+}
+
+void Tracer::record(TraceEvent event)
+{
+    buffer().events.push_back(std::move(event));
+}
+
+std::uint32_t& Tracer::depth() noexcept
+{
+    return buffer().depth;
+}
+
+void Tracer::writeChromeTrace(std::ostream& output) const
+{
+    const auto events = getEvents();
+
+    output << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    bool first = true;
+    for (const auto& [threadId, event] : events)
+    {
+        output << (first ? "\n" : ",\n");
+        first = false;
+
+        output << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << threadId << ",\"name\":";
+        dpa::jsonutil::writeString(output, event.name);
+        output << ",\"cat\":";
+        dpa::jsonutil::writeString(output, event.category);
+        output << ",\"ts\":";
+        WriteMicroseconds(output, event.start);
+        output << ",\"dur\":";
+        WriteMicroseconds(output, event.duration);
+        output << ",\"args\":{\"depth\":" << event.depth;
+
+        if (!event.detail.empty())
+        {
+            output << ",\"detail\":";
+            dpa::jsonutil::writeString(output, event.detail);
+        }
+
+        output << "}}";
+    }
+
+    output << "\n]}\n";
+}
+
+void Tracer::clear()
+{
+    std::lock_guard lock{ m_mutex };
+    for (const auto& buffer : m_buffers)
+        buffer->events.clear();
+}
+
+std::vector<std::pair<std::uint32_t, TraceEvent>> Tracer::getEvents() const
+{
+    std::vector<std::pair<std::uint32_t, TraceEvent>> events;
+
+    std::lock_guard lock{ m_mutex };
+    for (const auto& buffer : m_buffers)
+    {
+        for (const auto& event : buffer->events)
+            events.emplace_back(buffer->threadId, event);
+    }
+
+    return events;
+}
+
+TraceSpan::TraceSpan(const char* name, const char* category)
+    : TraceSpan(name, category, std::string{})
+{}
+
+TraceSpan::TraceSpan(const char* name, const char* category, const std::string& detail)
+{
+    auto& tracer = Tracer::instance();
+    if (!tracer.isEnabled())
+        return;
+
+    m_recording = true;
+
+    m_event.name = name;
+    m_event.category = category;
+    m_event.detail = detail;
+    m_event.depth = tracer.depth()++;
+    m_event.start = tracer.now();
+}
+
+TraceSpan::~TraceSpan() noexcept
+{
+    if (!m_recording)
+        return;
+
+    auto& tracer = Tracer::instance();
+    m_event.duration = tracer.now() - m_event.start;
+
+    --tracer.depth();
+
+    try
+    {
+        tracer.record(std::move(m_event));
+    }
+    catch (...)
+    {
+        // A span that can't be recorded is dropped, rather than taking the program down with it
+    }
+}
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dpa::trace
+{
+/*
+    A span of time spent in some part of the program, on one thread. The
+    name and category are string literals, so recording a span doesn't have
+    to copy them
+*/
+struct TraceEvent
+{
+    const char* name{ "" };
+    const char* category{ "" };
+    std::string detail{};
+
+    // Nanoseconds since the tracer was created
+    std::int64_t start{ 0 };
+    std::int64_t duration{ 0 };
+
+    // How many spans were open on the thread when this one started
+    std::uint32_t depth{ 0 };
+};
+
+/*
+    Collects the spans recorded by every thread. Each thread records into its
+    own buffer without taking a lock, and the buffers are only merged when the
+    trace is exported, which has to happen once the traced work has finished.
+    Nothing is recorded until the tracer is enabled
+*/
+class Tracer final
+{
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+public:
+
+    /*
+        Gets the tracer shared by the whole program
+
+        @returns The tracer
+    */
+    static Tracer& instance();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    /*
+        Turns recording on or off. Spans that are open when recording is
+        turned off are still recorded once they close
+
+        @param enabled True to record spans, false to ignore them
+    */
+    void setEnabled(bool enabled) noexcept { m_enabled.store(enabled, std::memory_order_relaxed); }
+
+    bool isEnabled() const noexcept { return m_enabled.load(std::memory_order_relaxed); }
+
+    /*
+        Gets the time since the tracer was created
+
+        @returns The time in nanoseconds
+    */
+    std::int64_t now() const noexcept;
+
+    /*
+        Records a finished span in the calling thread's buffer
+
+        @param event The span to record
+    */
+    void record(TraceEvent event);
+
+    /*
+        Gets the number of spans open on the calling thread
+
+        @returns A reference to the calling thread's span depth
+    */
+    std::uint32_t& depth() noexcept;
+
+    /*
+        Writes every recorded span in the Chrome trace event format, which can
+        be opened in chrome://tracing or Perfetto. Each thread that recorded a
+        span gets its own track
+
+        @param output The stream to write the JSON to
+    */
+    void writeChromeTrace(std::ostream& output) const;
+
+    /*
+        Discards every recorded span
+    */
+    void clear();
+
+    /*
+        Gets every recorded span, grouped by the thread that recorded it
+
+        @returns The spans, along with the track id of the thread that recorded each one
+    */
+    std::vector<std::pair<std::uint32_t, TraceEvent>> getEvents() const;
+
+private:
+
+    /*
+        The spans recorded by a single thread. The buffer is shared with the
+        tracer, so it outlives the thread
+    */
+    struct ThreadBuffer
+    {
+        std::uint32_t threadId{ 0 };
+        std::uint32_t depth{ 0 };
+
+        std::vector<TraceEvent> events{};
+    };
+
+    Tracer();
+
+    /*
+        Gets the calling thread's buffer, registering it the first time
+
+        @returns The calling thread's buffer
+    */
+    ThreadBuffer& buffer();
+
+private:
+
+    std::atomic<bool> m_enabled{ false };
+    Clock::time_point m_epoch{};
+
+    mutable std::mutex m_mutex{};
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers{};
+};
+
+/*
+    Records the time between its construction and destruction as a span,
+    if the tracer is enabled when it's constructed. Spans opened while
+    another is open on the same thread are nested inside it
+*/
+class TraceSpan final
+{
+public:
+
+    /*
+        Opens a span. Nothing is copied unless the tracer is enabled
+
+        @param name     The name of the span, which has to outlive the tracer
+        @param category The category the span belongs to, which has to outlive the tracer
+        @param detail   Anything else worth knowing about the span, like the file being worked on
+    */
+    explicit TraceSpan(const char* name, const char* category = "dpa");
+    TraceSpan(const char* name, const char* category, const std::string& detail);
+    ~TraceSpan() noexcept;
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+
+    bool m_recording{ false };
+    TraceEvent m_event{};
+};
+}
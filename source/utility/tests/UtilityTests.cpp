@@ -1,6 +1,14 @@
 #include <UtilityTests.h>
 
 #include "FileUtil.h"
+#include "JsonUtil.h"
+#include "Metrics.h"
+#include "Trace.h"
+
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <thread>
 
 TEST_F(UtilityTests, IsValidImageTest)
 {
@@ -59,3 +67,134 @@ TEST_F(UtilityTests, IsValidExtensionTest)
         ASSERT_TRUE(dpa::fileutil::isValidImageExtension(validPath, m_validExtensions));
     }
 }
+
+TEST_F(UtilityTests, MatchesWildcardTest)
+{
+    EXPECT_TRUE(dpa::fileutil::matchesWildcard("enemy_1.png", "*.png"));
+    EXPECT_TRUE(dpa::fileutil::matchesWildcard("enemy_1.png", "enemy_?.png"));
+    EXPECT_TRUE(dpa::fileutil::matchesWildcard("enemy_1.png", "e*_*.p*"));
+    EXPECT_TRUE(dpa::fileutil::matchesWildcard("enemy_1.png", "*"));
+
+    EXPECT_FALSE(dpa::fileutil::matchesWildcard("enemy_1.png", "*.jpg"));
+    EXPECT_FALSE(dpa::fileutil::matchesWildcard("enemy_10.png", "enemy_?.png"));
+    EXPECT_FALSE(dpa::fileutil::matchesWildcard("enemy_1.png", "enemy"));
+}
+
+TEST_F(UtilityTests, CollectImagesTest)
+{
+    const auto batchDir = std::filesystem::temp_directory_path() / "dpa_collect_images";
+    std::filesystem::remove_all(batchDir);
+    ASSERT_TRUE(std::filesystem::create_directories(batchDir / "nested"));
+
+    const auto enemy = createFile(batchDir, "enemy.png");
+    const auto torch = createFile(batchDir, "torch.bmp");
+    const auto nested = createFile(batchDir / "nested", "skull.png");
+    ASSERT_TRUE(enemy && torch && nested && createFile(batchDir, "notes.txt"));
+
+    // A directory gathers every image beneath it
+    EXPECT_EQ((std::vector<std::filesystem::path>{ enemy.value(), nested.value(), torch.value() }),
+        dpa::fileutil::collectImages(batchDir));
+
+    // A pattern only gathers the matching images next to it
+    EXPECT_EQ((std::vector<std::filesystem::path>{ enemy.value() }),
+        dpa::fileutil::collectImages(batchDir / "*.png"));
+
+    // A list file gathers the images it names, relative to itself, and each only once
+    {
+        std::ofstream list{ batchDir / "sprites.lst" };
+        list << "nested/skull.png\n\n" << torch.value().string() << "\nmissing.png\nnested/skull.png\n";
+    }
+
+    EXPECT_EQ((std::vector<std::filesystem::path>{ nested.value(), torch.value() }),
+        dpa::fileutil::collectImages(batchDir / "sprites.lst"));
+
+    // A single image is gathered on its own
+    EXPECT_EQ((std::vector<std::filesystem::path>{ enemy.value() }), dpa::fileutil::collectImages(enemy.value()));
+
+    std::filesystem::remove_all(batchDir);
+}
+
+TEST_F(UtilityTests, JsonStringTest)
+{
+    std::ostringstream output;
+    dpa::jsonutil::writeString(output, "C:\\art\\\"sprite\"\n\x01");
+
+    EXPECT_EQ("\"C:\\\\art\\\\\\\"sprite\\\"\\n\\u0001\"", output.str());
+}
+
+TEST_F(UtilityTests, MetricsTest)
+{
+    using namespace dpa::metrics;
+
+    const auto processStart = processCpuTime();
+    const auto threadStart = threadCpuTime();
+
+    // Burn enough CPU time for the clocks to notice
+    volatile std::uint64_t sink = 0;
+    for (std::uint64_t i = 0; i < 20'000'000; ++i)
+        sink = sink + i;
+
+    EXPECT_GT(threadCpuTime(), threadStart);
+    EXPECT_GT(processCpuTime(), processStart);
+    EXPECT_GT(peakResidentSetSize(), 0u);
+}
+
+TEST_F(UtilityTests, TraceSpansNestTest)
+{
+    using namespace dpa::trace;
+
+    auto& tracer = Tracer::instance();
+    tracer.clear();
+
+    // Nothing is recorded while the tracer is disabled
+    tracer.setEnabled(false);
+    {
+        TraceSpan ignored{ "ignored" };
+    }
+
+    EXPECT_TRUE(tracer.getEvents().empty());
+
+    tracer.setEnabled(true);
+    {
+        TraceSpan outer{ "outer", "test", "detail \"quoted\"" };
+        {
+            TraceSpan inner{ "inner", "test" };
+        }
+    }
+
+    // A span on another thread is recorded on its own track
+    std::thread{ []() { TraceSpan other{ "other", "test" }; } }.join();
+    tracer.setEnabled(false);
+
+    const auto events = tracer.getEvents();
+    ASSERT_EQ(3u, events.size());
+
+    // Spans are recorded as they close, so the inner span comes first
+    const auto& [innerThread, inner] = events[0];
+    const auto& [outerThread, outer] = events[1];
+    const auto& [otherThread, other] = events[2];
+
+    EXPECT_STREQ("inner", inner.name);
+    EXPECT_STREQ("outer", outer.name);
+    EXPECT_STREQ("other", other.name);
+
+    EXPECT_EQ(1u, inner.depth);
+    EXPECT_EQ(0u, outer.depth);
+    EXPECT_EQ(0u, other.depth);
+
+    EXPECT_LE(outer.start, inner.start);
+    EXPECT_LE(inner.start + inner.duration, outer.start + outer.duration);
+
+    EXPECT_EQ(innerThread, outerThread);
+    EXPECT_NE(outerThread, otherThread);
+
+    std::ostringstream json;
+    tracer.writeChromeTrace(json);
+
+    EXPECT_NE(std::string::npos, json.str().find("\"traceEvents\""));
+    EXPECT_NE(std::string::npos, json.str().find("\"name\":\"outer\""));
+    EXPECT_NE(std::string::npos, json.str().find("\"detail\":\"detail \\\"quoted\\\"\""));
+
+    tracer.clear();
+    EXPECT_TRUE(tracer.getEvents().empty());
+}